@@ -0,0 +1,49 @@
+#ifndef B_CALENDAR_HPP_
+#define B_CALENDAR_HPP_
+
+#include <cstdint>
+
+namespace b {
+namespace calendar {
+
+/**
+ * Proleptic Gregorian year/month/day of a count of days since 1970-01-01.
+ * (Howard Hinnant's civil_from_days.)
+ */
+static inline void
+civil(int64_t days, int64_t *year, int *month, int *day)
+{
+    days += 719468;
+
+    int64_t  era = (days >= 0 ? days : days - 146096) / 146097;
+    unsigned doe = (unsigned)(days - era * 146097);
+    unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    unsigned mp  = (5 * doy + 2) / 153;
+
+    *day   = doy - (153 * mp + 2) / 5 + 1;
+    *month = mp < 10 ? mp + 3 : mp - 9;
+    *year  = (int64_t)yoe + era * 400 + (*month <= 2);
+}
+
+/**
+ * Days since 1970-01-01 of a proleptic Gregorian date.
+ * (Howard Hinnant's days_from_civil.)
+ */
+static inline int64_t
+days(int64_t year, int month, int day)
+{
+    year -= month <= 2;
+
+    int64_t  era = (year >= 0 ? year : year - 399) / 400;
+    unsigned yoe = (unsigned)(year - era * 400);
+    unsigned doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+
+    return era * 146097 + (int64_t)doe - 719468;
+}
+
+} // namespace calendar
+} // namespace b
+
+#endif
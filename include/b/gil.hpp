@@ -0,0 +1,34 @@
+#ifndef B_GIL_HPP_
+#define B_GIL_HPP_
+
+#include "Python.h"
+
+namespace b {
+namespace gil {
+
+/**
+ * Release the GIL (if asked to) for the lifetime of this object.
+ *
+ * No Python API may be used, nor Python references touched,
+ * while it is released.
+ */
+class Release
+{
+    PyThreadState *_state;
+
+  public:
+    Release(bool release = true) : _state(release ? PyEval_SaveThread() : NULL)
+    {
+    }
+
+    ~Release()
+    {
+        if (this->_state != NULL)
+            PyEval_RestoreThread(this->_state);
+    }
+};
+
+} // namespace gil
+} // namespace b
+
+#endif
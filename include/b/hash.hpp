@@ -0,0 +1,213 @@
+#ifndef B_HASH_HPP_
+#define B_HASH_HPP_
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace b {
+namespace hash {
+
+static const uint64_t MULTIPLIER = 0x9e3779b97f4a7c15ULL;
+
+static inline uint64_t
+mix(uint64_t h)
+{
+    h ^= h >> 32;
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 29;
+    return h;
+}
+
+static inline uint64_t
+combine(uint64_t h, uint64_t x)
+{
+    return mix((h ^ x) * MULTIPLIER);
+}
+
+/**
+ * Hash raw bytes, a word at a time.
+ */
+static inline uint64_t
+bytes(const char *data, size_t length)
+{
+    uint64_t h = (uint64_t)length * MULTIPLIER;
+    uint64_t w;
+
+    while (length >= 8) {
+        memcpy(&w, data, 8);
+        h = (h ^ w) * MULTIPLIER;
+        h ^= h >> 32;
+        data   += 8;
+        length -= 8;
+    }
+
+    if (length != 0) {
+        w = 0;
+        memcpy(&w, data, length);
+        h = (h ^ w) * MULTIPLIER;
+    }
+
+    return mix(h);
+}
+
+/**
+ * Open addressing (linear probing) table of ENTRY, which must have a
+ * `uint64_t hash` member; a zero hash marks an empty slot.
+ *
+ * Uses malloc rather than the Python allocators so that it may be
+ * filled while the GIL is released.
+ */
+template <typename ENTRY>
+class Table
+{
+    ENTRY *_slots;
+    size_t _mask;
+    size_t _size;
+
+    static inline uint64_t
+    nonzero(uint64_t hash)
+    {
+        return hash == 0 ? 1 : hash;
+    }
+
+    bool
+    grow()
+    {
+        size_t capacity = (this->_mask + 1) * 2;
+
+        ENTRY *slots = (ENTRY *)calloc(capacity, sizeof(ENTRY));
+        if (slots == NULL)
+            return false;
+
+        if (this->_slots != NULL) {
+            for (size_t i = 0; i <= this->_mask; i++) {
+                ENTRY *old = &this->_slots[i];
+                if (old->hash == 0)
+                    continue;
+
+                size_t k = old->hash & (capacity - 1);
+                while (slots[k].hash != 0)
+                    k = (k + 1) & (capacity - 1);
+                slots[k] = *old;
+            }
+            free(this->_slots);
+        }
+
+        this->_slots = slots;
+        this->_mask  = capacity - 1;
+        return true;
+    }
+
+  public:
+    Table() : _slots(NULL)
+            , _mask(7)
+            , _size(0)
+    {
+    }
+
+    ~Table()
+    {
+        free(this->_slots);
+    }
+
+    // Properties
+
+    inline size_t
+    capacity() const
+    {
+        return this->_slots == NULL ? 0 : this->_mask + 1;
+    }
+
+    inline size_t
+    size() const
+    {
+        return this->_size;
+    }
+
+    // Methods
+
+    inline ENTRY *
+    slot(size_t i)
+    {
+        return &this->_slots[i];
+    }
+
+    template <typename EQUAL>
+    inline ENTRY *
+    find(uint64_t hash, EQUAL equal)
+    {
+        if (this->_slots == NULL)
+            return NULL;
+
+        hash = nonzero(hash);
+
+        for (size_t k = hash & this->_mask; ; k = (k + 1) & this->_mask) {
+            ENTRY *entry = &this->_slots[k];
+            if (entry->hash == 0)
+                return NULL;
+            if (entry->hash == hash && equal(*entry))
+                return entry;
+        }
+    }
+
+    /**
+     * Find the entry matching hash/equal, or claim an empty slot for it.
+     * Returns NULL if out of memory.
+     */
+    template <typename EQUAL>
+    inline ENTRY *
+    insert(uint64_t hash, EQUAL equal, bool *inserted)
+    {
+        if ((this->_slots == NULL || (this->_size + 1) * 2 > this->_mask + 1) && !this->grow())
+            return NULL;
+
+        hash = nonzero(hash);
+
+        for (size_t k = hash & this->_mask; ; k = (k + 1) & this->_mask) {
+            ENTRY *entry = &this->_slots[k];
+
+            if (entry->hash == 0) {
+                entry->hash = hash;
+                this->_size++;
+                *inserted = true;
+                return entry;
+            }
+
+            if (entry->hash == hash && equal(*entry)) {
+                *inserted = false;
+                return entry;
+            }
+        }
+    }
+
+    /**
+     * Empty the slot of entry (as found or inserted), shifting back the
+     * entries after it that would otherwise become unreachable.
+     */
+    inline void
+    erase(ENTRY *entry)
+    {
+        size_t mask = this->_mask;
+        size_t i    = entry - this->_slots;
+
+        for (size_t j = (i + 1) & mask; this->_slots[j].hash != 0; j = (j + 1) & mask) {
+            size_t home = this->_slots[j].hash & mask;
+
+            // Still reachable from its home slot?
+            if (i <= j ? (i < home && home <= j) : (i < home || home <= j))
+                continue;
+
+            this->_slots[i] = this->_slots[j];
+            i = j;
+        }
+
+        this->_slots[i].hash = 0;
+        this->_size--;
+    }
+};
+
+} // namespace hash
+} // namespace b
+
+#endif
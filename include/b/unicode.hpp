@@ -0,0 +1,54 @@
+#ifndef B_UNICODE_HPP_
+#define B_UNICODE_HPP_
+
+#include <cstring>
+
+#include "Python.h"
+
+#include "b/utf8.hpp"
+
+namespace b {
+namespace unicode {
+
+/**
+ * The str of UTF-8 bytes, once scanned (see b::utf8::scan), written
+ * straight into a str of the narrowest kind.
+ */
+static inline PyObject *
+from_utf8(const char *bytes, Py_ssize_t length, const b::utf8::Scan &scan)
+{
+    // Let CPython raise UnicodeDecodeError, with its details
+    if (!scan.valid)
+        return PyUnicode_DecodeUTF8(bytes, length, NULL);
+
+    PyObject *x = PyUnicode_New(scan.count, scan.max_code_point());
+    if (x == NULL)
+        return NULL;
+
+    switch (PyUnicode_KIND(x)) {
+      case PyUnicode_1BYTE_KIND:
+          if (scan.max < 0x80)
+              memcpy(PyUnicode_1BYTE_DATA(x), bytes, length);
+          else
+              b::utf8::decode(bytes, length, PyUnicode_1BYTE_DATA(x));
+          break;
+      case PyUnicode_2BYTE_KIND: b::utf8::decode(bytes, length, PyUnicode_2BYTE_DATA(x)); break;
+      case PyUnicode_4BYTE_KIND: b::utf8::decode(bytes, length, PyUnicode_4BYTE_DATA(x)); break;
+    }
+
+    return x;
+}
+
+static inline PyObject *
+from_utf8(const char *bytes, Py_ssize_t length)
+{
+    b::utf8::Scan scan;
+    b::utf8::scan(bytes, length, &scan);
+
+    return from_utf8(bytes, length, scan);
+}
+
+} // namespace unicode
+} // namespace b
+
+#endif
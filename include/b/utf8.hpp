@@ -0,0 +1,456 @@
+#ifndef B_UTF8_HPP_
+#define B_UTF8_HPP_
+
+#include <cstdint>
+#include <cstring>
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#  define B_UTF8_AVX2
+#  include <immintrin.h>
+#elif defined(__SSE2__)
+#  include <emmintrin.h>
+#endif
+
+namespace b {
+namespace utf8 {
+
+/**
+ * Whether bytes are all ASCII, checked a word at a time.
+ */
+static inline bool
+is_ascii(const char *bytes, size_t length)
+{
+    const uint64_t HIGH = 0x8080808080808080ULL;
+
+    uint64_t any = 0;
+    uint64_t w;
+
+    while (length >= 8) {
+        memcpy(&w, bytes, 8);
+        any |= w;
+        bytes  += 8;
+        length -= 8;
+    }
+
+    while (length != 0) {
+        any |= (unsigned char)*bytes++;
+        length--;
+    }
+
+    return (any & HIGH) == 0;
+}
+
+/**
+ * What decoding needs to know of UTF-8 bytes, found in one pass.
+ */
+class Scan
+{
+  public:
+    bool     valid;
+    uint8_t  max;   // Largest byte (or below 0x80 if ASCII), bounding the code points
+    size_t   count; // Of code points (bytes but continuation bytes)
+
+    // Largest code point (class) of valid bytes
+    inline uint32_t
+    max_code_point() const
+    {
+        return this->max < 0x80 ? 0x7F     // ASCII
+             : this->max < 0xC4 ? 0xFF     // Leads 0xC2, 0xC3 - Latin-1
+             : this->max < 0xF0 ? 0xFFFF   // Two or three bytes
+             :                    0x10FFFF;
+    }
+};
+
+static inline bool
+is_continuation(uint8_t c)
+{
+    return (c & 0xC0) == 0x80;
+}
+
+/**
+ * Validate bytes [begin, end) a code point at a time; RFC 3629, so no
+ * overlong forms, surrogates or code points past U+10FFFF.
+ * Returns the number of code points, or -1 if invalid.
+ */
+static inline int64_t
+validate_scalar(const uint8_t *p, const uint8_t *end)
+{
+    int64_t count = 0;
+
+    while (p < end) {
+        uint8_t c = *p;
+
+        count++;
+
+        if (c < 0x80) {
+            p++;
+            continue;
+        }
+
+        if (c < 0xC2 || c > 0xF4)
+            return -1;
+
+        int n = c < 0xE0 ? 2 : c < 0xF0 ? 3 : 4;
+
+        if (end - p < n)
+            return -1;
+
+        for (int i = 1; i < n; i++) {
+            if (!is_continuation(p[i]))
+                return -1;
+        }
+
+        // Bounds on the second byte, per lead
+        if ((c == 0xE0 && p[1] < 0xA0) ||
+            (c == 0xED && p[1] > 0x9F) ||
+            (c == 0xF0 && p[1] < 0x90) ||
+            (c == 0xF4 && p[1] > 0x8F))
+            return -1;
+
+        p += n;
+    }
+
+    return count;
+}
+
+static inline void
+scan_scalar(const char *bytes, size_t length, Scan *scan)
+{
+    const uint8_t *p = (const uint8_t *)bytes;
+
+    uint8_t max = 0;
+
+    for (size_t i = 0; i < length; i++)
+        max = p[i] > max ? p[i] : max;
+
+    int64_t count = max < 0x80 ? (int64_t)length : validate_scalar(p, p + length);
+
+    scan->valid = count != -1;
+    scan->max   = max;
+    scan->count = count != -1 ? (size_t)count : 0;
+}
+
+#ifdef B_UTF8_AVX2
+
+/*
+ * The lookup validator of Keiser and Lemire, "Validating UTF-8 In Less Than
+ * One Instruction Per Byte" (2021): three nibble lookups classify each pair
+ * of adjacent bytes; any error bit left standing makes the input invalid.
+ */
+
+namespace avx2 {
+
+static const uint8_t TOO_SHORT      = 1 << 0; // Lead not followed by a continuation
+static const uint8_t TOO_LONG       = 1 << 1; // ASCII followed by a continuation
+static const uint8_t OVERLONG_3     = 1 << 2;
+static const uint8_t TOO_LARGE      = 1 << 3;
+static const uint8_t SURROGATE      = 1 << 4;
+static const uint8_t OVERLONG_2     = 1 << 5;
+static const uint8_t TOO_LARGE_1000 = 1 << 6;
+static const uint8_t OVERLONG_4     = 1 << 6;
+static const uint8_t TWO_CONTS      = 1 << 7; // Unless the third or fourth byte
+static const uint8_t CARRY          = TOO_SHORT | TOO_LONG | TWO_CONTS;
+
+#define B_UTF8_TARGET __attribute__((target("avx2")))
+
+B_UTF8_TARGET static inline __m256i
+lookup(__m256i index, const uint8_t table[16])
+{
+    __m128i t = _mm_loadu_si128((const __m128i *)table);
+    return _mm256_shuffle_epi8(_mm256_broadcastsi128_si256(t), index);
+}
+
+// The block shifted by n bytes, the last n of previous shifted in
+template <int N>
+B_UTF8_TARGET static inline __m256i
+shift(__m256i block, __m256i previous)
+{
+    return _mm256_alignr_epi8(block, _mm256_permute2x128_si256(previous, block, 0x21), 16 - N);
+}
+
+B_UTF8_TARGET static inline __m256i
+errors(__m256i block, __m256i previous_block)
+{
+    static const uint8_t BYTE_1_HIGH[16] = {
+        // 0_______ ________ ASCII
+        TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG, TOO_LONG,
+        // 10______ ________ continuation
+        TWO_CONTS, TWO_CONTS, TWO_CONTS, TWO_CONTS,
+        // 1100____ ________ two byte lead
+        TOO_SHORT | OVERLONG_2,
+        // 1101____ ________ two byte lead
+        TOO_SHORT,
+        // 1110____ ________ three byte lead
+        TOO_SHORT | OVERLONG_3 | SURROGATE,
+        // 1111____ ________ four byte lead
+        TOO_SHORT | TOO_LARGE | TOO_LARGE_1000 | OVERLONG_4,
+    };
+    static const uint8_t BYTE_1_LOW[16] = {
+        CARRY | OVERLONG_3 | OVERLONG_2 | OVERLONG_4, // ____0000
+        CARRY | OVERLONG_2,                           // ____0001
+        CARRY,                                        // ____001_
+        CARRY,
+        CARRY | TOO_LARGE,                            // ____0100
+        CARRY | TOO_LARGE | TOO_LARGE_1000,           // ____0101 and up
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000 | SURROGATE, // ____1101
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+        CARRY | TOO_LARGE | TOO_LARGE_1000,
+    };
+    static const uint8_t BYTE_2_HIGH[16] = {
+        // ________ 0_______ ASCII
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+        // ________ 1000____
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE_1000 | OVERLONG_4,
+        // ________ 1001____
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | OVERLONG_3 | TOO_LARGE,
+        // ________ 101_____
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        TOO_LONG | OVERLONG_2 | TWO_CONTS | SURROGATE | TOO_LARGE,
+        // ________ 11______ lead
+        TOO_SHORT, TOO_SHORT, TOO_SHORT, TOO_SHORT,
+    };
+
+    const __m256i LOW_NIBBLE = _mm256_set1_epi8(0x0F);
+
+    __m256i previous1 = shift<1>(block, previous_block);
+
+    __m256i special = _mm256_and_si256(
+        _mm256_and_si256(
+            lookup(_mm256_and_si256(_mm256_srli_epi16(previous1, 4), LOW_NIBBLE), BYTE_1_HIGH),
+            lookup(_mm256_and_si256(previous1, LOW_NIBBLE), BYTE_1_LOW)),
+        lookup(_mm256_and_si256(_mm256_srli_epi16(block, 4), LOW_NIBBLE), BYTE_2_HIGH));
+
+    // Third and fourth bytes must be (the only) two continuations in a row
+    __m256i third  = _mm256_subs_epu8(shift<2>(block, previous_block), _mm256_set1_epi8((char)(0xE0 - 0x80)));
+    __m256i fourth = _mm256_subs_epu8(shift<3>(block, previous_block), _mm256_set1_epi8((char)(0xF0 - 0x80)));
+    __m256i must   = _mm256_and_si256(_mm256_or_si256(third, fourth), _mm256_set1_epi8((char)0x80));
+
+    return _mm256_xor_si256(must, special);
+}
+
+class State
+{
+  public:
+    __m256i error;
+    __m256i max;
+    __m256i previous;
+    __m256i tail;     // Of previous: leads in its last three bytes needing more
+    size_t  count;
+
+    B_UTF8_TARGET inline void
+    step(__m256i block)
+    {
+        // Leads in the last three bytes that need more
+        const __m256i INCOMPLETE = _mm256_setr_epi8(
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+            (char)(0xF0 - 1), (char)(0xE0 - 1), (char)(0xC0 - 1));
+
+        if (_mm256_movemask_epi8(block) == 0) {
+            // Whatever the previous block left open is now cut short
+            this->error = _mm256_or_si256(this->error, this->tail);
+            this->tail  = _mm256_setzero_si256();
+        } else {
+            this->error = _mm256_or_si256(this->error, errors(block, this->previous));
+            this->max   = _mm256_max_epu8(this->max, block);
+            this->tail  = _mm256_subs_epu8(block, INCOMPLETE);
+
+            // 0x80 - 0xBF are, as signed, those below 0xC0
+            __m256i continuations = _mm256_cmpgt_epi8(_mm256_set1_epi8((char)0xC0), block);
+            this->count -= __builtin_popcount((uint32_t)_mm256_movemask_epi8(continuations));
+        }
+
+        this->previous = block;
+    }
+};
+
+B_UTF8_TARGET static inline void
+scan(const char *bytes, size_t length, Scan *scan)
+{
+    State state;
+
+    state.error    = _mm256_setzero_si256();
+    state.max      = _mm256_setzero_si256();
+    state.previous = _mm256_setzero_si256();
+    state.tail     = _mm256_setzero_si256();
+    state.count    = length;
+
+    const __m256i *p = (const __m256i *)bytes;
+    size_t         i = 0;
+
+    for (; i + 128 <= length; i += 128, p += 4) {
+        __m256i b0 = _mm256_loadu_si256(p);
+        __m256i b1 = _mm256_loadu_si256(p + 1);
+        __m256i b2 = _mm256_loadu_si256(p + 2);
+        __m256i b3 = _mm256_loadu_si256(p + 3);
+
+        // Runs of ASCII need no more than this
+        if (_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(b0, b1), _mm256_or_si256(b2, b3))) == 0) {
+            state.error    = _mm256_or_si256(state.error, state.tail);
+            state.tail     = _mm256_setzero_si256();
+            state.previous = b3;
+            continue;
+        }
+
+        state.step(b0);
+        state.step(b1);
+        state.step(b2);
+        state.step(b3);
+    }
+
+    for (; i + 32 <= length; i += 32, p++)
+        state.step(_mm256_loadu_si256(p));
+
+    // Pad with ASCII (even none left), which ends any sequence left open
+    uint8_t padded[32] = {0};
+    memcpy(padded, bytes + i, length - i);
+    state.step(_mm256_loadu_si256((const __m256i *)padded));
+
+    uint8_t lanes[32];
+    _mm256_storeu_si256((__m256i *)lanes, state.max);
+
+    uint8_t max = 0;
+    for (int k = 0; k < 32; k++)
+        max = lanes[k] > max ? lanes[k] : max;
+
+    scan->valid = _mm256_testz_si256(state.error, state.error) != 0;
+    scan->max   = max;
+    scan->count = scan->valid ? state.count : 0;
+}
+
+#undef B_UTF8_TARGET
+
+} // namespace avx2
+
+#endif
+
+static inline bool
+has_avx2()
+{
+#ifdef B_UTF8_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Validate bytes as UTF-8, finding the largest byte and counting code points;
+ * 32 bytes at a time where the CPU has AVX2, otherwise a code point at a time.
+ *
+ * Touches no Python state.
+ */
+static inline void
+scan(const char *bytes, size_t length, Scan *scan)
+{
+#ifdef B_UTF8_AVX2
+    if (length >= 32 && has_avx2()) {
+        avx2::scan(bytes, length, scan);
+        return;
+    }
+#endif
+    scan_scalar(bytes, length, scan);
+}
+
+#ifdef __SSE2__
+
+// Store 16 ASCII bytes as 16 code points of the width of out
+static inline void
+widen(__m128i block, uint8_t *out)
+{
+    _mm_storeu_si128((__m128i *)out, block);
+}
+
+static inline void
+widen(__m128i block, uint16_t *out)
+{
+    __m128i zero = _mm_setzero_si128();
+
+    _mm_storeu_si128((__m128i *)out,     _mm_unpacklo_epi8(block, zero));
+    _mm_storeu_si128((__m128i *)out + 1, _mm_unpackhi_epi8(block, zero));
+}
+
+static inline void
+widen(__m128i block, uint32_t *out)
+{
+    __m128i zero = _mm_setzero_si128();
+    __m128i low  = _mm_unpacklo_epi8(block, zero);
+    __m128i high = _mm_unpackhi_epi8(block, zero);
+
+    _mm_storeu_si128((__m128i *)out,     _mm_unpacklo_epi16(low,  zero));
+    _mm_storeu_si128((__m128i *)out + 1, _mm_unpackhi_epi16(low,  zero));
+    _mm_storeu_si128((__m128i *)out + 2, _mm_unpacklo_epi16(high, zero));
+    _mm_storeu_si128((__m128i *)out + 3, _mm_unpackhi_epi16(high, zero));
+}
+
+#endif
+
+/**
+ * Decode valid UTF-8 into count code points of TYPE (wide enough for all).
+ */
+template <typename TYPE>
+static inline void
+decode(const char *bytes, size_t length, TYPE *out)
+{
+    const uint8_t *p   = (const uint8_t *)bytes;
+    const uint8_t *end = p + length;
+
+    while (p < end) {
+        uint8_t c = *p;
+
+        if (c < 0x80) {
+            // Runs of ASCII, 16 bytes at a time
+            while (end - p >= 16) {
+#ifdef __SSE2__
+                __m128i block = _mm_loadu_si128((const __m128i *)p);
+
+                if (_mm_movemask_epi8(block) != 0)
+                    break;
+
+                widen(block, out);
+#else
+                uint64_t w[2];
+                memcpy(w, p, 16);
+
+                if ((w[0] | w[1]) & 0x8080808080808080ULL)
+                    break;
+
+                for (int i = 0; i < 16; i++)
+                    out[i] = p[i];
+#endif
+                out += 16;
+                p   += 16;
+            }
+
+            while (p < end && *p < 0x80)
+                *out++ = *p++;
+
+            continue;
+        }
+
+        // The widest sequence of a code point TYPE holds is the last case
+        if (sizeof(TYPE) == 1 || c < 0xE0) {
+            *out++ = (TYPE)(((c & 0x1F) << 6) | (p[1] & 0x3F));
+            p += 2;
+        } else if (sizeof(TYPE) == 2 || c < 0xF0) {
+            *out++ = (TYPE)(((c & 0x0F) << 12) | ((p[1] & 0x3F) << 6) | (p[2] & 0x3F));
+            p += 3;
+        } else {
+            *out++ = (TYPE)(((uint32_t)(c & 0x07) << 18) | ((p[1] & 0x3F) << 12) | ((p[2] & 0x3F) << 6) | (p[3] & 0x3F));
+            p += 4;
+        }
+    }
+}
+
+} // namespace utf8
+} // namespace b
+
+#endif
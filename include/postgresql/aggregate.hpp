@@ -0,0 +1,250 @@
+#ifndef POSTGRESQL_AGGREGATE_HPP_
+#define POSTGRESQL_AGGREGATE_HPP_
+
+#include "Python.h"
+#include "libpq-fe.h"
+
+#include "b/gil.hpp"
+#include "b/hash.hpp"
+#include "postgresql/network.hpp"
+#include "postgresql/rows.hpp"
+#include "postgresql/type.hpp"
+
+namespace postgresql {
+namespace aggregate {
+
+// Below this many rows, releasing the GIL costs more than it saves
+static const int RELEASE_GIL_ROWS = 16384;
+
+enum Op {
+    COUNT,
+    SUM,
+    MIN,
+    MAX,
+};
+
+/* Kernels - operate on raw cells, no Python API */
+
+static inline Py_ssize_t
+count(const Rows &rows, int j)
+{
+    Py_ssize_t n = 0;
+
+    for (int k = 0; k < rows.count; k++)
+        n += !rows.isnull(k, j);
+
+    return n;
+}
+
+template <typename TYPE, typename TOTAL>
+static inline Py_ssize_t
+sum(const Rows &rows, int j, TOTAL *total)
+{
+    TOTAL      t = 0;
+    Py_ssize_t n = 0;
+
+    for (int k = 0; k < rows.count; k++) {
+        if (rows.isnull(k, j))
+            continue;
+        t += postgresql::network::load<TYPE>(rows.value(k, j));
+        n++;
+    }
+
+    *total = t;
+    return n;
+}
+
+template <typename TYPE>
+static inline Py_ssize_t
+extremum(const Rows &rows, int j, bool maximum, TYPE *extreme)
+{
+    TYPE       e = 0;
+    Py_ssize_t n = 0;
+
+    for (int k = 0; k < rows.count; k++) {
+        if (rows.isnull(k, j))
+            continue;
+
+        TYPE x = postgresql::network::load<TYPE>(rows.value(k, j));
+
+        if (n++ == 0 || (maximum ? x > e : x < e))
+            e = x;
+    }
+
+    *extreme = e;
+    return n;
+}
+
+class Group
+{
+  public:
+    uint64_t   hash;
+    int        k;     // First row of the group
+    Py_ssize_t count;
+};
+
+/**
+ * Count rows per distinct raw value of column j.
+ * Returns false if out of memory.
+ */
+static inline bool
+group(const Rows &rows, int j, b::hash::Table<Group> &groups, Py_ssize_t *nulls)
+{
+    Py_ssize_t n = 0;
+
+    for (int k = 0; k < rows.count; k++) {
+        if (rows.isnull(k, j)) {
+            n++;
+            continue;
+        }
+
+        const char *value  = rows.value (k, j);
+        int         length = rows.length(k, j);
+
+        bool inserted;
+        Group *g = groups.insert(
+            b::hash::bytes(value, length),
+            [&](const Group &g) {
+                return rows.length(g.k, j) == length && memcmp(rows.value(g.k, j), value, length) == 0;
+            },
+            &inserted);
+
+        if (g == NULL)
+            return false;
+
+        if (inserted) {
+            g->k     = k;
+            g->count = 1;
+        } else {
+            g->count++;
+        }
+    }
+
+    *nulls = n;
+    return true;
+}
+
+/* Python */
+
+static inline PyObject *
+from_int128(__int128 x)
+{
+    if (x >= INT64_MIN && x <= INT64_MAX)
+        return PyLong_FromLongLong((long long)x);
+
+    unsigned char bytes[sizeof(x)];
+    memcpy(bytes, &x, sizeof(x));
+    return _PyLong_FromByteArray(bytes, sizeof(x), !b::endian::BIG, 1);
+}
+
+template <typename TYPE>
+static inline PyObject *
+integer(const Rows &rows, int j, Op op)
+{
+    Py_ssize_t n;
+
+    if (op == SUM) {
+        __int128 total;
+        {
+            b::gil::Release release(rows.count >= RELEASE_GIL_ROWS);
+            n = sum<TYPE>(rows, j, &total);
+        }
+
+        if (n == 0)
+            Py_RETURN_NONE;
+        return from_int128(total);
+    }
+
+    TYPE extreme;
+    {
+        b::gil::Release release(rows.count >= RELEASE_GIL_ROWS);
+        n = extremum<TYPE>(rows, j, op == MAX, &extreme);
+    }
+
+    if (n == 0)
+        Py_RETURN_NONE;
+    return PyLong_FromLongLong(extreme);
+}
+
+template <typename TYPE>
+static inline PyObject *
+real(const Rows &rows, int j, Op op)
+{
+    Py_ssize_t n;
+    double     x;
+
+    if (op == SUM) {
+        b::gil::Release release(rows.count >= RELEASE_GIL_ROWS);
+        n = sum<TYPE>(rows, j, &x);
+    } else {
+        b::gil::Release release(rows.count >= RELEASE_GIL_ROWS);
+        TYPE extreme;
+        n = extremum<TYPE>(rows, j, op == MAX, &extreme);
+        x = extreme;
+    }
+
+    if (n == 0)
+        Py_RETURN_NONE;
+    return PyFloat_FromDouble(x);
+}
+
+static inline PyObject *
+boolean(const Rows &rows, int j, Op op)
+{
+    Py_ssize_t n;
+
+    if (op == SUM) {
+        Py_ssize_t total;
+        {
+            b::gil::Release release(rows.count >= RELEASE_GIL_ROWS);
+            n = sum<int8_t>(rows, j, &total);
+        }
+
+        if (n == 0)
+            Py_RETURN_NONE;
+        return PyLong_FromSsize_t(total);
+    }
+
+    int8_t extreme;
+    {
+        b::gil::Release release(rows.count >= RELEASE_GIL_ROWS);
+        n = extremum<int8_t>(rows, j, op == MAX, &extreme);
+    }
+
+    if (n == 0)
+        Py_RETURN_NONE;
+    return PyBool_FromLong(extreme);
+}
+
+/**
+ * Apply op to column j of rows, of the given type.
+ */
+static inline PyObject *
+apply(const Rows &rows, int j, Oid oid, Op op)
+{
+    if (op == COUNT) {
+        Py_ssize_t n;
+        {
+            b::gil::Release release(rows.count >= RELEASE_GIL_ROWS);
+            n = count(rows, j);
+        }
+        return PyLong_FromSsize_t(n);
+    }
+
+    switch (oid) {
+      case INT2  ::OID: return integer<int16_t>(rows, j, op);
+      case INT4  ::OID: return integer<int32_t>(rows, j, op);
+      case INT8  ::OID: return integer<int64_t>(rows, j, op);
+      case FLOAT4::OID: return real<float>     (rows, j, op);
+      case FLOAT8::OID: return real<double>    (rows, j, op);
+      case BOOL  ::OID: return boolean         (rows, j, op);
+    }
+
+    PyErr_Format(PyExc_TypeError, "cannot aggregate type: %u", oid);
+    return NULL;
+}
+
+} // namespace aggregate
+} // namespace postgresql
+
+#endif
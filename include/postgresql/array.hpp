@@ -0,0 +1,209 @@
+#ifndef POSTGRESQL_ARRAY_HPP_
+#define POSTGRESQL_ARRAY_HPP_
+
+#include <cstdint>
+#include <cstring>
+
+#include "libpq-fe.h"
+
+#include "b/endian.hpp"
+
+#include "postgresql/network.hpp"
+
+namespace postgresql {
+namespace array {
+
+// As PostgreSQL's MAXDIM
+static const int MAX_DIMENSIONS = 6;
+
+/**
+ * Header of a binary array value:
+ *
+ *   int32 ndim, int32 has_null, Oid element,
+ *   (int32 dimension, int32 lower bound) * ndim,
+ *   (int32 length or -1 if NULL, bytes) * count
+ */
+class Array
+{
+  public:
+    int         ndim;
+    bool        has_null;
+    Oid         element;
+    int         dimensions  [MAX_DIMENSIONS];
+    int         lower_bounds[MAX_DIMENSIONS];
+    int64_t     count;    // Of elements, all dimensions together
+    const char *elements;
+    const char *end;
+};
+
+/**
+ * Parse the header of a binary array value.
+ * Returns false if malformed.
+ */
+static inline bool
+parse(const char *value, int length, Array *array)
+{
+    if (length < 12)
+        return false;
+
+    array->ndim     = postgresql::network::load<int32_t>(value);
+    array->has_null = postgresql::network::load<int32_t>(value + 4) != 0;
+    array->element  = postgresql::network::load<uint32_t>(value + 8);
+
+    if (array->ndim < 0 || array->ndim > MAX_DIMENSIONS || length < 12 + 8 * array->ndim)
+        return false;
+
+    int64_t count = array->ndim > 0 ? 1 : 0;
+
+    for (int d = 0; d < array->ndim; d++) {
+        int dimension = postgresql::network::load<int32_t>(value + 12 + 8 * d);
+
+        if (dimension < 0)
+            return false;
+
+        array->dimensions  [d] = dimension;
+        array->lower_bounds[d] = postgresql::network::load<int32_t>(value + 16 + 8 * d);
+
+        // Each element takes at least its length word
+        count *= dimension;
+        if (count > length / 4)
+            return false;
+    }
+
+    array->count    = count;
+    array->elements = value + 12 + 8 * array->ndim;
+    array->end      = value + length;
+
+    return true;
+}
+
+/**
+ * Read the next element at *p, advancing past it.
+ * Returns false if it overruns the array.
+ */
+static inline bool
+next(const Array &array, const char **p, const char **value, int *length)
+{
+    if (array.end - *p < 4)
+        return false;
+
+    int n = postgresql::network::load<int32_t>(*p);
+    *p += 4;
+
+    if (n < -1 || (n > 0 && array.end - *p < n))
+        return false;
+
+    *value  = *p;
+    *length = n;
+
+    if (n > 0)
+        *p += n;
+
+    return true;
+}
+
+/**
+ * Copy all (non-NULL, fixed-width) elements into native order.
+ * Returns false if any is NULL or not sizeof(TYPE) bytes.
+ *
+ * Touches no Python state.
+ */
+template <typename TYPE>
+static inline bool
+copy(const Array &array, TYPE *out)
+{
+    const char *p = array.elements;
+
+    if (array.end - p < (int64_t)(4 + sizeof(TYPE)) * array.count)
+        return false;
+
+    for (int64_t i = 0; i < array.count; i++) {
+        if (postgresql::network::load<int32_t>(p) != (int32_t)sizeof(TYPE))
+            return false;
+
+        out[i] = postgresql::network::load<TYPE>(p + 4);
+        p += 4 + sizeof(TYPE);
+    }
+
+    return true;
+}
+
+static inline size_t
+header_size(int ndim)
+{
+    return 12 + 8 * ndim;
+}
+
+/**
+ * Write the header of a binary array value of ndim dimensions (each with
+ * lower bound 1), of header_size(ndim) bytes.
+ * Returns past it, where the elements go.
+ */
+static inline char *
+header(char *out, int ndim, const int *dimensions, bool has_null, Oid element)
+{
+    int32_t words[3 + 2 * MAX_DIMENSIONS];
+
+    words[0] = postgresql::network::order((int32_t)ndim);
+    words[1] = postgresql::network::order((int32_t)has_null);
+    words[2] = postgresql::network::order((int32_t)element);
+
+    for (int d = 0; d < ndim; d++) {
+        words[3 + 2 * d] = postgresql::network::order((int32_t)dimensions[d]);
+        words[4 + 2 * d] = postgresql::network::order((int32_t)1);
+    }
+
+    memcpy(out, words, header_size(ndim));
+    return out + header_size(ndim);
+}
+
+template <typename TYPE>
+static inline TYPE
+reverse(TYPE x)
+{
+    return b::endian::swap(x);
+}
+
+template <>
+inline uint8_t
+reverse<uint8_t>(uint8_t x)
+{
+    return x;
+}
+
+/**
+ * Write count fixed-width elements from in, each after its length word,
+ * byte-swapping them if swap (when in is not in network order).
+ * Returns past them.
+ *
+ * The inverse of copy(); touches no Python state.
+ */
+template <typename TYPE>
+static inline char *
+fill(const char *in, int64_t count, bool swap, char *out)
+{
+    const int32_t length = postgresql::network::order((int32_t)sizeof(TYPE));
+
+    // One loop or the other, so neither tests swap per element
+    if (swap) {
+        for (int64_t i = 0; i < count; i++, in += sizeof(TYPE), out += 4 + sizeof(TYPE)) {
+            TYPE x;
+            memcpy(&x, in, sizeof(TYPE));
+            x = reverse(x);
+            memcpy(out, &length, 4);
+            memcpy(out + 4, &x, sizeof(TYPE));
+        }
+    } else {
+        for (int64_t i = 0; i < count; i++, in += sizeof(TYPE), out += 4 + sizeof(TYPE)) {
+            memcpy(out, &length, 4);
+            memcpy(out + 4, in, sizeof(TYPE));
+        }
+    }
+
+    return out;
+}
+
+} // namespace array
+} // namespace postgresql
+
+#endif
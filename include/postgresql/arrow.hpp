@@ -0,0 +1,565 @@
+#ifndef POSTGRESQL_ARROW_HPP_
+#define POSTGRESQL_ARROW_HPP_
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+#include "libpq-fe.h"
+
+#include "postgresql/network.hpp"
+#include "postgresql/rows.hpp"
+#include "postgresql/type.hpp"
+
+/* Arrow C data interface - ABI stable, as given by the specification */
+
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+extern "C" {
+
+struct ArrowSchema {
+    const char *format;
+    const char *name;
+    const char *metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema **children;
+    struct ArrowSchema *dictionary;
+    void (*release)(struct ArrowSchema *);
+    void *private_data;
+};
+
+struct ArrowArray {
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void **buffers;
+    struct ArrowArray **children;
+    struct ArrowArray *dictionary;
+    void (*release)(struct ArrowArray *);
+    void *private_data;
+};
+
+}
+
+#endif
+
+#ifndef ARROW_C_STREAM_INTERFACE
+#define ARROW_C_STREAM_INTERFACE
+
+extern "C" {
+
+struct ArrowArrayStream {
+    int (*get_schema)(struct ArrowArrayStream *, struct ArrowSchema *out);
+    int (*get_next)(struct ArrowArrayStream *, struct ArrowArray *out);
+    const char *(*get_last_error)(struct ArrowArrayStream *);
+    void (*release)(struct ArrowArrayStream *);
+    void *private_data;
+};
+
+}
+
+#endif
+
+namespace postgresql {
+namespace arrow {
+
+/**
+ * The Arrow format of a column type, or NULL if not exportable.
+ */
+static inline const char *
+format(Oid oid)
+{
+    switch (oid) {
+      case BOOL       ::OID: return "b";
+      case BYTEA      ::OID: return "z";
+      case DATE       ::OID: return "tdD";
+      case FLOAT4     ::OID: return "f";
+      case FLOAT8     ::OID: return "g";
+      case INT2       ::OID: return "s";
+      case INT4       ::OID: return "i";
+      case INT8       ::OID: return "l";
+      case INTERVAL   ::OID: return "tin";
+      case TEXT       ::OID: return "u";
+      case TIME       ::OID: return "ttu";
+      case TIMESTAMP  ::OID: return "tsu:";
+      case TIMESTAMPTZ::OID: return "tsu:UTC";
+      case UUID       ::OID: return "w:16";
+    }
+    return NULL;
+}
+
+/* Schema */
+
+class SchemaPrivate
+{
+  public:
+    char         *format;
+    char         *name;
+    ArrowSchema **children;
+};
+
+static void
+release(ArrowSchema *schema)
+{
+    SchemaPrivate *p = (SchemaPrivate *)schema->private_data;
+
+    for (int64_t c = 0; c < schema->n_children; c++) {
+        ArrowSchema *child = schema->children[c];
+        if (child->release != NULL)
+            child->release(child);
+        free(child);
+    }
+
+    free(p->children);
+    free(p->format);
+    free(p->name);
+    free(p);
+
+    schema->release = NULL;
+}
+
+static inline bool
+schema(ArrowSchema *out, const char *format, const char *name, int64_t flags, int64_t n_children)
+{
+    memset(out, 0, sizeof(*out));
+
+    SchemaPrivate *p = (SchemaPrivate *)calloc(1, sizeof(SchemaPrivate));
+    if (p == NULL)
+        return false;
+
+    out->private_data = p;
+    out->release      = release;
+
+    if ((p->format = strdup(format)) == NULL ||
+        (p->name   = strdup(name))   == NULL ||
+        (p->children = (ArrowSchema **)calloc(n_children > 0 ? n_children : 1, sizeof(ArrowSchema *))) == NULL)
+        return false;
+
+    out->format   = p->format;
+    out->name     = p->name;
+    out->flags    = flags;
+    out->children = p->children;
+
+    for (; out->n_children < n_children; out->n_children++) {
+        if ((p->children[out->n_children] = (ArrowSchema *)calloc(1, sizeof(ArrowSchema))) == NULL)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Schema of a struct (record batch) of the given columns.
+ * On failure, out may be partially built, but is releasable.
+ */
+static inline bool
+schema(ArrowSchema *out, int width, const char * const *names, const Oid *oids)
+{
+    if (!schema(out, "+s", "", 0, width))
+        return false;
+
+    for (int c = 0; c < width; c++) {
+        if (!schema(out->children[c], format(oids[c]), names[c], ARROW_FLAG_NULLABLE, 0))
+            return false;
+    }
+
+    return true;
+}
+
+/* Array */
+
+class ArrayPrivate
+{
+  public:
+    const void  *buffers[3];
+    ArrowArray **children;
+};
+
+static void
+release(ArrowArray *array)
+{
+    ArrayPrivate *p = (ArrayPrivate *)array->private_data;
+
+    for (int64_t c = 0; c < array->n_children; c++) {
+        ArrowArray *child = array->children[c];
+        if (child->release != NULL)
+            child->release(child);
+        free(child);
+    }
+
+    for (int b = 0; b < 3; b++)
+        free((void *)p->buffers[b]);
+
+    free(p->children);
+    free(p);
+
+    array->release = NULL;
+}
+
+static inline bool
+array(ArrowArray *out, int64_t length, int64_t n_buffers, int64_t n_children)
+{
+    memset(out, 0, sizeof(*out));
+
+    ArrayPrivate *p = (ArrayPrivate *)calloc(1, sizeof(ArrayPrivate));
+    if (p == NULL)
+        return false;
+
+    out->private_data = p;
+    out->release      = release;
+    out->length       = length;
+    out->n_buffers    = n_buffers;
+    out->buffers      = p->buffers;
+
+    if ((p->children = (ArrowArray **)calloc(n_children > 0 ? n_children : 1, sizeof(ArrowArray *))) == NULL)
+        return false;
+
+    out->children = p->children;
+
+    for (; out->n_children < n_children; out->n_children++) {
+        if ((p->children[out->n_children] = (ArrowArray *)calloc(1, sizeof(ArrowArray))) == NULL)
+            return false;
+    }
+
+    return true;
+}
+
+static inline void *
+buffer(ArrowArray *out, int b, size_t size)
+{
+    // Arrow recommends 64 byte alignment; never zero sized
+    size = (size + 63) & ~(size_t)63;
+    if (size == 0)
+        size = 64;
+
+    void *x = NULL;
+    if (posix_memalign(&x, 64, size) != 0)
+        return NULL;
+
+    memset(x, 0, size);
+    ((ArrayPrivate *)out->private_data)->buffers[b] = x;
+    return x;
+}
+
+static inline void
+set_bit(uint8_t *bits, int64_t i)
+{
+    bits[i >> 3] |= 1 << (i & 7);
+}
+
+/**
+ * The validity bitmap of column j, if it has any NULLs.
+ */
+static inline bool
+validity(ArrowArray *out, const Rows &rows, int j)
+{
+    int64_t nulls = 0;
+
+    for (int k = 0; k < rows.count; k++)
+        nulls += rows.isnull(k, j);
+
+    out->null_count = nulls;
+
+    if (nulls == 0)
+        return true;
+
+    uint8_t *bits = (uint8_t *)buffer(out, 0, (rows.count + 7) / 8);
+    if (bits == NULL)
+        return false;
+
+    for (int k = 0; k < rows.count; k++) {
+        if (!rows.isnull(k, j))
+            set_bit(bits, k);
+    }
+
+    return true;
+}
+
+template <typename TYPE>
+static inline bool
+fixed(ArrowArray *out, const Rows &rows, int j, TYPE shift = 0)
+{
+    TYPE *values = (TYPE *)buffer(out, 1, sizeof(TYPE) * rows.count);
+    if (values == NULL)
+        return false;
+
+    for (int k = 0; k < rows.count; k++) {
+        if (rows.isnull(k, j))
+            continue;
+
+        TYPE x = postgresql::network::load<TYPE>(rows.value(k, j));
+
+        // Keep +/-infinity at the limits
+        if (shift != 0 && x != std::numeric_limits<TYPE>::max() && x != std::numeric_limits<TYPE>::min())
+            x += shift;
+
+        values[k] = x;
+    }
+
+    return true;
+}
+
+static inline bool
+boolean(ArrowArray *out, const Rows &rows, int j)
+{
+    uint8_t *bits = (uint8_t *)buffer(out, 1, (rows.count + 7) / 8);
+    if (bits == NULL)
+        return false;
+
+    for (int k = 0; k < rows.count; k++) {
+        if (!rows.isnull(k, j) && *rows.value(k, j))
+            set_bit(bits, k);
+    }
+
+    return true;
+}
+
+static inline bool
+interval(ArrowArray *out, const Rows &rows, int j)
+{
+    // month_day_nano: int32 months, int32 days, int64 nanoseconds
+    char *values = (char *)buffer(out, 1, 16 * (size_t)rows.count);
+    if (values == NULL)
+        return false;
+
+    for (int k = 0; k < rows.count; k++) {
+        if (rows.isnull(k, j))
+            continue;
+
+        const char *value = rows.value(k, j);
+
+        int64_t microseconds = postgresql::network::load<int64_t>(value);
+        int32_t days         = postgresql::network::load<int32_t>(value + 8);
+        int32_t months       = postgresql::network::load<int32_t>(value + 12);
+        int64_t nanoseconds  = microseconds * 1000;
+
+        memcpy(values + 16 * k,     &months,      4);
+        memcpy(values + 16 * k + 4, &days,        4);
+        memcpy(values + 16 * k + 8, &nanoseconds, 8);
+    }
+
+    return true;
+}
+
+template <typename OFFSET>
+static inline bool
+variable(ArrowArray *out, const Rows &rows, int j, size_t total)
+{
+    OFFSET *offsets = (OFFSET *)buffer(out, 1, sizeof(OFFSET) * ((size_t)rows.count + 1));
+    char   *data    = (char *)  buffer(out, 2, total);
+
+    if (offsets == NULL || data == NULL)
+        return false;
+
+    OFFSET offset = 0;
+
+    for (int k = 0; k < rows.count; k++) {
+        offsets[k] = offset;
+
+        if (rows.isnull(k, j))
+            continue;
+
+        int length = rows.length(k, j);
+        memcpy(data + offset, rows.value(k, j), length);
+        offset += length;
+    }
+
+    offsets[rows.count] = offset;
+    return true;
+}
+
+/**
+ * Column j of rows as an Arrow array of format(oid).
+ * Large (64 bit offset) variants are used for over 2GB of text/bytea,
+ * and noted in large.
+ */
+static inline bool
+column(ArrowArray *out, const Rows &rows, int j, Oid oid, bool *large)
+{
+    bool varying = oid == TEXT::OID || oid == BYTEA::OID;
+
+    if (!array(out, rows.count, varying ? 3 : 2, 0))
+        return false;
+
+    if (!validity(out, rows, j))
+        return false;
+
+    *large = false;
+
+    switch (oid) {
+      case BOOL       ::OID: return boolean         (out, rows, j);
+      case DATE       ::OID: return fixed<int32_t>  (out, rows, j, DATE::EPOCH);
+      case FLOAT4     ::OID: return fixed<float>    (out, rows, j);
+      case FLOAT8     ::OID: return fixed<double>   (out, rows, j);
+      case INT2       ::OID: return fixed<int16_t>  (out, rows, j);
+      case INT4       ::OID: return fixed<int32_t>  (out, rows, j);
+      case INT8       ::OID: return fixed<int64_t>  (out, rows, j);
+      case INTERVAL   ::OID: return interval        (out, rows, j);
+      case TIME       ::OID: return fixed<int64_t>  (out, rows, j);
+      case TIMESTAMP  ::OID:
+      case TIMESTAMPTZ::OID: return fixed<int64_t>  (out, rows, j, TIMESTAMP::EPOCH);
+
+      case UUID::OID: {
+          char *values = (char *)buffer(out, 1, 16 * (size_t)rows.count);
+          if (values == NULL)
+              return false;
+
+          for (int k = 0; k < rows.count; k++) {
+              if (!rows.isnull(k, j))
+                  memcpy(values + 16 * k, rows.value(k, j), 16);
+          }
+          return true;
+      }
+    }
+
+    size_t total = 0;
+
+    for (int k = 0; k < rows.count; k++)
+        total += rows.length(k, j);
+
+    if (total > INT32_MAX) {
+        *large = true;
+        return variable<int64_t>(out, rows, j, total);
+    }
+
+    return variable<int32_t>(out, rows, j, total);
+}
+
+/**
+ * A struct array (record batch) of the given columns of rows, whose
+ * formats must all be supported.  Switches schema children to the
+ * large string/binary formats where needed.  No Python API.
+ */
+static inline bool
+batch(ArrowArray *out, ArrowSchema *schema, const Rows &rows, int width, const int *columns, const Oid *oids)
+{
+    if (!array(out, rows.count, 1, width))
+        return false;
+
+    for (int c = 0; c < width; c++) {
+        bool large;
+
+        if (!column(out->children[c], rows, columns[c], oids[c], &large))
+            return false;
+
+        if (large) {
+            SchemaPrivate *p = (SchemaPrivate *)schema->children[c]->private_data;
+            p->format[0] = oids[c] == TEXT::OID ? 'U' : 'Z';
+        }
+    }
+
+    return true;
+}
+
+/* Stream - of the one batch */
+
+class StreamPrivate
+{
+  public:
+    ArrowSchema schema;
+    ArrowArray  batch;
+    const char *error;  // Of the last call that failed, NULL if none did
+};
+
+static int
+get_schema(ArrowArrayStream *stream, ArrowSchema *out)
+{
+    StreamPrivate *p = (StreamPrivate *)stream->private_data;
+    ArrowSchema   *s = &p->schema;
+
+    if (!schema(out, s->format, s->name, s->flags, s->n_children))
+        goto fail;
+
+    for (int64_t c = 0; c < s->n_children; c++) {
+        ArrowSchema *child = s->children[c];
+        if (!schema(out->children[c], child->format, child->name, child->flags, 0))
+            goto fail;
+    }
+
+    p->error = NULL;
+    return 0;
+
+  fail:
+    if (out->release != NULL)
+        out->release(out);
+    p->error = "out of memory copying the schema";
+    return ENOMEM;
+}
+
+static int
+get_next(ArrowArrayStream *stream, ArrowArray *out)
+{
+    StreamPrivate *p = (StreamPrivate *)stream->private_data;
+
+    // Move the batch out; once gone, mark the end of the stream
+    memcpy(out, &p->batch, sizeof(*out));
+    p->batch.release = NULL;
+
+    p->error = NULL;
+    return 0;
+}
+
+static const char *
+get_last_error(ArrowArrayStream *stream)
+{
+    return ((StreamPrivate *)stream->private_data)->error;
+}
+
+static void
+release(ArrowArrayStream *stream)
+{
+    StreamPrivate *p = (StreamPrivate *)stream->private_data;
+
+    if (p->schema.release != NULL)
+        p->schema.release(&p->schema);
+    if (p->batch.release != NULL)
+        p->batch.release(&p->batch);
+
+    free(p);
+    stream->release = NULL;
+}
+
+/**
+ * Stream a schema and batch, taking ownership of both (even on failure).
+ */
+static inline bool
+stream(ArrowArrayStream *out, ArrowSchema *schema, ArrowArray *batch)
+{
+    StreamPrivate *p = (StreamPrivate *)malloc(sizeof(StreamPrivate));
+
+    if (p == NULL) {
+        schema->release(schema);
+        batch->release(batch);
+        return false;
+    }
+
+    memcpy(&p->schema, schema, sizeof(*schema));
+    memcpy(&p->batch,  batch,  sizeof(*batch));
+    p->error = NULL;
+
+    schema->release = NULL;
+    batch->release  = NULL;
+
+    out->get_schema     = get_schema;
+    out->get_next       = get_next;
+    out->get_last_error = get_last_error;
+    out->release        = release;
+    out->private_data   = p;
+
+    return true;
+}
+
+} // namespace arrow
+} // namespace postgresql
+
+#endif
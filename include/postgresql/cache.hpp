@@ -0,0 +1,312 @@
+#ifndef POSTGRESQL_CACHE_HPP_
+#define POSTGRESQL_CACHE_HPP_
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+#include "Python.h"
+#include "libpq-fe.h"
+
+#include "b/hash.hpp"
+
+namespace postgresql {
+namespace cache {
+
+static inline double
+now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/**
+ * Encode a command and its (already encoded) parameters as a key:
+ * the command, NUL, then the type, format, length and bytes of each
+ * parameter.
+ * Returns a malloc'ed key, or NULL if out of memory.
+ */
+static inline char *
+key(const char *command, int n, const Oid *types, const char * const *values, const int *lengths,
+    const int *formats, size_t *length)
+{
+    size_t size = strlen(command) + 1;
+
+    for (int i = 0; i < n; i++)
+        size += sizeof(Oid) + 2 * sizeof(int) + (lengths[i] > 0 ? lengths[i] : 0);
+
+    char *key = (char *)malloc(size);
+    if (key == NULL)
+        return NULL;
+
+    char *p = key;
+
+    memcpy(p, command, strlen(command) + 1);
+    p += strlen(command) + 1;
+
+    for (int i = 0; i < n; i++) {
+        int length = values[i] == NULL ? -1 : lengths[i];
+
+        memcpy(p, &types[i], sizeof(Oid));
+        p += sizeof(Oid);
+        memcpy(p, &formats[i], sizeof(int));
+        p += sizeof(int);
+        memcpy(p, &length, sizeof(int));
+        p += sizeof(int);
+
+        if (length > 0) {
+            memcpy(p, values[i], length);
+            p += length;
+        }
+    }
+
+    *length = size;
+    return key;
+}
+
+class Node
+{
+  public:
+    uint64_t  hash;
+    char     *key;
+    size_t    key_length;
+    PyObject *result;
+    PyObject *tag;     // Or NULL
+    double    expires;
+    size_t    size;    // Accounted against max_bytes
+    Node     *prev;    // Towards more recently used
+    Node     *next;
+};
+
+class Entry
+{
+  public:
+    uint64_t hash;
+    Node    *node;
+};
+
+/**
+ * Results by key, least recently used evicted first past max_bytes,
+ * each expiring ttl seconds after it was stored.
+ */
+class Cache
+{
+    b::hash::Table<Entry> _table;
+    Node                 *_head; // Most recently used
+    Node                 *_tail;
+
+    inline Entry *
+    find(uint64_t hash, const char *key, size_t length)
+    {
+        return this->_table.find(hash, [&](const Entry &e) {
+            return e.node->key_length == length && memcmp(e.node->key, key, length) == 0;
+        });
+    }
+
+    void
+    unlink(Node *node)
+    {
+        if (node->prev != NULL) node->prev->next = node->next;
+        else                    this->_head      = node->next;
+        if (node->next != NULL) node->next->prev = node->prev;
+        else                    this->_tail      = node->prev;
+    }
+
+    void
+    push(Node *node)
+    {
+        node->prev = NULL;
+        node->next = this->_head;
+
+        if (this->_head != NULL)
+            this->_head->prev = node;
+        else
+            this->_tail = node;
+
+        this->_head = node;
+    }
+
+    void
+    remove(Node *node)
+    {
+        this->_table.erase(this->find(node->hash, node->key, node->key_length));
+        this->unlink(node);
+
+        this->bytes -= node->size;
+
+        Py_DECREF(node->result);
+        Py_XDECREF(node->tag);
+        free(node->key);
+        free(node);
+    }
+
+  public:
+    double      ttl;
+    size_t      max_bytes;
+    size_t      bytes;
+    Py_ssize_t  hits;
+    Py_ssize_t  misses;
+    Py_ssize_t  evictions;
+    Py_ssize_t  expirations;
+    Py_ssize_t  invalidations;
+
+    // Notifications on channel (if not NULL) invalidate by tag
+    char       *channel;
+
+    Cache(double ttl, size_t max_bytes) : _head(NULL)
+                                        , _tail(NULL)
+                                        , ttl(ttl)
+                                        , max_bytes(max_bytes)
+                                        , bytes(0)
+                                        , hits(0)
+                                        , misses(0)
+                                        , evictions(0)
+                                        , expirations(0)
+                                        , invalidations(0)
+                                        , channel(NULL)
+    {
+    }
+
+    ~Cache()
+    {
+        this->clear();
+        free(this->channel);
+    }
+
+    inline size_t
+    size() const
+    {
+        return this->_table.size();
+    }
+
+    /**
+     * Return a new reference to the Result stored under key, or NULL.
+     */
+    PyObject *
+    get(const char *key, size_t length)
+    {
+        uint64_t hash  = b::hash::bytes(key, length);
+        Entry   *entry = this->find(hash, key, length);
+
+        if (entry == NULL) {
+            this->misses++;
+            return NULL;
+        }
+
+        Node *node = entry->node;
+
+        if (node->expires <= now()) {
+            this->remove(node);
+            this->expirations++;
+            this->misses++;
+            return NULL;
+        }
+
+        this->unlink(node);
+        this->push(node);
+        this->hits++;
+
+        Py_INCREF(node->result);
+        return node->result;
+    }
+
+    /**
+     * Store result (of size bytes) under key, taking ownership of key.
+     * Returns false if out of memory.
+     */
+    bool
+    put(char *key, size_t length, PyObject *result, PyObject *tag, size_t size)
+    {
+        if (size > this->max_bytes) {
+            free(key);
+            return true;
+        }
+
+        uint64_t hash  = b::hash::bytes(key, length);
+        Entry   *entry = this->find(hash, key, length);
+
+        if (entry != NULL)
+            this->remove(entry->node);
+
+        Node *node = (Node *)malloc(sizeof(Node));
+        if (node == NULL) {
+            free(key);
+            return false;
+        }
+
+        bool inserted;
+        entry = this->_table.insert(hash, [](const Entry &) { return false; }, &inserted);
+        if (entry == NULL) {
+            free(node);
+            free(key);
+            return false;
+        }
+
+        Py_INCREF(result);
+        Py_XINCREF(tag);
+
+        node->hash       = hash;
+        node->key        = key;
+        node->key_length = length;
+        node->result     = result;
+        node->tag        = tag;
+        node->expires    = now() + this->ttl;
+        node->size       = size + length + sizeof(Node);
+
+        entry->node = node;
+        this->push(node);
+        this->bytes += node->size;
+
+        while (this->bytes > this->max_bytes && this->_tail != node) {
+            this->remove(this->_tail);
+            this->evictions++;
+        }
+
+        return true;
+    }
+
+    /**
+     * Remove entries stored with tag (a str), or all of them if NULL.
+     * Returns -1 if comparing tags failed.
+     */
+    Py_ssize_t
+    invalidate(PyObject *tag)
+    {
+        Py_ssize_t n = 0;
+
+        for (Node *node = this->_head, *next; node != NULL; node = next) {
+            next = node->next;
+
+            if (tag != NULL) {
+                if (node->tag == NULL)
+                    continue;
+
+                int equal = PyObject_RichCompareBool(node->tag, tag, Py_EQ);
+                if (equal == -1)
+                    return -1;
+                if (!equal)
+                    continue;
+            }
+
+            this->remove(node);
+            n++;
+        }
+
+        this->invalidations += n;
+        return n;
+    }
+
+    void
+    clear()
+    {
+        while (this->_head != NULL)
+            this->remove(this->_head);
+    }
+};
+
+} // namespace cache
+} // namespace postgresql
+
+#endif
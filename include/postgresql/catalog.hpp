@@ -0,0 +1,232 @@
+#ifndef POSTGRESQL_CATALOG_HPP_
+#define POSTGRESQL_CATALOG_HPP_
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "libpq-fe.h"
+
+#include "postgresql/network.hpp"
+
+namespace postgresql {
+namespace catalog {
+
+/**
+ * The tables (and views, ...) of schema $1 with their columns, the schema
+ * itself, then its types, in one round trip:
+ *
+ *   entry, oid, name, kind (relkind or typtype),
+ *   column number, column name, column type or base type, not null,
+ *   array type
+ */
+static const char *QUERY =
+    "SELECT 'column'::text, c.oid::int8, c.relname::text, c.relkind::text,"
+    "       a.attnum::int4, a.attname::text, a.atttypid::int8, a.attnotnull, NULL::int8"
+    "  FROM pg_catalog.pg_class c"
+    "  JOIN pg_catalog.pg_namespace n ON n.oid = c.relnamespace"
+    "  JOIN pg_catalog.pg_attribute a ON a.attrelid = c.oid"
+    " WHERE n.nspname = $1 AND c.relkind IN ('r', 'v', 'm', 'p', 'f')"
+    "   AND a.attnum > 0 AND NOT a.attisdropped"
+    " UNION ALL "
+    "SELECT 'schema', n.oid::int8, n.nspname::text, '', NULL, NULL, NULL, NULL, NULL"
+    "  FROM pg_catalog.pg_namespace n"
+    " WHERE n.nspname = $1"
+    " UNION ALL "
+    "SELECT 'type', t.oid::int8, t.typname::text, t.typtype::text,"
+    "       NULL, NULL, COALESCE(r.rngsubtype, t.typbasetype)::int8, NULL, t.typarray::int8"
+    "  FROM pg_catalog.pg_type t"
+    "  JOIN pg_catalog.pg_namespace n ON n.oid = t.typnamespace"
+    "  LEFT JOIN pg_catalog.pg_range r ON r.rngtypid = t.oid"
+    " WHERE n.nspname = $1 AND t.typtype IN ('c', 'd', 'e', 'r')"
+    " ORDER BY 1, 2, 5";
+
+class Column
+{
+  public:
+    std::string name;
+    Oid         type;
+    int         number;   // attnum, from 1
+    bool        not_null;
+};
+
+class Table
+{
+  public:
+    Oid                 oid;
+    std::string         name;
+    char                kind;    // relkind: 'r'elation, 'v'iew, ...
+    std::vector<Column> columns; // By number
+};
+
+class Type
+{
+  public:
+    Oid         oid;
+    std::string name;
+    char        kind;  // typtype: 'c'omposite, 'd'omain, 'e'num, 'r'ange
+    Oid         base;  // Of a domain, or the subtype of a range; else 0
+    Oid         array; // 0 if none
+};
+
+class Schema
+{
+  public:
+    Oid                oid;    // 0 if there is no such schema
+    std::string        name;
+    std::vector<Table> tables; // By OID
+    std::vector<Type>  types;  // By OID
+
+    const Table *
+    table(const char *name) const
+    {
+        for (size_t i = 0; i < this->tables.size(); i++) {
+            if (this->tables[i].name == name)
+                return &this->tables[i];
+        }
+        return NULL;
+    }
+};
+
+static inline std::string
+text(const PGresult *pg_result, int i, int j)
+{
+    return std::string(PQgetvalue(pg_result, i, j), PQgetlength(pg_result, i, j));
+}
+
+static inline int64_t
+int8(const PGresult *pg_result, int i, int j)
+{
+    return PQgetisnull(pg_result, i, j) ? 0 : postgresql::network::load<int64_t>(PQgetvalue(pg_result, i, j));
+}
+
+/**
+ * Fill schema from the (binary) rows of QUERY.
+ * Returns false if they are not as expected.
+ */
+static inline bool
+load(const PGresult *pg_result, Schema *schema)
+{
+    if (PQnfields(pg_result) != 9)
+        return false;
+
+    schema->oid = 0;
+
+    for (int i = 0; i < PQntuples(pg_result); i++) {
+        for (int j = 0; j < 4; j++) {
+            if (PQgetisnull(pg_result, i, j))
+                return false;
+        }
+
+        std::string entry = text(pg_result, i, 0);
+        Oid         oid   = (Oid)int8(pg_result, i, 1);
+        std::string kind  = text(pg_result, i, 3);
+
+        if (entry == "column") {
+            if (schema->tables.empty() || schema->tables.back().oid != oid) {
+                schema->tables.push_back(Table());
+
+                Table &table = schema->tables.back();
+
+                table.oid  = oid;
+                table.name = text(pg_result, i, 2);
+                table.kind = kind.empty() ? 0 : kind[0];
+            }
+
+            if (PQgetisnull(pg_result, i, 4) || PQgetisnull(pg_result, i, 7))
+                return false;
+
+            Column column;
+
+            column.name     = text(pg_result, i, 5);
+            column.type     = (Oid)int8(pg_result, i, 6);
+            column.number   = postgresql::network::load<int32_t>(PQgetvalue(pg_result, i, 4));
+            column.not_null = *PQgetvalue(pg_result, i, 7) != 0;
+
+            schema->tables.back().columns.push_back(column);
+        } else if (entry == "schema") {
+            schema->oid = oid;
+        } else {
+            Type type;
+
+            type.oid   = oid;
+            type.name  = text(pg_result, i, 2);
+            type.kind  = kind.empty() ? 0 : kind[0];
+            type.base  = (Oid)int8(pg_result, i, 6);
+            type.array = (Oid)int8(pg_result, i, 8);
+
+            schema->types.push_back(type);
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Schemas by name, as loaded until invalidated.
+ */
+class Catalog
+{
+    std::vector<Schema *> _schemas;
+
+  public:
+    // Notifications on channel (if not NULL) invalidate by schema name
+    char *channel;
+
+    Catalog() : channel(NULL)
+    {
+    }
+
+    ~Catalog()
+    {
+        this->invalidate(NULL);
+        free(this->channel);
+    }
+
+    Schema *
+    get(const char *name)
+    {
+        for (size_t i = 0; i < this->_schemas.size(); i++) {
+            if (this->_schemas[i]->name == name)
+                return this->_schemas[i];
+        }
+        return NULL;
+    }
+
+    // Taking ownership of schema, replacing any of its name
+    void
+    put(Schema *schema)
+    {
+        this->invalidate(schema->name.c_str());
+        this->_schemas.push_back(schema);
+    }
+
+    /**
+     * Forget the schema of name, or all of them if NULL.
+     * Returns how many were.
+     */
+    size_t
+    invalidate(const char *name)
+    {
+        size_t n = 0;
+
+        for (size_t i = 0; i < this->_schemas.size(); ) {
+            if (name == NULL || this->_schemas[i]->name == name) {
+                delete this->_schemas[i];
+                this->_schemas.erase(this->_schemas.begin() + i);
+                n++;
+            } else {
+                i++;
+            }
+        }
+
+        return n;
+    }
+};
+
+} // namespace catalog
+} // namespace postgresql
+
+#endif
@@ -0,0 +1,214 @@
+#ifndef POSTGRESQL_COLUMNS_HPP_
+#define POSTGRESQL_COLUMNS_HPP_
+
+#include <cstdlib>
+#include <exception>
+#include <thread>
+#include <vector>
+
+#include "libpq-fe.h"
+
+#include "b/utf8.hpp"
+#include "postgresql/network.hpp"
+#include "postgresql/rows.hpp"
+#include "postgresql/type.hpp"
+
+namespace postgresql {
+namespace columns {
+
+// Fewer rows than this per thread are not worth a thread
+static const int MIN_ROWS_PER_THREAD = 16384;
+
+enum Kind {
+    OTHER,   // Decoded later, under the GIL
+    BOOLEAN,
+    INTEGER,
+    REAL,
+    TEXT,
+    TEMPORAL, // Raw PostgreSQL date, time or timestamp in integers
+};
+
+// Per row flags
+static const uint8_t ISNULL = 0x01;
+
+static inline Kind
+kind(Oid oid)
+{
+    switch (oid) {
+      case BOOL  ::OID: return BOOLEAN;
+      case INT2  ::OID:
+      case INT4  ::OID:
+      case INT8  ::OID: return INTEGER;
+      case FLOAT4::OID:
+      case FLOAT8::OID: return REAL;
+      case TEXT  ::OID: return TEXT;
+      case DATE       ::OID:
+      case TIME       ::OID:
+      case TIMESTAMP  ::OID:
+      case TIMESTAMPTZ::OID: return TEMPORAL;
+    }
+    return OTHER;
+}
+
+/**
+ * Build the value of a TEMPORAL cell - Python API.
+ */
+static inline PyObject *
+temporal(Oid oid, int64_t value, const Options &options)
+{
+    switch (oid) {
+      case DATE       ::OID: return DATE     ::from((int32_t)value, options);
+      case TIME       ::OID: return TIME     ::from(value, options);
+      case TIMESTAMP  ::OID: return TIMESTAMP::from(value, Py_None, options);
+      case TIMESTAMPTZ::OID: return TIMESTAMP::from(value, PyDateTimeAPI->TimeZone_UTC, options);
+    }
+    return NULL;
+}
+
+/**
+ * A column of a Result, decoded into native buffers.
+ */
+class Column
+{
+  public:
+    int            j;         // pg_result column
+    Oid            oid;
+    Kind           kind;
+    uint8_t       *flags;
+    int64_t       *integers;  // BOOLEAN, INTEGER, TEMPORAL
+    double        *reals;     // REAL
+    b::utf8::Scan *texts;     // TEXT
+
+    Column(int j, Oid oid) : j(j)
+                           , oid(oid)
+                           , kind(columns::kind(oid))
+                           , flags(NULL)
+                           , integers(NULL)
+                           , reals(NULL)
+                           , texts(NULL)
+    {
+    }
+
+    ~Column()
+    {
+        free(this->flags);
+        free(this->integers);
+        free(this->reals);
+        free(this->texts);
+    }
+
+    /**
+     * Returns false if out of memory.
+     */
+    bool
+    allocate(int count)
+    {
+        size_t n = count > 0 ? count : 1;
+
+        // Zeroed: not NULL, until decode() says otherwise
+        if ((this->flags = (uint8_t *)calloc(n, 1)) == NULL)
+            return false;
+
+        if (this->kind == BOOLEAN || this->kind == INTEGER || this->kind == TEMPORAL)
+            return (this->integers = (int64_t *)malloc(n * sizeof(int64_t))) != NULL;
+
+        if (this->kind == REAL)
+            return (this->reals = (double *)malloc(n * sizeof(double))) != NULL;
+
+        if (this->kind == TEXT)
+            return (this->texts = (b::utf8::Scan *)malloc(n * sizeof(b::utf8::Scan))) != NULL;
+
+        return true;
+    }
+
+    /**
+     * Decode rows [begin, end) - no Python API.
+     */
+    void
+    decode(const Rows &rows, int begin, int end)
+    {
+        int j = this->j;
+
+        for (int k = begin; k < end; k++) {
+            if (rows.isnull(k, j)) {
+                this->flags[k] = ISNULL;
+                continue;
+            }
+
+            this->flags[k] = 0;
+
+            const char *value = rows.value(k, j);
+
+            switch (this->oid) {
+              case BOOL  ::OID: this->integers[k] = *value != 0;                                    break;
+              case INT2  ::OID: this->integers[k] = postgresql::network::load<int16_t>(value); break;
+              case INT4  ::OID: this->integers[k] = postgresql::network::load<int32_t>(value); break;
+              case INT8  ::OID: this->integers[k] = postgresql::network::load<int64_t>(value); break;
+              case FLOAT4::OID: this->reals   [k] = postgresql::network::load<float>  (value); break;
+              case FLOAT8::OID: this->reals   [k] = postgresql::network::load<double> (value); break;
+              case DATE       ::OID: this->integers[k] = postgresql::network::load<int32_t>(value); break;
+              case TIME       ::OID:
+              case TIMESTAMP  ::OID:
+              case TIMESTAMPTZ::OID: this->integers[k] = postgresql::network::load<int64_t>(value); break;
+              case TEXT  ::OID: b::utf8::scan(value, rows.length(k, j), &this->texts[k]); break;
+            }
+        }
+    }
+};
+
+static inline void
+decode(const Rows &rows, std::vector<Column *> &columns, int begin, int end)
+{
+    // OTHER columns too, for their NULL flags
+    for (size_t c = 0; c < columns.size(); c++)
+        columns[c]->decode(rows, begin, end);
+}
+
+/**
+ * Decode all rows of columns, partitioned by row range over up to
+ * `threads` threads (the calling thread included).  No Python API.
+ */
+static inline void
+decode(const Rows &rows, std::vector<Column *> &columns, int threads)
+{
+    int count = rows.count;
+
+    if (threads > count / MIN_ROWS_PER_THREAD)
+        threads = count / MIN_ROWS_PER_THREAD;
+
+    if (threads <= 1) {
+        decode(rows, columns, 0, count);
+        return;
+    }
+
+    int chunk = (count + threads - 1) / threads;
+    int begin = chunk; // First chunk is ours
+
+    std::vector<std::thread> workers;
+
+    try {
+        workers.reserve(threads);
+
+        for (; begin < count; begin += chunk) {
+            int end = begin + chunk < count ? begin + chunk : count;
+            workers.emplace_back([&rows, &columns, begin, end]() {
+                decode(rows, columns, begin, end);
+            });
+        }
+    } catch (std::exception &) {
+        // Could not start them all, do the rest here
+    }
+
+    decode(rows, columns, 0, chunk < count ? chunk : count);
+
+    if (begin < count)
+        decode(rows, columns, begin, count);
+
+    for (size_t w = 0; w < workers.size(); w++)
+        workers[w].join();
+}
+
+} // namespace columns
+} // namespace postgresql
+
+#endif
@@ -0,0 +1,79 @@
+#ifndef POSTGRESQL_COMPOSITE_HPP_
+#define POSTGRESQL_COMPOSITE_HPP_
+
+#include <cstdint>
+
+#include "libpq-fe.h"
+
+#include "postgresql/network.hpp"
+
+namespace postgresql {
+namespace composite {
+
+/**
+ * Header of a binary composite (row) value:
+ *
+ *   int32 count,
+ *   (Oid type, int32 length or -1 if NULL, bytes) * count
+ */
+class Composite
+{
+  public:
+    int         count;  // Of fields
+    const char *fields;
+    const char *end;
+};
+
+/**
+ * Parse the header of a binary composite value.
+ * Returns false if malformed.
+ */
+static inline bool
+parse(const char *value, int length, Composite *composite)
+{
+    if (length < 4)
+        return false;
+
+    composite->count = postgresql::network::load<int32_t>(value);
+
+    // Each field takes at least its type and length words
+    if (composite->count < 0 || composite->count > (length - 4) / 8)
+        return false;
+
+    composite->fields = value + 4;
+    composite->end    = value + length;
+
+    return true;
+}
+
+/**
+ * Read the next field at *p, advancing past it.
+ * Returns false if it overruns the composite.
+ */
+static inline bool
+next(const Composite &composite, const char **p, Oid *oid, const char **value, int *length)
+{
+    if (composite.end - *p < 8)
+        return false;
+
+    int n = postgresql::network::load<int32_t>(*p + 4);
+
+    *oid = postgresql::network::load<uint32_t>(*p);
+    *p  += 8;
+
+    if (n < -1 || (n > 0 && composite.end - *p < n))
+        return false;
+
+    *value  = *p;
+    *length = n;
+
+    if (n > 0)
+        *p += n;
+
+    return true;
+}
+
+} // namespace composite
+} // namespace postgresql
+
+#endif
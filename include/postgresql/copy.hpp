@@ -0,0 +1,71 @@
+#ifndef POSTGRESQL_COPY_HPP_
+#define POSTGRESQL_COPY_HPP_
+
+#include <cerrno>
+#include <cstdlib>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "libpq-fe.h"
+
+namespace postgresql {
+namespace copy {
+
+// Read (and send) size - large enough to amortize syscalls and messages
+static const size_t CHUNK_SIZE = 1 << 20;
+
+/**
+ * Send the contents of fd as the data of a COPY ... FROM STDIN in progress,
+ * then end it. The bytes are passed through untouched - the server parses.
+ *
+ * Touches no Python state, so may (should) run with the GIL released.
+ *
+ * Returns 0, or the errno of a failed read or allocation; in that case the
+ * COPY is ended with an error, so the server rolls it back. Failures of the
+ * connection itself surface in the result of the COPY.
+ */
+static inline int
+from_fd(PGconn *pg_conn, int fd)
+{
+    char *buffer = (char *)malloc(CHUNK_SIZE);
+
+    if (buffer == NULL) {
+        PQputCopyEnd(pg_conn, "out of memory");
+        return ENOMEM;
+    }
+
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    int error = 0;
+
+    for (;;) {
+        ssize_t n = read(fd, buffer, CHUNK_SIZE);
+
+        if (n == 0)
+            break;
+
+        if (n == -1) {
+            if (errno == EINTR)
+                continue;
+
+            error = errno;
+            break;
+        }
+
+        if (PQputCopyData(pg_conn, buffer, (int)n) != 1)
+            break;
+    }
+
+    free(buffer);
+
+    PQputCopyEnd(pg_conn, error == 0 ? NULL : "read failed");
+    return error;
+}
+
+} // namespace copy
+} // namespace postgresql
+
+#endif
@@ -0,0 +1,420 @@
+#ifndef POSTGRESQL_CSV_HPP_
+#define POSTGRESQL_CSV_HPP_
+
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unistd.h>
+
+#include "libpq-fe.h"
+
+#include "b/calendar.hpp"
+#include "postgresql/network.hpp"
+#include "postgresql/rows.hpp"
+#include "postgresql/type.hpp"
+
+namespace postgresql {
+namespace csv {
+
+// Bytes to format before each write
+static const size_t FLUSH_SIZE = 1 << 20;
+
+/**
+ * Whether cells of a type can be formatted natively.
+ */
+static inline bool
+supported(Oid oid)
+{
+    switch (oid) {
+      case BOOL       ::OID:
+      case BYTEA      ::OID:
+      case CHAR       ::OID:
+      case DATE       ::OID:
+      case FLOAT4     ::OID:
+      case FLOAT8     ::OID:
+      case INT2       ::OID:
+      case INT4       ::OID:
+      case INT8       ::OID:
+      case TEXT       ::OID:
+      case TIME       ::OID:
+      case TIMESTAMP  ::OID:
+      case TIMESTAMPTZ::OID:
+      case UUID       ::OID:
+          return true;
+    }
+    return false;
+}
+
+/**
+ * Write all of data to fd.  Returns false with errno set on failure.
+ */
+static inline bool
+write_all(int fd, const char *data, size_t size)
+{
+    while (size != 0) {
+        ssize_t n = write(fd, data, size);
+
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+
+        data += n;
+        size -= n;
+    }
+    return true;
+}
+
+/**
+ * Formats rows as CSV (RFC 4180, as PostgreSQL's COPY ... CSV writes
+ * them) into a growable buffer.  No Python API; methods return false
+ * if out of memory.
+ */
+class Writer
+{
+    bool
+    reserve(size_t n)
+    {
+        if (this->size + n <= this->capacity)
+            return true;
+
+        size_t capacity = this->capacity * 2;
+        if (capacity < this->size + n)
+            capacity = this->size + n;
+
+        char *data = (char *)realloc(this->data, capacity);
+        if (data == NULL)
+            return false;
+
+        this->data     = data;
+        this->capacity = capacity;
+        return true;
+    }
+
+    inline void
+    put(const char *bytes, size_t n)
+    {
+        memcpy(this->data + this->size, bytes, n);
+        this->size += n;
+    }
+
+    inline void
+    put(char c)
+    {
+        this->data[this->size++] = c;
+    }
+
+    inline void
+    digits(uint64_t x, int width)
+    {
+        char  digits[20];
+        char *end = digits + sizeof(digits);
+        char *p   = end;
+
+        do {
+            *--p = '0' + x % 10;
+            x /= 10;
+        } while (x != 0 || end - p < width);
+
+        this->put(p, end - p);
+    }
+
+    inline void
+    integer(int64_t x)
+    {
+        if (x < 0) {
+            this->put('-');
+            this->digits(-(uint64_t)x, 0);
+        } else {
+            this->digits(x, 0);
+        }
+    }
+
+    template <typename TYPE>
+    inline void
+    real(TYPE x)
+    {
+        if (std::isnan(x)) {
+            this->put("NaN", 3);
+            return;
+        }
+
+        if (std::isinf(x)) {
+            if (x < 0)
+                this->put("-Infinity", 9);
+            else
+                this->put("Infinity", 8);
+            return;
+        }
+
+        // Shortest that round trips, as PostgreSQL 12+ does
+        bool   single = sizeof(TYPE) == 4;
+        char  *to     = this->data + this->size;
+        int    n;
+
+        for (int precision = single ? 6 : 15; ; precision++) {
+            n = snprintf(to, 32, "%.*g", precision, (double)x);
+
+            if (precision == (single ? 9 : 17) || (TYPE)strtod(to, NULL) == x)
+                break;
+        }
+
+        this->size += n;
+    }
+
+    inline void
+    date(int32_t days)
+    {
+        int64_t year;
+        int     month, day;
+
+        b::calendar::civil((int64_t)days + DATE::EPOCH, &year, &month, &day);
+
+        bool bc = year <= 0;
+
+        this->digits(bc ? 1 - year : year, 4);
+        this->put('-');
+        this->digits(month, 2);
+        this->put('-');
+        this->digits(day, 2);
+
+        if (bc)
+            this->put(" BC", 3);
+    }
+
+    inline void
+    time(int64_t microseconds)
+    {
+        int64_t seconds = microseconds / 1000000;
+
+        this->digits(seconds / 3600, 2);
+        this->put(':');
+        this->digits(seconds / 60 % 60, 2);
+        this->put(':');
+        this->digits(seconds % 60, 2);
+
+        int fraction = microseconds % 1000000;
+        if (fraction != 0) {
+            int width = 6;
+            while (fraction % 10 == 0) {
+                fraction /= 10;
+                width--;
+            }
+            this->put('.');
+            this->digits(fraction, width);
+        }
+    }
+
+    inline void
+    timestamp(int64_t microseconds, bool utc)
+    {
+        int64_t days = microseconds / 86400000000LL;
+        int64_t rest = microseconds % 86400000000LL;
+
+        if (rest < 0) {
+            rest += 86400000000LL;
+            days -= 1;
+        }
+
+        int64_t year;
+        int     month, day;
+
+        b::calendar::civil(days + DATE::EPOCH, &year, &month, &day);
+
+        bool bc = year <= 0;
+
+        this->digits(bc ? 1 - year : year, 4);
+        this->put('-');
+        this->digits(month, 2);
+        this->put('-');
+        this->digits(day, 2);
+        this->put(' ');
+        this->time(rest);
+
+        if (utc)
+            this->put("+00", 3);
+        if (bc)
+            this->put(" BC", 3);
+    }
+
+    inline void
+    hex(const char *bytes, int length)
+    {
+        static const char DIGITS[] = "0123456789abcdef";
+
+        for (int i = 0; i < length; i++) {
+            unsigned char c = bytes[i];
+            this->put(DIGITS[c >> 4]);
+            this->put(DIGITS[c & 15]);
+        }
+    }
+
+  public:
+    char  *data;
+    size_t size;
+    size_t capacity;
+
+    char        delimiter;
+    const char *null;
+    size_t      null_length;
+
+    Writer(char delimiter, const char *null, size_t null_length) : data(NULL)
+                                                                 , size(0)
+                                                                 , capacity(0)
+                                                                 , delimiter(delimiter)
+                                                                 , null(null)
+                                                                 , null_length(null_length)
+    {
+    }
+
+    ~Writer()
+    {
+        free(this->data);
+    }
+
+    /**
+     * Append text, quoted if it holds the delimiter, a quote or a line
+     * break, or would read back as NULL.
+     */
+    bool
+    text(const char *value, size_t length)
+    {
+        if (!this->reserve(2 * length + 2))
+            return false;
+
+        bool quote = length == this->null_length && memcmp(value, this->null, length) == 0;
+
+        for (size_t i = 0; i < length && !quote; i++) {
+            char c = value[i];
+            quote = c == this->delimiter || c == '"' || c == '\n' || c == '\r';
+        }
+
+        if (!quote) {
+            this->put(value, length);
+            return true;
+        }
+
+        this->put('"');
+        for (size_t i = 0; i < length; i++) {
+            if (value[i] == '"')
+                this->put('"');
+            this->put(value[i]);
+        }
+        this->put('"');
+
+        return true;
+    }
+
+    bool
+    field(Oid oid, const char *value, int length)
+    {
+        switch (oid) {
+          case TEXT::OID:
+          case CHAR::OID:
+              return this->text(value, length);
+        }
+
+        // Fixed size output, other than bytea
+        if (!this->reserve(oid == BYTEA::OID ? 2 * (size_t)length + 2 : 64))
+            return false;
+
+        switch (oid) {
+          case BOOL  ::OID: this->put(*value ? 't' : 'f');                               break;
+          case INT2  ::OID: this->integer(postgresql::network::load<int16_t>(value));    break;
+          case INT4  ::OID: this->integer(postgresql::network::load<int32_t>(value));    break;
+          case INT8  ::OID: this->integer(postgresql::network::load<int64_t>(value));    break;
+          case FLOAT4::OID: this->real   (postgresql::network::load<float>  (value));    break;
+          case FLOAT8::OID: this->real   (postgresql::network::load<double> (value));    break;
+          case TIME  ::OID: this->time   (postgresql::network::load<int64_t>(value));    break;
+
+          case BYTEA::OID:
+              this->put("\\x", 2);
+              this->hex(value, length);
+              break;
+
+          case DATE::OID: {
+              int32_t x = postgresql::network::load<int32_t>(value);
+
+              if (x == INT32_MAX)
+                  this->put("infinity", 8);
+              else if (x == INT32_MIN)
+                  this->put("-infinity", 9);
+              else
+                  this->date(x);
+              break;
+          }
+
+          case TIMESTAMP  ::OID:
+          case TIMESTAMPTZ::OID: {
+              int64_t x = postgresql::network::load<int64_t>(value);
+
+              if (x == INT64_MAX)
+                  this->put("infinity", 8);
+              else if (x == INT64_MIN)
+                  this->put("-infinity", 9);
+              else
+                  this->timestamp(x, oid == TIMESTAMPTZ::OID);
+              break;
+          }
+
+          case UUID::OID:
+              this->hex(value,      4); this->put('-');
+              this->hex(value + 4,  2); this->put('-');
+              this->hex(value + 6,  2); this->put('-');
+              this->hex(value + 8,  2); this->put('-');
+              this->hex(value + 10, 6);
+              break;
+        }
+
+        return true;
+    }
+
+    bool
+    separator()
+    {
+        if (!this->reserve(1))
+            return false;
+        this->put(this->delimiter);
+        return true;
+    }
+
+    bool
+    newline()
+    {
+        if (!this->reserve(1))
+            return false;
+        this->put('\n');
+        return true;
+    }
+
+    bool
+    row(const Rows &rows, int k, int width, const int *columns, const Oid *oids)
+    {
+        for (int c = 0; c < width; c++) {
+            if (c != 0 && !this->separator())
+                return false;
+
+            int j = columns[c];
+
+            if (rows.isnull(k, j)) {
+                if (!this->reserve(this->null_length))
+                    return false;
+                this->put(this->null, this->null_length);
+                continue;
+            }
+
+            if (!this->field(oids[c], rows.value(k, j), rows.length(k, j)))
+                return false;
+        }
+
+        return this->newline();
+    }
+};
+
+} // namespace csv
+} // namespace postgresql
+
+#endif
@@ -0,0 +1,127 @@
+#ifndef POSTGRESQL_DICTIONARY_HPP_
+#define POSTGRESQL_DICTIONARY_HPP_
+
+#include <cstdint>
+#include <cstring>
+
+#include "Python.h"
+
+#include "b/hash.hpp"
+
+namespace postgresql {
+namespace dictionary {
+
+// Lookups before judging whether values repeat enough
+static const size_t SAMPLE = 4096;
+
+// Past this many distinct values, deduplicating is not worth its memory
+static const size_t MAX_ENTRIES = 1 << 16;
+
+class Entry
+{
+  public:
+    uint64_t    hash;
+    const char *value;  // Raw bytes, in the memory of the Result decoded
+    int         length;
+    PyObject   *string;
+};
+
+/**
+ * One shared object per distinct raw value of a column, while values
+ * repeat: it turns itself off once more than half the values looked up
+ * are distinct (or there are too many of them).
+ *
+ * Keys point into the decoded values, so it must not outlive them.
+ */
+class Dictionary
+{
+    b::hash::Table<Entry> _table;
+    size_t                _lookups;
+
+    void
+    clear()
+    {
+        for (size_t i = 0; i < this->_table.capacity(); i++) {
+            Entry *entry = this->_table.slot(i);
+
+            if (entry->hash != 0) {
+                Py_DECREF(entry->string);
+                entry->hash = 0;
+            }
+        }
+    }
+
+  public:
+    bool enabled;
+
+    Dictionary() : _lookups(0)
+                 , enabled(true)
+    {
+    }
+
+    ~Dictionary()
+    {
+        this->clear();
+    }
+
+    /**
+     * Return a new reference to the object of value, calling build() for it
+     * only the first time (or every time once disabled).
+     */
+    template <typename BUILD>
+    PyObject *
+    get(const char *value, int length, BUILD build)
+    {
+        if (!this->enabled)
+            return build();
+
+        this->_lookups++;
+
+        bool   inserted;
+        Entry *entry = this->_table.insert(b::hash::bytes(value, length), [&](const Entry &e) {
+            return e.length == length && memcmp(e.value, value, length) == 0;
+        }, &inserted);
+
+        if (entry == NULL) {
+            this->disable();
+            return build();
+        }
+
+        if (!inserted) {
+            Py_INCREF(entry->string);
+            return entry->string;
+        }
+
+        PyObject *x = build();
+
+        if (x == NULL) {
+            this->_table.erase(entry);
+            return NULL;
+        }
+
+        Py_INCREF(x);
+
+        entry->value  = value;
+        entry->length = length;
+        entry->string = x;
+
+        if (this->_table.size() > MAX_ENTRIES ||
+            (this->_lookups >= SAMPLE && this->_table.size() * 2 > this->_lookups))
+            this->disable();
+
+        return x;
+    }
+
+    // For good: the (emptied) table is not used again
+    void
+    disable()
+    {
+        this->clear();
+        this->enabled = false;
+    }
+};
+
+} // namespace dictionary
+} // namespace postgresql
+
+#endif
@@ -0,0 +1,229 @@
+#ifndef POSTGRESQL_INDEX_HPP_
+#define POSTGRESQL_INDEX_HPP_
+
+#include <cstdlib>
+
+#include "libpq-fe.h"
+
+#include "b/hash.hpp"
+#include "postgresql/network.hpp"
+#include "postgresql/rows.hpp"
+#include "postgresql/type.hpp"
+
+namespace postgresql {
+namespace index {
+
+/* Raw key values - integers of any width compare by value, all else by bytes */
+
+static inline bool
+is_integer(Oid oid)
+{
+    return oid == INT2::OID || oid == INT4::OID || oid == INT8::OID;
+}
+
+static inline int64_t
+integer(Oid oid, const char *value)
+{
+    switch (oid) {
+      case INT2::OID: return postgresql::network::load<int16_t>(value);
+      case INT4::OID: return postgresql::network::load<int32_t>(value);
+      default:        return postgresql::network::load<int64_t>(value);
+    }
+}
+
+static inline uint64_t
+hash(Oid oid, const char *value, int length)
+{
+    if (is_integer(oid)) {
+        int64_t x = integer(oid, value);
+        return b::hash::bytes((const char *)&x, sizeof(x));
+    }
+    return b::hash::bytes(value, length);
+}
+
+static inline bool
+equal(Oid a, const char *a_value, int a_length,
+      Oid b, const char *b_value, int b_length)
+{
+    if (is_integer(a) && is_integer(b))
+        return integer(a, a_value) == integer(b, b_value);
+    return a_length == b_length && memcmp(a_value, b_value, a_length) == 0;
+}
+
+/* Key sources */
+
+/**
+ * Key columns of a range of rows.
+ */
+class Columns
+{
+  public:
+    Rows       rows;
+    int        width;
+    const int *columns;
+    const Oid *oids;
+
+    inline bool
+    isnull(int k) const
+    {
+        for (int c = 0; c < this->width; c++) {
+            if (this->rows.isnull(k, this->columns[c]))
+                return true;
+        }
+        return false;
+    }
+
+    inline Oid
+    oid(int c) const
+    {
+        return this->oids[c];
+    }
+
+    inline const char *
+    value(int k, int c) const
+    {
+        return this->rows.value(k, this->columns[c]);
+    }
+
+    inline int
+    length(int k, int c) const
+    {
+        return this->rows.length(k, this->columns[c]);
+    }
+};
+
+/**
+ * A single key, as encoded into parameters.
+ */
+class Probe
+{
+  public:
+    int         width;
+    const Oid  *oids;
+    char      **values;
+    const int  *lengths;
+
+    inline Oid
+    oid(int c) const
+    {
+        return this->oids[c];
+    }
+
+    inline const char *
+    value(int k, int c) const
+    {
+        return this->values[c];
+    }
+
+    inline int
+    length(int k, int c) const
+    {
+        return this->lengths[c];
+    }
+};
+
+template <typename SOURCE>
+static inline uint64_t
+hash(const SOURCE &source, int k)
+{
+    uint64_t h = 0;
+
+    for (int c = 0; c < source.width; c++)
+        h = b::hash::combine(h, hash(source.oid(c), source.value(k, c), source.length(k, c)));
+
+    return h;
+}
+
+template <typename A, typename B>
+static inline bool
+equal(const A &a, int a_k, const B &b, int b_k)
+{
+    for (int c = 0; c < a.width; c++) {
+        if (!equal(a.oid(c), a.value(a_k, c), a.length(a_k, c),
+                   b.oid(c), b.value(b_k, c), b.length(b_k, c)))
+            return false;
+    }
+    return true;
+}
+
+/* Index */
+
+class Entry
+{
+  public:
+    uint64_t hash;
+    int      first; // Rows with this key, chained through Index::next
+    int      last;
+};
+
+/**
+ * Hash index over the key columns of some rows; rows with any NULL
+ * key column are left out, as they would never join.
+ */
+class Index
+{
+  public:
+    Columns               keys;
+    b::hash::Table<Entry> table;
+    int                  *next;
+
+    Index(const Columns &keys) : keys(keys)
+                               , next(NULL)
+    {
+    }
+
+    ~Index()
+    {
+        free(this->next);
+    }
+
+    /**
+     * Returns false if out of memory.
+     */
+    bool
+    build()
+    {
+        const Columns &keys = this->keys;
+
+        if ((this->next = (int *)malloc(sizeof(int) * (keys.rows.count > 0 ? keys.rows.count : 1))) == NULL)
+            return false;
+
+        for (int k = 0; k < keys.rows.count; k++) {
+            if (keys.isnull(k))
+                continue;
+
+            bool inserted;
+            Entry *entry = this->table.insert(
+                hash(keys, k),
+                [&](const Entry &e) { return equal(keys, e.first, keys, k); },
+                &inserted);
+
+            if (entry == NULL)
+                return false;
+
+            if (inserted)
+                entry->first = k;
+            else
+                this->next[entry->last] = k;
+
+            entry->last   = k;
+            this->next[k] = -1;
+        }
+
+        return true;
+    }
+
+    template <typename SOURCE>
+    inline const Entry *
+    find(const SOURCE &source, int k)
+    {
+        return this->table.find(
+            hash(source, k),
+            [&](const Entry &e) { return equal(this->keys, e.first, source, k); });
+    }
+};
+
+} // namespace index
+} // namespace postgresql
+
+#endif
@@ -0,0 +1,555 @@
+#ifndef POSTGRESQL_JSON_HPP_
+#define POSTGRESQL_JSON_HPP_
+
+#include <cstdint>
+#include <cstring>
+
+#include "Python.h"
+
+#include "b/hash.hpp"
+#include "b/unicode.hpp"
+
+namespace postgresql {
+namespace json {
+
+// Of arrays and objects
+static const int MAX_DEPTH = 512;
+
+// Slots of the key cache (a power of two)
+static const size_t KEYS = 64;
+
+class Key
+{
+  public:
+    uint64_t  hash;
+    PyObject *string; // ASCII
+};
+
+/**
+ * The str of the most recent ASCII key of each slot, by hash of its bytes:
+ * objects mostly repeat the same few keys, which then cost neither a new
+ * str nor hashing one.
+ */
+class Keys
+{
+    Key _slots[KEYS];
+
+  public:
+    Keys()
+    {
+        memset(this->_slots, 0, sizeof(this->_slots));
+    }
+
+    ~Keys()
+    {
+        for (size_t i = 0; i < KEYS; i++)
+            Py_XDECREF(this->_slots[i].string);
+    }
+
+    /**
+     * Return a new reference to the str of length ASCII bytes.
+     */
+    PyObject *
+    get(const char *bytes, size_t length)
+    {
+        uint64_t hash = b::hash::bytes(bytes, length);
+        Key     *key  = &this->_slots[hash & (KEYS - 1)];
+
+        if (key->string != NULL && key->hash == hash && (size_t)PyUnicode_GET_LENGTH(key->string) == length &&
+            memcmp(PyUnicode_1BYTE_DATA(key->string), bytes, length) == 0) {
+            Py_INCREF(key->string);
+            return key->string;
+        }
+
+        PyObject *x = PyUnicode_New(length, 127);
+        if (x == NULL)
+            return NULL;
+
+        memcpy(PyUnicode_1BYTE_DATA(x), bytes, length);
+
+        Py_XDECREF(key->string);
+        Py_INCREF(x);
+
+        key->hash   = hash;
+        key->string = x;
+
+        return x;
+    }
+};
+
+/**
+ * JSON text (RFC 8259) straight into dicts, lists, strs, ints, floats,
+ * bools and None, as json.loads would make them.
+ */
+class Parser
+{
+    const char *_begin;
+    const char *_p;
+    const char *_end;
+    int         _depth;
+    char       *_buffer;   // For unescaping strings and terminating numbers
+    size_t      _capacity;
+    Keys       *_keys;
+
+    PyObject *
+    error(const char *what)
+    {
+        PyErr_Format(PyExc_ValueError, "invalid JSON: %s at offset %zd", what, (Py_ssize_t)(this->_p - this->_begin));
+        return NULL;
+    }
+
+    inline void
+    skip()
+    {
+        while (this->_p < this->_end && (*this->_p == ' ' || *this->_p == '\n' || *this->_p == '\r' || *this->_p == '\t'))
+            this->_p++;
+    }
+
+    char *
+    reserve(size_t size)
+    {
+        if (size > this->_capacity) {
+            char *buffer = (char *)PyMem_Realloc(this->_buffer, size);
+            if (buffer == NULL) {
+                PyErr_NoMemory();
+                return NULL;
+            }
+
+            this->_buffer   = buffer;
+            this->_capacity = size;
+        }
+
+        return this->_buffer;
+    }
+
+    static inline int
+    hex(const char *p)
+    {
+        int x = 0;
+
+        for (int i = 0; i < 4; i++) {
+            char c = p[i];
+            int  d = c >= '0' && c <= '9' ? c - '0'
+                   : c >= 'a' && c <= 'f' ? c - 'a' + 10
+                   : c >= 'A' && c <= 'F' ? c - 'A' + 10
+                   : -1;
+            if (d == -1)
+                return -1;
+            x = x * 16 + d;
+        }
+
+        return x;
+    }
+
+    static inline char *
+    encode(char *out, uint32_t c)
+    {
+        if (c < 0x80) {
+            *out++ = (char)c;
+        } else if (c < 0x800) {
+            *out++ = (char)(0xC0 | (c >> 6));
+            *out++ = (char)(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+            *out++ = (char)(0xE0 | (c >> 12));
+            *out++ = (char)(0x80 | ((c >> 6) & 0x3F));
+            *out++ = (char)(0x80 | (c & 0x3F));
+        } else {
+            *out++ = (char)(0xF0 | (c >> 18));
+            *out++ = (char)(0x80 | ((c >> 12) & 0x3F));
+            *out++ = (char)(0x80 | ((c >> 6) & 0x3F));
+            *out++ = (char)(0x80 | (c & 0x3F));
+        }
+
+        return out;
+    }
+
+    /**
+     * Unescape the string of [p, end) (escapes included) into the buffer.
+     */
+    PyObject *
+    unescape(const char *p, const char *end)
+    {
+        // Escapes only ever shrink
+        char *out = this->reserve(end - p);
+        if (out == NULL)
+            return NULL;
+
+        char *begin = out;
+        bool  lone  = false; // Surrogate, which strict UTF-8 has no place for
+
+        while (p < end) {
+            if (*p != '\\') {
+                *out++ = *p++;
+                continue;
+            }
+
+            char c = p[1];
+            p += 2;
+
+            switch (c) {
+              case '"':  *out++ = '"';  break;
+              case '\\': *out++ = '\\'; break;
+              case '/':  *out++ = '/';  break;
+              case 'b':  *out++ = '\b'; break;
+              case 'f':  *out++ = '\f'; break;
+              case 'n':  *out++ = '\n'; break;
+              case 'r':  *out++ = '\r'; break;
+              case 't':  *out++ = '\t'; break;
+              case 'u': {
+                  int u = end - p >= 4 ? hex(p) : -1;
+                  if (u == -1) {
+                      this->_p = p;
+                      return this->error("invalid \\u escape");
+                  }
+                  p += 4;
+
+                  uint32_t code = u;
+
+                  if (u >= 0xD800 && u <= 0xDBFF && end - p >= 6 && p[0] == '\\' && p[1] == 'u') {
+                      int low = hex(p + 2);
+                      if (low >= 0xDC00 && low <= 0xDFFF) {
+                          code = 0x10000 + ((u - 0xD800) << 10) + (low - 0xDC00);
+                          p += 6;
+                      }
+                  }
+
+                  lone |= code >= 0xD800 && code <= 0xDFFF;
+                  out = encode(out, code);
+                  break;
+              }
+              default:
+                  this->_p = p - 1;
+                  return this->error("invalid escape");
+            }
+        }
+
+        if (lone)
+            return PyUnicode_DecodeUTF8(begin, out - begin, "surrogatepass");
+
+        return b::unicode::from_utf8(begin, out - begin);
+    }
+
+    PyObject *
+    string(bool key = false)
+    {
+        const char   *begin   = ++this->_p; // Past '"'
+        bool          escaped = false;
+        unsigned char high    = 0;
+
+        for (;;) {
+            if (this->_p == this->_end)
+                return this->error("unterminated string");
+
+            char c = *this->_p;
+
+            if (c == '"')
+                break;
+
+            if (c == '\\') {
+                escaped = true;
+                this->_p += 2;
+                if (this->_p > this->_end)
+                    this->_p = this->_end;
+                continue;
+            }
+
+            if ((unsigned char)c < 0x20)
+                return this->error("control character in string");
+
+            high |= c;
+            this->_p++;
+        }
+
+        const char *end = this->_p++;
+
+        if (escaped)
+            return this->unescape(begin, end);
+
+        if (high & 0x80)
+            return b::unicode::from_utf8(begin, end - begin);
+
+        if (key)
+            return this->_keys->get(begin, end - begin);
+
+        PyObject *x = PyUnicode_New(end - begin, 127);
+        if (x != NULL)
+            memcpy(PyUnicode_1BYTE_DATA(x), begin, end - begin);
+
+        return x;
+    }
+
+    PyObject *
+    number()
+    {
+        const char *begin   = this->_p;
+        bool        integer = true;
+
+        if (this->_p < this->_end && *this->_p == '-')
+            this->_p++;
+
+        const char *digits = this->_p;
+
+        while (this->_p < this->_end && *this->_p >= '0' && *this->_p <= '9')
+            this->_p++;
+
+        if (this->_p == digits || (*digits == '0' && this->_p - digits > 1))
+            return this->error("invalid number");
+
+        if (this->_p < this->_end && *this->_p == '.') {
+            integer = false;
+            const char *fraction = ++this->_p;
+            while (this->_p < this->_end && *this->_p >= '0' && *this->_p <= '9')
+                this->_p++;
+            if (this->_p == fraction)
+                return this->error("invalid number");
+        }
+
+        if (this->_p < this->_end && (*this->_p == 'e' || *this->_p == 'E')) {
+            integer = false;
+            this->_p++;
+            if (this->_p < this->_end && (*this->_p == '+' || *this->_p == '-'))
+                this->_p++;
+            const char *exponent = this->_p;
+            while (this->_p < this->_end && *this->_p >= '0' && *this->_p <= '9')
+                this->_p++;
+            if (this->_p == exponent)
+                return this->error("invalid number");
+        }
+
+        size_t length = this->_p - begin;
+
+        // Below 10^18, without text
+        if (integer && this->_p - digits <= 18) {
+            int64_t x = 0;
+
+            for (const char *d = digits; d < this->_p; d++)
+                x = x * 10 + (*d - '0');
+
+            return PyLong_FromLongLong(*begin == '-' ? -x : x);
+        }
+
+        char *text = this->reserve(length + 1);
+        if (text == NULL)
+            return NULL;
+
+        memcpy(text, begin, length);
+        text[length] = '\0';
+
+        if (integer)
+            return PyLong_FromString(text, NULL, 10);
+
+        double x = PyOS_string_to_double(text, NULL, NULL);
+        if (x == -1.0 && PyErr_Occurred())
+            return NULL;
+
+        return PyFloat_FromDouble(x);
+    }
+
+    PyObject *
+    literal(const char *word, size_t length, PyObject *x)
+    {
+        if ((size_t)(this->_end - this->_p) < length || memcmp(this->_p, word, length) != 0)
+            return this->error("unexpected character");
+
+        this->_p += length;
+
+        Py_INCREF(x);
+        return x;
+    }
+
+    PyObject *
+    array()
+    {
+        PyObject *list = PyList_New(0);
+        if (list == NULL)
+            return NULL;
+
+        this->_p++; // Past '['
+        this->skip();
+
+        if (this->_p < this->_end && *this->_p == ']') {
+            this->_p++;
+            return list;
+        }
+
+        for (;;) {
+            PyObject *x = this->value();
+
+            if (x == NULL || PyList_Append(list, x) == -1) {
+                Py_XDECREF(x);
+                Py_DECREF(list);
+                return NULL;
+            }
+
+            Py_DECREF(x);
+            this->skip();
+
+            if (this->_p < this->_end && *this->_p == ',') {
+                this->_p++;
+                continue;
+            }
+
+            if (this->_p < this->_end && *this->_p == ']') {
+                this->_p++;
+                return list;
+            }
+
+            Py_DECREF(list);
+            return this->error("expected ',' or ']'");
+        }
+    }
+
+    PyObject *
+    object()
+    {
+        PyObject *dict = PyDict_New();
+        if (dict == NULL)
+            return NULL;
+
+        this->_p++; // Past '{'
+        this->skip();
+
+        if (this->_p < this->_end && *this->_p == '}') {
+            this->_p++;
+            return dict;
+        }
+
+        for (;;) {
+            if (this->_p == this->_end || *this->_p != '"') {
+                Py_DECREF(dict);
+                return this->error("expected a key");
+            }
+
+            PyObject *key = this->string(true);
+            if (key == NULL) {
+                Py_DECREF(dict);
+                return NULL;
+            }
+
+            this->skip();
+
+            if (this->_p == this->_end || *this->_p != ':') {
+                Py_DECREF(key);
+                Py_DECREF(dict);
+                return this->error("expected ':'");
+            }
+
+            this->_p++;
+
+            PyObject *x = this->value();
+
+            if (x == NULL || PyDict_SetItem(dict, key, x) == -1) {
+                Py_XDECREF(x);
+                Py_DECREF(key);
+                Py_DECREF(dict);
+                return NULL;
+            }
+
+            Py_DECREF(x);
+            Py_DECREF(key);
+            this->skip();
+
+            if (this->_p < this->_end && *this->_p == ',') {
+                this->_p++;
+                this->skip();
+                continue;
+            }
+
+            if (this->_p < this->_end && *this->_p == '}') {
+                this->_p++;
+                return dict;
+            }
+
+            Py_DECREF(dict);
+            return this->error("expected ',' or '}'");
+        }
+    }
+
+    PyObject *
+    value()
+    {
+        this->skip();
+
+        if (this->_p == this->_end)
+            return this->error("unexpected end");
+
+        switch (*this->_p) {
+          case '"': return this->string();
+          case 't': return this->literal("true",  4, Py_True);
+          case 'f': return this->literal("false", 5, Py_False);
+          case 'n': return this->literal("null",  4, Py_None);
+          case '[':
+          case '{': {
+              if (++this->_depth > MAX_DEPTH) {
+                  this->_depth--;
+                  return this->error("nested too deeply");
+              }
+
+              PyObject *x = *this->_p == '[' ? this->array() : this->object();
+
+              this->_depth--;
+              return x;
+          }
+          default:
+              return this->number();
+        }
+    }
+
+  public:
+    Parser(const char *text, size_t length, Keys *keys) : _begin(text)
+                                            , _p(text)
+                                            , _end(text + length)
+                                            , _depth(0)
+                                            , _buffer(NULL)
+                                            , _capacity(0)
+                                            , _keys(keys)
+    {
+    }
+
+    ~Parser()
+    {
+        PyMem_Free(this->_buffer);
+    }
+
+    /**
+     * The value of the whole text, or NULL (ValueError) if not one.
+     */
+    PyObject *
+    parse()
+    {
+        PyObject *x = this->value();
+        if (x == NULL)
+            return NULL;
+
+        this->skip();
+
+        if (this->_p != this->_end) {
+            Py_DECREF(x);
+            return this->error("extra data");
+        }
+
+        return x;
+    }
+};
+
+/**
+ * The value of text, or NULL (ValueError), with ASCII keys shared through keys.
+ */
+static inline PyObject *
+parse(const char *text, size_t length, Keys *keys)
+{
+    Parser parser(text, length, keys);
+    return parser.parse();
+}
+
+static inline PyObject *
+parse(const char *text, size_t length)
+{
+    Keys keys;
+    return parse(text, length, &keys);
+}
+
+} // namespace json
+} // namespace postgresql
+
+#endif
@@ -1,6 +1,8 @@
 #ifndef POSTGRESQL_NETWORK_HPP_
 #define POSTGRESQL_NETWORK_HPP_
 
+#include <cstring>
+
 #include "b/endian.hpp"
 
 namespace postgresql {
@@ -16,6 +18,52 @@ order(TYPE x)
         return b::endian::swap(x);
 }
 
+/**
+ * Read a value stored in network order from possibly unaligned bytes.
+ */
+template <typename TYPE>
+static inline TYPE
+load(const char *bytes)
+{
+    TYPE x;
+    memcpy(&x, bytes, sizeof(TYPE));
+    return order(x);
+}
+
+template <>
+inline int8_t
+load<int8_t>(const char *bytes)
+{
+    return *bytes;
+}
+
+template <>
+inline uint8_t
+load<uint8_t>(const char *bytes)
+{
+    return *bytes;
+}
+
+template <>
+inline float
+load<float>(const char *bytes)
+{
+    uint32_t i = load<uint32_t>(bytes);
+    float x;
+    memcpy(&x, &i, sizeof(x));
+    return x;
+}
+
+template <>
+inline double
+load<double>(const char *bytes)
+{
+    uint64_t i = load<uint64_t>(bytes);
+    double x;
+    memcpy(&x, &i, sizeof(x));
+    return x;
+}
+
 } // namespace network
 } // namespace postgresql
 
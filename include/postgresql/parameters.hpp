@@ -2,16 +2,23 @@
 #define POSTGRESQL_PARAMETERS_HPP_
 
 #include "Python.h"
+#include "datetime.h"
 
 #include "libpq-fe.h"
 
+#include "b/calendar.hpp"
+#include "b/endian.hpp"
+
+#include "postgresql/array.hpp"
 #include "postgresql/network.hpp"
+#include "postgresql/registry.hpp"
 #include "postgresql/type.hpp"
 
 namespace postgresql {
 namespace parameters {
 
-static const size_t MAX_BYTES_PER = 8;
+// Of scratch per parameter, as an interval's
+static const size_t MAX_BYTES_PER = 16;
 
 class Parameters
 {
@@ -22,20 +29,171 @@ class Parameters
     int   *formats_i;
     char  *scratch_i;
 
+    // Encoders of other types, NULL if none
+    registry::Registry *registry;
+
+    // Encoded values referenced until the command is executed
+    PyObject *owned;
+
+    Parameters() : registry(NULL)
+                 , owned(NULL)
+    {
+    }
+
+    ~Parameters()
+    {
+        Py_XDECREF(this->owned);
+    }
+
+  private:
+    /**
+     * Append a parameter of type oid and length bytes, to be written
+     * (in network order) at the scratch returned.
+     */
+    inline char *
+    fixed(Oid oid, int length)
+    {
+        char *scratch = this->scratch_i;
+
+        *this->types_i++   = oid;
+        *this->values_i++  = scratch;
+        *this->lengths_i++ = length;
+        *this->formats_i++ = 1;
+
+        this->scratch_i += length;
+
+        return scratch;
+    }
+
+    template <typename TYPE>
+    static inline void
+    store(char *scratch, TYPE x)
+    {
+        x = postgresql::network::order(x);
+        memcpy(scratch, &x, sizeof(TYPE));
+    }
+
+    /**
+     * Append a value referenced in place (kept alive by the caller,
+     * or else by owning it).
+     */
+    inline bool
+    reference(Oid oid, const char *value, Py_ssize_t length, int format = 1)
+    {
+        if (length > INT_MAX) {
+            PyErr_SetString(PyExc_OverflowError, "parameter too long");
+            return false;
+        }
+
+        *this->types_i++   = oid;
+        *this->values_i++  = (char *)value;
+        *this->lengths_i++ = (int)length;
+        *this->formats_i++ = format;
+
+        return true;
+    }
+
+    inline bool
+    own(PyObject *x)
+    {
+        if (this->owned == NULL && (this->owned = PyList_New(0)) == NULL)
+            return false;
+
+        return PyList_Append(this->owned, x) == 0;
+    }
+
+    // Bytes of size to be filled, then referenced once owned
+    inline PyObject *
+    allocate(int64_t size)
+    {
+        if (size > INT_MAX) {
+            PyErr_SetString(PyExc_OverflowError, "parameter too long");
+            return NULL;
+        }
+
+        return PyBytes_FromStringAndSize(NULL, (Py_ssize_t)size);
+    }
+
+    inline bool
+    reference_owned(Oid oid, PyObject *bytes, int format = 1)
+    {
+        bool owned = this->own(bytes);
+        Py_DECREF(bytes);
+
+        return owned && this->reference(oid, PyBytes_AS_STRING(bytes), PyBytes_GET_SIZE(bytes), format);
+    }
+
+    /**
+     * Microseconds east of UTC of a datetime or time with a tzinfo, and
+     * whether that makes it aware: the tzinfo may give no offset (None).
+     */
+    static inline bool
+    utcoffset(PyObject *x, PyObject *tzinfo, int64_t *microseconds, bool *aware)
+    {
+        *microseconds = 0;
+        *aware        = true;
+
+        if (tzinfo == PyDateTime_TimeZone_UTC)
+            return true;
+
+        PyObject *offset = PyObject_CallMethod(x, "utcoffset", NULL);
+        if (offset == NULL)
+            return false;
+
+        if (offset == Py_None) {
+            *aware = false;
+        } else if (PyDelta_Check(offset)) {
+            *microseconds = ((int64_t)PyDateTime_DELTA_GET_DAYS(offset) * 86400 +
+                             PyDateTime_DELTA_GET_SECONDS(offset)) * datetime::USECS_PER_SECOND +
+                            PyDateTime_DELTA_GET_MICROSECONDS(offset);
+        }
+
+        Py_DECREF(offset);
+        return true;
+    }
+
+    // The array type of the element types encoded as arrays
+    static inline Oid
+    array_of(Oid element)
+    {
+        switch (element) {
+          case   BOOL::OID: return   BOOL::OID_ARRAY;
+          case   INT2::OID: return   INT2::OID_ARRAY;
+          case   INT4::OID: return   INT4::OID_ARRAY;
+          case   INT8::OID: return   INT8::OID_ARRAY;
+          case FLOAT4::OID: return FLOAT4::OID_ARRAY;
+          case FLOAT8::OID: return FLOAT8::OID_ARRAY;
+          default:          return   TEXT::OID_ARRAY;
+        }
+    }
+
+  public:
     // Constants
 
     inline bool
     append_true()
     {
-        TODO();
-        return false;
+        *this->fixed(BOOL::OID, 1) = 1;
+        return true;
     }
 
     inline bool
     append_false()
     {
-        TODO();
-        return false;
+        *this->fixed(BOOL::OID, 1) = 0;
+        return true;
+    }
+
+    // A NULL of the type the server infers
+    inline bool
+    append_null()
+    {
+        *this->types_i++   = 0;
+        *this->values_i++  = NULL;
+        *this->lengths_i++ = 0;
+        *this->formats_i++ = 1;
+
+        return true;
     }
 
     inline bool
@@ -49,74 +207,499 @@ class Parameters
         if (cls ==   &PyFloat_Type) return this->append(  (PyFloatObject *)x);
         if (cls ==    &PyBool_Type) return (x == Py_True) ? this->append_true() : this->append_false();
         if (cls ==   &PyBytes_Type) return this->append(  (PyBytesObject *)x);
+        if (x == Py_None)           return this->append_null();
+        if (cls ==    &PyList_Type) return this->append_sequence(x);
+        if (cls ==   &PyTuple_Type) return this->append_sequence(x);
+
+        // Then the standard library's
+        if (!datetime::import())
+            return false;
+
+        // Subclasses too; datetime is a date, so first
+        if (PyDateTime_Check(x)) return this->append_datetime(x);
+        if (PyDate_Check(x))     return this->append_date(x);
+        if (PyTime_Check(x))     return this->append_time(x);
+        if (PyDelta_Check(x))    return this->append_timedelta(x);
+
+        static PyObject *classes[2] = {NULL, NULL}; // Decimal, UUID
+
+        PyObject *decimal = imported(&classes[0], "decimal", "Decimal");
+        if (decimal == NULL)
+            return false;
+
+        if (PyObject_TypeCheck(x, (PyTypeObject *)decimal))
+            return this->append_decimal(x);
+
+        PyObject *uuid = imported(&classes[1], "uuid", "UUID");
+        if (uuid == NULL)
+            return false;
+
+        if (PyObject_TypeCheck(x, (PyTypeObject *)uuid))
+            return this->append_uuid(x);
+
+        registry::Encoder *encoder = this->registry != NULL ? this->registry->encoder(cls) : NULL;
+
+        if (encoder != NULL)
+            return this->append(encoder, x);
+
+        // Arrays (array.array, numpy, ...) straight from their memory
+        if (PyObject_CheckBuffer(x))
+            return this->append_buffer(x);
 
         PyErr_Format(PyExc_NotImplementedError, "encode(%R)", x);
         return false;
     }
 
-    inline bool
-    append(int16_t x)
+    /**
+     * Append x as encoded by a registered encoder: bytes are sent in
+     * binary, str as text for the server to parse.
+     */
+    bool
+    append(registry::Encoder *encoder, PyObject *x)
     {
-        char *scratch = this->scratch_i;
+        PyObject *encoded = PyObject_CallFunctionObjArgs(encoder->function, x, NULL);
+        if (encoded == NULL)
+            return false;
 
-        *this->types_i++   = INT2::OID;
-        *this->values_i++  = scratch;
-        *this->lengths_i++ = 2;
-        *this->formats_i++ = 1;
+        bool owned = this->own(encoded);
+        Py_DECREF(encoded);
+        if (!owned)
+            return false;
 
-        *(int16_t *)scratch = postgresql::network::order(x);
+        char       *value;
+        Py_ssize_t  length;
+        int         format;
+
+        if (PyBytes_Check(encoded)) {
+            value  = PyBytes_AS_STRING(encoded);
+            length = PyBytes_GET_SIZE(encoded);
+            format = 1;
+        } else if (PyUnicode_Check(encoded)) {
+            if ((value = (char *)PyUnicode_AsUTF8AndSize(encoded, &length)) == NULL)
+                return false;
+            format = 0;
+        } else {
+            PyErr_Format(PyExc_TypeError, "encoder of %R must return bytes or str, got: %R", Py_TYPE(x), encoded);
+            return false;
+        }
 
-        this->scratch_i += 2;
+        *this->types_i++   = encoder->oid;
+        *this->values_i++  = value;
+        *this->lengths_i++ = (int)length;
+        *this->formats_i++ = format;
 
         return true;
     }
 
+    inline bool
+    append(int16_t x)
+    {
+        store(this->fixed(INT2::OID, 2), x);
+        return true;
+    }
+
     inline bool
     append(int32_t x)
     {
-        char *scratch = this->scratch_i;
+        store(this->fixed(INT4::OID, 4), x);
+        return true;
+    }
 
-        *this->types_i++   = INT4::OID;
-        *this->values_i++  = scratch;
-        *this->lengths_i++ = 4;
-        *this->formats_i++ = 1;
+    inline bool
+    append(int64_t x)
+    {
+        store(this->fixed(INT8::OID, 8), x);
+        return true;
+    }
 
-        *(int32_t *)scratch = postgresql::network::order(x);
+    // Referenced, not copied: the caller's arguments outlive the command
+    inline bool
+    append(PyBytesObject *x)
+    {
+        return this->reference(BYTEA::OID, PyBytes_AS_STRING(x), PyBytes_GET_SIZE(x));
+    }
 
-        this->scratch_i += 4;
+    inline bool
+    append(PyFloatObject *x)
+    {
+        double   d = PyFloat_AS_DOUBLE(x);
+        uint64_t i;
+
+        memcpy(&i, &d, sizeof(i));
+        store(this->fixed(FLOAT8::OID, 8), i);
 
         return true;
     }
 
-    inline bool
-    append(int64_t x)
+    // Naive as timestamp, aware as timestamptz (in UTC); a tzinfo without an
+    // offset leaves it naive
+    bool
+    append_datetime(PyObject *x)
     {
-        char *scratch = this->scratch_i;
+        int64_t days = b::calendar::days(PyDateTime_GET_YEAR(x), PyDateTime_GET_MONTH(x), PyDateTime_GET_DAY(x)) - DATE::EPOCH;
 
-        *this->types_i++   = INT8::OID;
-        *this->values_i++  = scratch;
-        *this->lengths_i++ = 8;
-        *this->formats_i++ = 1;
+        int64_t microseconds = days * datetime::USECS_PER_DAY +
+                               ((PyDateTime_DATE_GET_HOUR(x) * 60LL + PyDateTime_DATE_GET_MINUTE(x)) * 60 +
+                                PyDateTime_DATE_GET_SECOND(x)) * datetime::USECS_PER_SECOND +
+                               PyDateTime_DATE_GET_MICROSECOND(x);
 
-        *(int64_t *)scratch = postgresql::network::order(x);
+        PyObject *tzinfo = _PyDateTime_HAS_TZINFO(x) ? ((PyDateTime_DateTime *)x)->tzinfo : Py_None;
+        int64_t   offset = 0;
+        bool      aware  = false;
 
-        this->scratch_i += 8;
+        if (tzinfo != Py_None && !utcoffset(x, tzinfo, &offset, &aware))
+            return false;
+
+        if (!aware) {
+            store(this->fixed(TIMESTAMP::OID, 8), microseconds);
+            return true;
+        }
 
+        store(this->fixed(TIMESTAMPTZ::OID, 8), microseconds - offset);
         return true;
     }
 
-    inline bool
-    append(PyBytesObject *x)
+    bool
+    append_date(PyObject *x)
     {
-        TODO();
-        return false;
+        int64_t days = b::calendar::days(PyDateTime_GET_YEAR(x), PyDateTime_GET_MONTH(x), PyDateTime_GET_DAY(x)) - DATE::EPOCH;
+
+        store(this->fixed(DATE::OID, 4), (int32_t)days);
+        return true;
     }
 
-    inline bool
-    append(PyFloatObject *x)
+    // Naive as time, aware as timetz; a tzinfo without an offset leaves it
+    // naive
+    bool
+    append_time(PyObject *x)
     {
-        TODO();
-        return false;
+        int64_t microseconds = ((PyDateTime_TIME_GET_HOUR(x) * 60LL + PyDateTime_TIME_GET_MINUTE(x)) * 60 +
+                                PyDateTime_TIME_GET_SECOND(x)) * datetime::USECS_PER_SECOND +
+                               PyDateTime_TIME_GET_MICROSECOND(x);
+
+        PyObject *tzinfo = _PyDateTime_HAS_TZINFO(x) ? ((PyDateTime_Time *)x)->tzinfo : Py_None;
+        int64_t   offset = 0;
+        bool      aware  = false;
+
+        if (tzinfo != Py_None && !utcoffset(x, tzinfo, &offset, &aware))
+            return false;
+
+        if (!aware) {
+            store(this->fixed(TIME::OID, 8), microseconds);
+            return true;
+        }
+
+        // The zone in seconds west of UTC
+        char *scratch = this->fixed(TIMETZ::OID, 12);
+
+        store(scratch,     microseconds);
+        store(scratch + 8, (int32_t)(-offset / datetime::USECS_PER_SECOND));
+
+        return true;
+    }
+
+    // As an interval of days and microseconds, without months
+    bool
+    append_timedelta(PyObject *x)
+    {
+        int64_t microseconds = PyDateTime_DELTA_GET_SECONDS(x) * datetime::USECS_PER_SECOND +
+                               PyDateTime_DELTA_GET_MICROSECONDS(x);
+
+        char *scratch = this->fixed(INTERVAL::OID, 16);
+
+        store(scratch,      microseconds);
+        store(scratch + 8,  (int32_t)PyDateTime_DELTA_GET_DAYS(x));
+        store(scratch + 12, (int32_t)0);
+
+        return true;
+    }
+
+    // Built into bytes, which are owned until the command is executed
+    bool
+    append_decimal(PyObject *x)
+    {
+        PyObject *bytes = NUMERIC::encode(x);
+        if (bytes == NULL)
+            return false;
+
+        return this->reference_owned(NUMERIC::OID, bytes);
+    }
+
+    // Its int, in 16 bytes big-endian
+    bool
+    append_uuid(PyObject *x)
+    {
+        PyObject *integer = PyObject_GetAttrString(x, "int");
+        if (integer == NULL)
+            return false;
+
+        if (!PyLong_Check(integer)) {
+            Py_DECREF(integer);
+            PyErr_Format(PyExc_TypeError, "expecting an int UUID, got: %R", x);
+            return false;
+        }
+
+        unsigned char bytes[16];
+        int           converted = _PyLong_AsByteArray((PyLongObject *)integer, bytes, 16, 0, 0);
+        Py_DECREF(integer);
+
+        if (converted == -1)
+            return false;
+
+        memcpy(this->fixed(UUID::OID, 16), bytes, 16);
+        return true;
+    }
+
+    /**
+     * A list or tuple as a one-dimensional binary array of its elements'
+     * type: int (int2[], int4[] or int8[], as wide as the widest), float
+     * (float8[]), str (text[]) or bool (bool[]), any of them None.
+     *
+     * Without any typed element, it goes as text ('{}', '{NULL}', ...)
+     * for the server to infer its type.
+     */
+    bool
+    append_sequence(PyObject *x)
+    {
+        Py_ssize_t  n     = PySequence_Fast_GET_SIZE(x);
+        PyObject  **items = PySequence_Fast_ITEMS(x);
+
+        if (n > INT_MAX) {
+            PyErr_SetString(PyExc_OverflowError, "array too long");
+            return false;
+        }
+
+        PyTypeObject *cls   = NULL;
+        Py_ssize_t    nulls = 0;
+        int64_t       size  = 0;  // Of the elements, without their length words
+        int           width = 2;  // Of ints
+
+        for (Py_ssize_t i = 0; i < n; i++) {
+            PyObject *item = items[i];
+
+            if (item == Py_None) {
+                nulls++;
+                continue;
+            }
+
+            if (cls == NULL) {
+                cls = Py_TYPE(item);
+
+                if (cls != &PyLong_Type && cls != &PyFloat_Type && cls != &PyUnicode_Type && cls != &PyBool_Type) {
+                    PyErr_Format(PyExc_TypeError, "cannot encode an array of %R", cls);
+                    return false;
+                }
+            } else if (Py_TYPE(item) != cls) {
+                PyErr_Format(PyExc_TypeError, "array elements must all be of one type, got: %R and %R", cls, Py_TYPE(item));
+                return false;
+            }
+
+            if (cls == &PyLong_Type) {
+                long long v = PyLong_AsLongLong(item);
+                if (v == -1 && PyErr_Occurred())
+                    return false;
+
+                if (v < INT16_MIN || v > INT16_MAX)
+                    width = (width == 8 || v < INT32_MIN || v > INT32_MAX) ? 8 : 4;
+            } else if (cls == &PyUnicode_Type) {
+                Py_ssize_t length;
+                if (PyUnicode_AsUTF8AndSize(item, &length) == NULL)
+                    return false;
+
+                size += length;
+            }
+        }
+
+        if (cls == NULL)
+            return this->append_nulls(n);
+
+        Oid oid;
+
+        if      (cls == &PyLong_Type)  oid = width == 2 ? INT2::OID : width == 4 ? INT4::OID : INT8::OID;
+        else if (cls == &PyFloat_Type) oid = FLOAT8::OID, width = 8;
+        else if (cls == &PyBool_Type)  oid = BOOL::OID, width = 1;
+        else                           oid = TEXT::OID, width = 0;
+
+        if (width != 0)
+            size = (int64_t)(n - nulls) * width;
+
+        int       dimension = (int)n;
+        PyObject *bytes     = this->allocate(array::header_size(1) + 4 * (int64_t)n + size);
+        if (bytes == NULL)
+            return false;
+
+        char *p = array::header(PyBytes_AS_STRING(bytes), 1, &dimension, nulls > 0, oid);
+
+        for (Py_ssize_t i = 0; i < n; i++) {
+            PyObject *item = items[i];
+
+            if (item == Py_None) {
+                store(p, (int32_t)-1);
+                p += 4;
+                continue;
+            }
+
+            if (width == 0) {
+                Py_ssize_t  length;
+                const char *utf8 = PyUnicode_AsUTF8AndSize(item, &length);
+
+                store(p, (int32_t)length);
+                memcpy(p + 4, utf8, length);
+                p += 4 + length;
+                continue;
+            }
+
+            store(p, (int32_t)width);
+            p += 4;
+
+            if (cls == &PyLong_Type) {
+                long long v = PyLong_AsLongLong(item);
+
+                if      (width == 2) store(p, (int16_t)v);
+                else if (width == 4) store(p, (int32_t)v);
+                else                 store(p, (int64_t)v);
+            } else if (cls == &PyFloat_Type) {
+                double   d = PyFloat_AS_DOUBLE(item);
+                uint64_t bits;
+
+                memcpy(&bits, &d, sizeof(bits));
+                store(p, bits);
+            } else {
+                *p = item == Py_True;
+            }
+
+            p += width;
+        }
+
+        return this->reference_owned(array_of(oid), bytes);
+    }
+
+    // As text, of no type
+    bool
+    append_nulls(Py_ssize_t n)
+    {
+        PyObject *bytes = this->allocate(n > 0 ? 5 * (int64_t)n + 1 : 2);
+        if (bytes == NULL)
+            return false;
+
+        char *p = PyBytes_AS_STRING(bytes);
+
+        *p++ = '{';
+        for (Py_ssize_t i = 0; i < n; i++) {
+            memcpy(p, i == 0 ? "NULL" : ",NULL", i == 0 ? 4 : 5);
+            p += i == 0 ? 4 : 5;
+        }
+        *p++ = '}';
+
+        return this->reference_owned(0, bytes, 0);
+    }
+
+    /**
+     * A C-contiguous buffer of signed ints, floats or bools, of up to
+     * MAX_DIMENSIONS dimensions, as a binary array of their type, its
+     * elements copied (and byte-swapped if need be) in bulk; or a flat
+     * buffer of bytes (bytearray, memoryview of bytes, ...) as bytea.
+     */
+    bool
+    append_buffer(PyObject *x)
+    {
+        Py_buffer view;
+
+        if (PyObject_GetBuffer(x, &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == -1)
+            return false;
+
+        bool ok = this->append(&view);
+
+        PyBuffer_Release(&view);
+        return ok;
+    }
+
+    bool
+    append(const Py_buffer *view)
+    {
+        const char *format = view->format != NULL ? view->format : "B";
+
+        // Native (or standard) order, unless said little or big
+        bool big = b::endian::BIG;
+
+        switch (*format) {
+          case '@': case '=': format++; break;
+          case '<':           format++; big = false; break;
+          case '>': case '!': format++; big = true; break;
+        }
+
+        // Copied, as the buffer could change before the command is executed
+        if ((format[0] == 'B' || format[0] == 'c') && format[1] == 0 && view->itemsize == 1 && view->ndim == 1) {
+            PyObject *bytes = this->allocate(view->len);
+            if (bytes == NULL)
+                return false;
+
+            memcpy(PyBytes_AS_STRING(bytes), view->buf, view->len);
+            return this->reference_owned(BYTEA::OID, bytes);
+        }
+
+        Oid oid = 0;
+
+        if (format[0] != 0 && format[1] == 0) {
+            switch (format[0]) {
+              case 'h': case 'i': case 'l': case 'q': case 'n':
+                  oid = view->itemsize == 2 ? INT2::OID :
+                        view->itemsize == 4 ? INT4::OID :
+                        view->itemsize == 8 ? INT8::OID : 0;
+                  break;
+
+              case 'f': oid = view->itemsize == 4 ? FLOAT4::OID : 0; break;
+              case 'd': oid = view->itemsize == 8 ? FLOAT8::OID : 0; break;
+              case '?': oid = view->itemsize == 1 ?   BOOL::OID : 0; break;
+            }
+        }
+
+        if (oid == 0) {
+            PyErr_Format(PyExc_TypeError, "cannot encode a buffer of format '%s' (of %zd-byte items)",
+                         view->format != NULL ? view->format : "B", view->itemsize);
+            return false;
+        }
+
+        if (view->ndim < 1 || view->ndim > array::MAX_DIMENSIONS) {
+            PyErr_Format(PyExc_ValueError, "cannot encode a buffer of %d dimensions", view->ndim);
+            return false;
+        }
+
+        int     ndim  = view->ndim;
+        int64_t count = view->len / view->itemsize;
+        int     dimensions[array::MAX_DIMENSIONS];
+
+        for (int d = 0; d < ndim; d++) {
+            Py_ssize_t dimension = view->shape != NULL ? view->shape[d] : count;
+
+            if (dimension > INT_MAX) {
+                PyErr_SetString(PyExc_OverflowError, "array too long");
+                return false;
+            }
+
+            dimensions[d] = (int)dimension;
+        }
+
+        // Empty arrays have no dimensions
+        if (count == 0)
+            ndim = 0;
+
+        PyObject *bytes = this->allocate(array::header_size(ndim) + (4 + view->itemsize) * count);
+        if (bytes == NULL)
+            return false;
+
+        char       *p    = array::header(PyBytes_AS_STRING(bytes), ndim, dimensions, false, oid);
+        const char *in   = (const char *)view->buf;
+        bool        swap = !big;
+
+        switch (view->itemsize) {
+          case 1: array::fill<uint8_t> (in, count, swap, p); break;
+          case 2: array::fill<uint16_t>(in, count, swap, p); break;
+          case 4: array::fill<uint32_t>(in, count, swap, p); break;
+          case 8: array::fill<uint64_t>(in, count, swap, p); break;
+        }
+
+        return this->reference_owned(array_of(oid), bytes);
     }
 
     inline bool
@@ -0,0 +1,90 @@
+#ifndef POSTGRESQL_RANGE_HPP_
+#define POSTGRESQL_RANGE_HPP_
+
+#include <cstdint>
+
+#include "postgresql/network.hpp"
+
+namespace postgresql {
+namespace range {
+
+// Of the flags byte, as PostgreSQL's rangetypes.h
+static const uint8_t EMPTY          = 0x01;
+static const uint8_t LOWER_INC      = 0x02;
+static const uint8_t UPPER_INC      = 0x04;
+static const uint8_t LOWER_INFINITE = 0x08;
+static const uint8_t UPPER_INFINITE = 0x10;
+
+/**
+ * A binary range value:
+ *
+ *   uint8 flags,
+ *   (int32 length, bytes) of the lower bound unless empty or infinite,
+ *   (int32 length, bytes) of the upper bound unless empty or infinite
+ *
+ * An absent bound has a NULL value.
+ */
+class Range
+{
+  public:
+    uint8_t     flags;
+    const char *lower;
+    int         lower_length;
+    const char *upper;
+    int         upper_length;
+};
+
+static inline bool
+bound(const char **p, const char *end, const char **value, int *length)
+{
+    if (end - *p < 4)
+        return false;
+
+    int n = postgresql::network::load<int32_t>(*p);
+    *p += 4;
+
+    if (n < 0 || end - *p < n)
+        return false;
+
+    *value  = *p;
+    *length = n;
+    *p     += n;
+
+    return true;
+}
+
+/**
+ * Parse a binary range value.
+ * Returns false if malformed.
+ */
+static inline bool
+parse(const char *value, int length, Range *range)
+{
+    const char *p   = value;
+    const char *end = value + length;
+
+    if (length < 1)
+        return false;
+
+    range->flags        = *p++;
+    range->lower        = NULL;
+    range->lower_length = 0;
+    range->upper        = NULL;
+    range->upper_length = 0;
+
+    if (range->flags & EMPTY)
+        return p == end;
+
+    if (!(range->flags & LOWER_INFINITE) && !bound(&p, end, &range->lower, &range->lower_length))
+        return false;
+
+    if (!(range->flags & UPPER_INFINITE) && !bound(&p, end, &range->upper, &range->upper_length))
+        return false;
+
+    return p == end;
+}
+
+} // namespace range
+} // namespace postgresql
+
+#endif
@@ -0,0 +1,124 @@
+#ifndef POSTGRESQL_RECORDS_HPP_
+#define POSTGRESQL_RECORDS_HPP_
+
+#include <cstring>
+
+#include "libpq-fe.h"
+
+#include "postgresql/network.hpp"
+#include "postgresql/rows.hpp"
+#include "postgresql/type.hpp"
+
+namespace postgresql {
+namespace records {
+
+/**
+ * The struct module format character of a fixed-width type, or 0.
+ *
+ * DATE and TIMESTAMP[TZ] are int64 days/microseconds since the Unix
+ * epoch, as numpy's datetime64[D] and datetime64[us] expect.
+ */
+static inline char
+format(Oid oid)
+{
+    switch (oid) {
+      case BOOL       ::OID: return '?';
+      case INT2       ::OID: return 'h';
+      case INT4       ::OID: return 'i';
+      case INT8       ::OID: return 'q';
+      case FLOAT4     ::OID: return 'f';
+      case FLOAT8     ::OID: return 'd';
+      case DATE       ::OID:
+      case TIMESTAMP  ::OID:
+      case TIMESTAMPTZ::OID: return 'q';
+    }
+    return 0;
+}
+
+static inline size_t
+size(char format)
+{
+    switch (format) {
+      case '?': return 1;
+      case 'h': return 2;
+      case 'i':
+      case 'f': return 4;
+    }
+    return 8;
+}
+
+class Field
+{
+  public:
+    int    j;      // pg_result column
+    Oid    oid;
+    size_t offset; // Within a record
+};
+
+template <typename TYPE>
+static inline void
+store(char *to, TYPE x)
+{
+    memcpy(to, &x, sizeof(x));
+}
+
+/**
+ * Pack rows into records of the given fields, in native byte order.
+ * NULLs are zeroed and flagged in nulls, a row-major bitmap of
+ * count * width bits, least significant bit first.  No Python API.
+ */
+static inline void
+pack(const Rows &rows, const Field *fields, int width, size_t itemsize, char *data, uint8_t *nulls)
+{
+    memset(nulls, 0, ((size_t)rows.count * width + 7) / 8);
+
+    for (int k = 0; k < rows.count; k++) {
+        char *record = data + (size_t)k * itemsize;
+
+        for (int c = 0; c < width; c++) {
+            const Field &field = fields[c];
+            char        *to    = record + field.offset;
+
+            if (rows.isnull(k, field.j)) {
+                size_t bit = (size_t)k * width + c;
+                nulls[bit >> 3] |= 1 << (bit & 7);
+                memset(to, 0, size(format(field.oid)));
+                continue;
+            }
+
+            const char *value = rows.value(k, field.j);
+
+            switch (field.oid) {
+              case BOOL  ::OID: *to = *value != 0;                                              break;
+              case INT2  ::OID: store(to, postgresql::network::load<int16_t>(value)); break;
+              case INT4  ::OID: store(to, postgresql::network::load<int32_t>(value)); break;
+              case INT8  ::OID: store(to, postgresql::network::load<int64_t>(value)); break;
+              case FLOAT4::OID: store(to, postgresql::network::load<float>  (value)); break;
+              case FLOAT8::OID: store(to, postgresql::network::load<double> (value)); break;
+
+              case DATE::OID: {
+                  int32_t days = postgresql::network::load<int32_t>(value);
+                  // +/-infinity go to the limits
+                  int64_t x = days == INT32_MAX ? INT64_MAX :
+                              days == INT32_MIN ? INT64_MIN : (int64_t)days + DATE::EPOCH;
+                  store(to, x);
+                  break;
+              }
+
+              case TIMESTAMP  ::OID:
+              case TIMESTAMPTZ::OID: {
+                  int64_t x = postgresql::network::load<int64_t>(value);
+                  if (x != INT64_MAX && x != INT64_MIN)
+                      x += TIMESTAMP::EPOCH;
+                  store(to, x);
+                  break;
+              }
+            }
+        }
+    }
+}
+
+} // namespace records
+} // namespace postgresql
+
+#endif
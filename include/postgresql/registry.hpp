@@ -0,0 +1,265 @@
+#ifndef POSTGRESQL_REGISTRY_HPP_
+#define POSTGRESQL_REGISTRY_HPP_
+
+#include <cstdint>
+#include <new>
+
+#include "Python.h"
+#include "libpq-fe.h"
+
+#include "b/hash.hpp"
+
+namespace postgresql {
+namespace registry {
+
+class Decoder
+{
+  public:
+    enum Kind {
+        NATIVE,   // As the natively decoded type as
+        FUNCTION, // By calling function with a memoryview of the value
+        ARRAY,    // Of elements of a registered (or native) type
+        RECORD,   // Composite, its fields carrying their types
+        RANGE,    // Of elements of type as
+    };
+
+    uint64_t  hash;
+    Oid       oid;
+    Kind      kind;
+    Oid       as;
+    PyObject *function;
+    bool      cataloged; // From a loaded schema, so replaced by reloading it
+};
+
+class Encoder
+{
+  public:
+    uint64_t      hash;
+    PyTypeObject *cls;
+    Oid           oid;
+    PyObject     *function; // Returning bytes (binary) or str (text)
+};
+
+static inline uint64_t
+hash(uint64_t x)
+{
+    return b::hash::mix(x * b::hash::MULTIPLIER);
+}
+
+/**
+ * Decoders of types not decoded natively, by OID, and encoders of Python
+ * types not encoded natively, by class: consulted only once the native
+ * dispatch has found nothing, so built-in types cost nothing more.
+ *
+ * Shared by a Database and its Results, which each hold a reference:
+ * the Database registers into a copy of its own once it is shared, so
+ * that existing Results keep decoding as they did.
+ */
+class Registry
+{
+    b::hash::Table<Decoder> _decoders;
+    b::hash::Table<Encoder> _encoders;
+    size_t                  _references;
+
+    ~Registry()
+    {
+        for (size_t i = 0; i < this->_decoders.capacity(); i++) {
+            Decoder *decoder = this->_decoders.slot(i);
+            if (decoder->hash != 0)
+                Py_XDECREF(decoder->function);
+        }
+
+        for (size_t i = 0; i < this->_encoders.capacity(); i++) {
+            Encoder *encoder = this->_encoders.slot(i);
+            if (encoder->hash != 0) {
+                Py_DECREF(encoder->cls);
+                Py_DECREF(encoder->function);
+            }
+        }
+    }
+
+  public:
+    Registry() : _references(1)
+    {
+    }
+
+    inline void
+    retain()
+    {
+        this->_references++;
+    }
+
+    inline void
+    release()
+    {
+        if (--this->_references == 0)
+            delete this;
+    }
+
+    inline bool
+    shared() const
+    {
+        return this->_references > 1;
+    }
+
+    /**
+     * A new registry with the same decoders and encoders, or NULL if out
+     * of memory.
+     */
+    Registry *
+    copy()
+    {
+        Registry *copy = new (std::nothrow) Registry();
+        if (copy == NULL) {
+            PyErr_NoMemory();
+            return NULL;
+        }
+
+        for (size_t i = 0; i < this->_decoders.capacity(); i++) {
+            Decoder *d = this->_decoders.slot(i);
+
+            if (d->hash != 0 && !copy->decode(d->oid, d->kind, d->as, d->function, d->cataloged)) {
+                copy->release();
+                return NULL;
+            }
+        }
+
+        for (size_t i = 0; i < this->_encoders.capacity(); i++) {
+            Encoder *e = this->_encoders.slot(i);
+
+            if (e->hash != 0 && !copy->encode(e->cls, e->oid, e->function)) {
+                copy->release();
+                return NULL;
+            }
+        }
+
+        return copy;
+    }
+
+    inline Decoder *
+    decoder(Oid oid)
+    {
+        return this->_decoders.find(hash(oid), [&](const Decoder &d) { return d.oid == oid; });
+    }
+
+    /**
+     * The encoder of cls, or else of its nearest base class that has one.
+     */
+    Encoder *
+    encoder(PyTypeObject *cls)
+    {
+        if (this->_encoders.size() == 0)
+            return NULL;
+
+        Encoder *encoder = this->_encoders.find(hash((uintptr_t)cls), [&](const Encoder &e) { return e.cls == cls; });
+        if (encoder != NULL || cls->tp_mro == NULL)
+            return encoder;
+
+        for (Py_ssize_t i = 1; i < PyTuple_GET_SIZE(cls->tp_mro); i++) {
+            PyTypeObject *base = (PyTypeObject *)PyTuple_GET_ITEM(cls->tp_mro, i);
+
+            encoder = this->_encoders.find(hash((uintptr_t)base), [&](const Encoder &e) { return e.cls == base; });
+            if (encoder != NULL)
+                return encoder;
+        }
+
+        return NULL;
+    }
+
+    /**
+     * Set the decoder of oid, replacing any; function (if any) is borrowed.
+     * Returns false if out of memory.
+     */
+    bool
+    decode(Oid oid, Decoder::Kind kind, Oid as, PyObject *function, bool cataloged = false)
+    {
+        bool     inserted;
+        Decoder *decoder = this->_decoders.insert(hash(oid), [&](const Decoder &d) { return d.oid == oid; }, &inserted);
+
+        if (decoder == NULL) {
+            PyErr_NoMemory();
+            return false;
+        }
+
+        if (!inserted)
+            Py_XDECREF(decoder->function);
+
+        Py_XINCREF(function);
+
+        decoder->oid       = oid;
+        decoder->kind      = kind;
+        decoder->as        = as;
+        decoder->function  = function;
+        decoder->cataloged = cataloged;
+
+        return true;
+    }
+
+    /**
+     * Set the encoder of cls, replacing any; cls and function are borrowed.
+     * Returns false if out of memory.
+     */
+    bool
+    encode(PyTypeObject *cls, Oid oid, PyObject *function)
+    {
+        bool     inserted;
+        Encoder *encoder = this->_encoders.insert(hash((uintptr_t)cls), [&](const Encoder &e) { return e.cls == cls; }, &inserted);
+
+        if (encoder == NULL) {
+            PyErr_NoMemory();
+            return false;
+        }
+
+        if (!inserted) {
+            Py_DECREF(encoder->cls);
+            Py_DECREF(encoder->function);
+        }
+
+        Py_INCREF(cls);
+        Py_INCREF(function);
+
+        encoder->cls      = cls;
+        encoder->oid      = oid;
+        encoder->function = function;
+
+        return true;
+    }
+};
+
+/**
+ * Call function with a read-only memoryview of the value, valid only
+ * during the call (it is released after, so must not be kept).
+ */
+static inline PyObject *
+call(PyObject *function, const char *value, int length)
+{
+    PyObject *view = PyMemoryView_FromMemory((char *)value, length, PyBUF_READ);
+    if (view == NULL)
+        return NULL;
+
+    PyObject *x = PyObject_CallFunctionObjArgs(function, view, NULL);
+
+    // Any error of the call takes precedence over one releasing
+    PyObject *type, *error, *traceback;
+    PyErr_Fetch(&type, &error, &traceback);
+
+    PyObject *released = PyObject_CallMethod(view, "release", NULL);
+    Py_DECREF(view);
+
+    if (released == NULL && x != NULL) {
+        Py_XDECREF(type);
+        Py_XDECREF(error);
+        Py_XDECREF(traceback);
+        Py_DECREF(x);
+        return NULL;
+    }
+
+    Py_XDECREF(released);
+    PyErr_Restore(type, error, traceback);
+    return x;
+}
+
+} // namespace registry
+} // namespace postgresql
+
+#endif
@@ -0,0 +1,59 @@
+#ifndef POSTGRESQL_ROWS_HPP_
+#define POSTGRESQL_ROWS_HPP_
+
+#include "libpq-fe.h"
+
+#include "postgresql/store.hpp"
+
+namespace postgresql {
+
+/**
+ * A (strided) range of rows of a PGresult (or, if set, of a store),
+ * as selected by a Result view.
+ *
+ * Holds no Python references, so native kernels may use it with the
+ * GIL released while the owning Result is kept alive.
+ */
+class Rows
+{
+  public:
+    PGresult           *pg_result;
+    const store::Store *store;
+    int                 start;
+    int                 step;
+    int                 count;
+
+    inline int
+    row(int k) const
+    {
+        return this->start + k * this->step;
+    }
+
+    inline bool
+    isnull(int k, int j) const
+    {
+        if (this->store != NULL)
+            return this->store->isnull(this->row(k), j);
+        return PQgetisnull(this->pg_result, this->row(k), j);
+    }
+
+    inline const char *
+    value(int k, int j) const
+    {
+        if (this->store != NULL)
+            return this->store->value(this->row(k), j);
+        return PQgetvalue(this->pg_result, this->row(k), j);
+    }
+
+    inline int
+    length(int k, int j) const
+    {
+        if (this->store != NULL)
+            return this->store->length(this->row(k), j);
+        return PQgetlength(this->pg_result, this->row(k), j);
+    }
+};
+
+} // namespace postgresql
+
+#endif
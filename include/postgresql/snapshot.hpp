@@ -0,0 +1,140 @@
+#ifndef POSTGRESQL_SNAPSHOT_HPP_
+#define POSTGRESQL_SNAPSHOT_HPP_
+
+#include <cstdint>
+#include <cstring>
+
+#include "libpq-fe.h"
+
+#include "postgresql/rows.hpp"
+#include "postgresql/store.hpp"
+
+namespace postgresql {
+namespace snapshot {
+
+/**
+ * Columns of a range of rows, to copy into a store.
+ */
+class Selection
+{
+  public:
+    Rows                rows;
+    int                 width;
+    const int          *columns;
+    const Oid          *oids;
+    const char * const *names;
+};
+
+static inline uint64_t
+row_size(const Selection &selection, int k)
+{
+    uint64_t size = sizeof(store::Cell) * selection.width;
+
+    for (int c = 0; c < selection.width; c++)
+        size += selection.rows.length(k, selection.columns[c]);
+
+    return store::align(size);
+}
+
+/**
+ * Size of the store of selection, or 0 if it cannot be laid out
+ * (a row or the names past the reach of 32-bit offsets).
+ */
+static inline uint64_t
+size(const Selection &selection)
+{
+    uint64_t size = sizeof(store::Header) + sizeof(store::Column) * (uint64_t)selection.width;
+
+    for (int c = 0; c < selection.width; c++)
+        size += strlen(selection.names[c]) + 1;
+
+    if (size > UINT32_MAX)
+        return 0;
+
+    size = store::align(size);
+
+    for (int k = 0; k < selection.rows.count; k++) {
+        uint64_t row = row_size(selection, k);
+
+        if (row > UINT32_MAX)
+            return 0;
+
+        size += row;
+    }
+
+    return size + sizeof(uint64_t) * (uint64_t)selection.rows.count;
+}
+
+/**
+ * Lay out the store of selection in data, of size(selection) bytes
+ * and aligned to store::ALIGNMENT.
+ *
+ * Touches no Python state.
+ */
+static inline void
+write(const Selection &selection, char *data, uint64_t size)
+{
+    int width = selection.width;
+    int count = selection.rows.count;
+
+    store::Header *header = (store::Header *)data;
+
+    memset(header, 0, sizeof(*header));
+    memcpy(header->magic, store::MAGIC, sizeof(store::MAGIC));
+    header->version = store::VERSION;
+    header->columns = (uint32_t)width;
+    header->rows    = (uint64_t)count;
+    header->size    = size;
+    header->index   = size - sizeof(uint64_t) * (uint64_t)count;
+
+    store::Column *columns = (store::Column *)(data + sizeof(store::Header));
+    uint64_t       offset  = sizeof(store::Header) + sizeof(store::Column) * (uint64_t)width;
+
+    for (int c = 0; c < width; c++) {
+        size_t length = strlen(selection.names[c]) + 1;
+
+        columns[c].oid  = selection.oids[c];
+        columns[c].name = (uint32_t)offset;
+
+        memcpy(data + offset, selection.names[c], length);
+        offset += length;
+    }
+
+    memset(data + offset, 0, store::align(offset) - offset);
+    offset = store::align(offset);
+
+    uint64_t *index = (uint64_t *)(data + header->index);
+
+    for (int k = 0; k < count; k++) {
+        char        *row   = data + offset;
+        store::Cell *cells = (store::Cell *)row;
+        uint32_t     end   = sizeof(store::Cell) * width;
+
+        index[k] = offset;
+
+        for (int c = 0; c < width; c++) {
+            int j = selection.columns[c];
+
+            cells[c].offset = end;
+
+            if (selection.rows.isnull(k, j)) {
+                cells[c].length = -1;
+                continue;
+            }
+
+            int length = selection.rows.length(k, j);
+
+            cells[c].length = length;
+            memcpy(row + end, selection.rows.value(k, j), length);
+            end += length;
+        }
+
+        memset(row + end, 0, store::align(end) - end);
+        offset += store::align(end);
+    }
+}
+
+} // namespace snapshot
+} // namespace postgresql
+
+#endif
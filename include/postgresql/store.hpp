@@ -0,0 +1,605 @@
+#ifndef POSTGRESQL_STORE_HPP_
+#define POSTGRESQL_STORE_HPP_
+
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "libpq-fe.h"
+
+#include "postgresql/type.hpp"
+
+namespace postgresql {
+namespace store {
+
+/*
+ * A compact, self-describing copy of a result's rows, laid out as:
+ *
+ *   Header
+ *   Column[columns]          type and name of each column
+ *   names                    NUL-terminated, padded to ALIGNMENT
+ *   rows                     each Cell[columns] then its values,
+ *                            padded to ALIGNMENT
+ *   uint64_t[rows]           offset of each row
+ *
+ * Values are as received (binary format, network order); all else is
+ * in native order. The layout holds no pointers, so it may live in
+ * malloc'ed memory, a mapped file, or be copied around as bytes.
+ */
+
+static const char     MAGIC[8]  = {'P', 'G', 'S', 'T', 'O', 'R', 'E', '\0'};
+static const uint32_t VERSION   = 1;
+static const size_t   ALIGNMENT = 8;
+
+// Write buffer of a store spilled to disk
+static const size_t CHUNK_SIZE = 1 << 20;
+
+struct Header {
+    char     magic[8];
+    uint32_t version;
+    uint32_t columns;
+    uint64_t rows;
+    uint64_t size;  // Of the whole store, in bytes
+    uint64_t index; // Offset of the row offsets
+};
+
+struct Column {
+    uint32_t oid;
+    uint32_t name; // Offset of the name
+};
+
+struct Cell {
+    uint32_t offset; // Of the value, from the start of its row
+    int32_t  length; // -1 if NULL
+};
+
+static inline size_t
+align(size_t size)
+{
+    return (size + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+/**
+ * The length of every value of a fixed-width type, or -1.
+ */
+static inline int
+width(Oid oid)
+{
+    switch (oid) {
+      case BOOL       ::OID: return 1;
+      case INT2       ::OID: return 2;
+      case INT4       ::OID:
+      case FLOAT4     ::OID:
+      case DATE       ::OID: return 4;
+      case INT8       ::OID:
+      case FLOAT8     ::OID:
+      case TIME       ::OID:
+      case TIMESTAMP  ::OID:
+      case TIMESTAMPTZ::OID: return 8;
+      case TIMETZ     ::OID: return 12;
+      case INTERVAL   ::OID:
+      case UUID       ::OID: return 16;
+    }
+    return -1;
+}
+
+/**
+ * Read access to a store, with the same cell semantics as a PGresult.
+ */
+class Store
+{
+  public:
+    enum Memory {
+        BORROWED, // Owned by someone else
+        MALLOC,
+        MAPPED,
+    };
+
+  private:
+    const char     *_data;
+    size_t          _size;
+    Memory          _memory;
+    const Header   *_header;
+    const Column   *_columns;
+    const uint64_t *_index;
+
+  public:
+    Store(const char *data, size_t size, Memory memory) : _data(data)
+                                                        , _size(size)
+                                                        , _memory(memory)
+                                                        , _header((const Header *)data)
+                                                        , _columns((const Column *)(data + sizeof(Header)))
+                                                        , _index(NULL)
+    {
+        if (size >= sizeof(Header))
+            this->_index = (const uint64_t *)(data + this->_header->index);
+    }
+
+    ~Store()
+    {
+        switch (this->_memory) {
+          case MALLOC: free((void *)this->_data);                  break;
+          case MAPPED: munmap((void *)this->_data, this->_size);   break;
+          default:                                                 break;
+        }
+    }
+
+    /**
+     * Check that data is a well-formed store that all accessors
+     * stay within, and whose fixed-width values have their type's
+     * width, as it may have come from anywhere.
+     */
+    static bool
+    valid(const char *data, size_t size)
+    {
+        const Header *header = (const Header *)data;
+
+        if (size < sizeof(Header) || ((uintptr_t)data % ALIGNMENT) != 0)
+            return false;
+
+        if (memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION)
+            return false;
+
+        if (header->size != size || header->columns > INT_MAX || header->rows > INT_MAX)
+            return false;
+
+        uint64_t columns_end = sizeof(Header) + (uint64_t)header->columns * sizeof(Column);
+
+        if (columns_end > size
+            || header->index % ALIGNMENT != 0
+            || header->index < columns_end
+            || header->index > size
+            || (size - header->index) / sizeof(uint64_t) < header->rows)
+            return false;
+
+        const Column *columns = (const Column *)(data + sizeof(Header));
+
+        for (uint32_t j = 0; j < header->columns; j++) {
+            uint64_t name = columns[j].name;
+
+            if (name < columns_end || name >= header->index || memchr(data + name, '\0', header->index - name) == NULL)
+                return false;
+        }
+
+        const uint64_t *index = (const uint64_t *)(data + header->index);
+        uint64_t        cells = (uint64_t)header->columns * sizeof(Cell);
+
+        for (uint64_t i = 0; i < header->rows; i++) {
+            uint64_t row = index[i];
+
+            if (row % ALIGNMENT != 0 || row < columns_end || row > header->index || header->index - row < cells)
+                return false;
+
+            const Cell *cell = (const Cell *)(data + row);
+
+            for (uint32_t j = 0; j < header->columns; j++) {
+                int fixed = width(columns[j].oid);
+
+                if (cell[j].length < 0) {
+                    if (cell[j].length != -1)
+                        return false;
+                } else if (cell[j].offset < cells
+                           || (uint64_t)cell[j].offset + (uint64_t)cell[j].length > header->index - row
+                           || (fixed != -1 && cell[j].length != fixed)) {
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    inline const char *
+    data() const
+    {
+        return this->_data;
+    }
+
+    inline size_t
+    size() const
+    {
+        return this->_size;
+    }
+
+    inline int
+    rows() const
+    {
+        return (int)this->_header->rows;
+    }
+
+    inline int
+    columns() const
+    {
+        return (int)this->_header->columns;
+    }
+
+    inline Oid
+    oid(int j) const
+    {
+        return this->_columns[j].oid;
+    }
+
+    inline const char *
+    name(int j) const
+    {
+        return this->_data + this->_columns[j].name;
+    }
+
+    inline const Cell &
+    cell(int i, int j) const
+    {
+        return ((const Cell *)(this->_data + this->_index[i]))[j];
+    }
+
+    inline bool
+    isnull(int i, int j) const
+    {
+        return this->cell(i, j).length < 0;
+    }
+
+    inline const char *
+    value(int i, int j) const
+    {
+        return this->_data + this->_index[i] + this->cell(i, j).offset;
+    }
+
+    inline int
+    length(int i, int j) const
+    {
+        int length = this->cell(i, j).length;
+        return length < 0 ? 0 : length;
+    }
+};
+
+/**
+ * Build a store from the rows of PGresults (one at a time, as in
+ * single-row mode), in memory until it would exceed budget bytes,
+ * then appended to an unlinked temporary file, mapped once finished.
+ *
+ * Touches no Python state. Methods returning false have set error
+ * (an errno) and the builder can only be destroyed.
+ */
+class Builder
+{
+    size_t    _budget;   // 0 for no limit
+    char     *_buffer;   // The store, or once spilled, its unwritten tail
+    size_t    _size;
+    size_t    _capacity;
+    int       _fd;       // -1 unless spilled
+    uint64_t  _written;  // Bytes of the store in the file
+    uint64_t *_index;
+    uint64_t  _rows;
+    uint64_t  _index_capacity;
+    int       _columns;
+
+    inline uint64_t
+    position() const
+    {
+        return this->_written + this->_size;
+    }
+
+    bool
+    fail(int error)
+    {
+        this->error = error;
+        return false;
+    }
+
+    bool
+    flush()
+    {
+        const char *p = this->_buffer;
+        size_t      n = this->_size;
+
+        while (n > 0) {
+            ssize_t w = write(this->_fd, p, n);
+
+            if (w == -1) {
+                if (errno == EINTR)
+                    continue;
+                return this->fail(errno);
+            }
+
+            p += w;
+            n -= (size_t)w;
+        }
+
+        this->_written += this->_size;
+        this->_size     = 0;
+        return true;
+    }
+
+    bool
+    grow(size_t capacity)
+    {
+        char *buffer = (char *)realloc(this->_buffer, capacity);
+        if (buffer == NULL)
+            return this->fail(ENOMEM);
+
+        this->_buffer   = buffer;
+        this->_capacity = capacity;
+        return true;
+    }
+
+    /**
+     * Move what is in memory to a temporary file, from now on only
+     * buffering writes to it.
+     */
+    bool
+    spill()
+    {
+        const char *directory = getenv("TMPDIR");
+        if (directory == NULL || *directory == '\0')
+            directory = "/tmp";
+
+        size_t length = strlen(directory);
+        char  *path   = (char *)malloc(length + sizeof("/postgresql-XXXXXX"));
+        if (path == NULL)
+            return this->fail(ENOMEM);
+
+        memcpy(path, directory, length);
+        memcpy(path + length, "/postgresql-XXXXXX", sizeof("/postgresql-XXXXXX"));
+
+        this->_fd = mkstemp(path);
+
+        int error = errno;
+        if (this->_fd != -1) {
+            unlink(path);
+            fcntl(this->_fd, F_SETFD, FD_CLOEXEC);
+        }
+        free(path);
+
+        if (this->_fd == -1)
+            return this->fail(error);
+
+        return this->flush() && (this->_capacity >= CHUNK_SIZE || this->grow(CHUNK_SIZE));
+    }
+
+    /**
+     * Make room for size more bytes at the end of the buffer.
+     */
+    bool
+    reserve(size_t size)
+    {
+        if (this->_fd == -1 && this->_budget != 0 && this->_size + size > this->_budget) {
+            if (!this->spill())
+                return false;
+        }
+
+        if (this->_fd != -1 && this->_size + size > this->_capacity) {
+            if (!this->flush())
+                return false;
+        }
+
+        if (this->_size + size > this->_capacity) {
+            size_t capacity = this->_capacity > 0 ? this->_capacity : 4096;
+
+            while (capacity < this->_size + size)
+                capacity *= 2;
+
+            if (!this->grow(capacity))
+                return false;
+        }
+
+        return true;
+    }
+
+    bool
+    put(const void *data, size_t size)
+    {
+        if (!this->reserve(size))
+            return false;
+
+        memcpy(this->_buffer + this->_size, data, size);
+        this->_size += size;
+        return true;
+    }
+
+    bool
+    pad()
+    {
+        static const char ZEROS[ALIGNMENT] = {0};
+
+        return this->put(ZEROS, align(this->position()) - this->position());
+    }
+
+  public:
+    int error;
+
+    Builder(size_t budget) : _budget(budget)
+                           , _buffer(NULL)
+                           , _size(0)
+                           , _capacity(0)
+                           , _fd(-1)
+                           , _written(0)
+                           , _index(NULL)
+                           , _rows(0)
+                           , _index_capacity(0)
+                           , _columns(-1)
+                           , error(0)
+    {
+    }
+
+    ~Builder()
+    {
+        free(this->_buffer);
+        free(this->_index);
+
+        if (this->_fd != -1)
+            close(this->_fd);
+    }
+
+    inline bool
+    begun() const
+    {
+        return this->_columns != -1;
+    }
+
+    /**
+     * Start the store with the columns described by pg_result.
+     */
+    bool
+    begin(const PGresult *pg_result)
+    {
+        int columns = PQnfields(pg_result);
+
+        Header header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.columns = (uint32_t)columns;
+
+        if (!this->put(&header, sizeof(header)))
+            return false;
+
+        uint64_t name = sizeof(Header) + (uint64_t)columns * sizeof(Column);
+
+        for (int j = 0; j < columns; j++) {
+            Column column;
+            column.oid  = PQftype(pg_result, j);
+            column.name = (uint32_t)name;
+
+            if (!this->put(&column, sizeof(column)))
+                return false;
+
+            name += strlen(PQfname(pg_result, j)) + 1;
+        }
+
+        for (int j = 0; j < columns; j++) {
+            const char *name = PQfname(pg_result, j);
+
+            if (!this->put(name, strlen(name) + 1))
+                return false;
+        }
+
+        this->_columns = columns;
+        return this->pad();
+    }
+
+    /**
+     * Append row i of pg_result, which has the columns given to begin().
+     */
+    bool
+    append(const PGresult *pg_result, int i)
+    {
+        if (this->_rows == INT_MAX)
+            return this->fail(EOVERFLOW);
+
+        if (this->_rows == this->_index_capacity) {
+            uint64_t  capacity = this->_index_capacity > 0 ? this->_index_capacity * 2 : 1024;
+            uint64_t *index    = (uint64_t *)realloc(this->_index, sizeof(uint64_t) * capacity);
+            if (index == NULL)
+                return this->fail(ENOMEM);
+
+            this->_index          = index;
+            this->_index_capacity = capacity;
+        }
+
+        int    columns = this->_columns;
+        size_t size    = sizeof(Cell) * columns;
+
+        for (int j = 0; j < columns; j++)
+            size += PQgetlength(pg_result, i, j);
+
+        if (!this->reserve(align(size)))
+            return false;
+
+        this->_index[this->_rows++] = this->position();
+
+        char  *row    = this->_buffer + this->_size;
+        Cell  *cells  = (Cell *)row;
+        size_t offset = sizeof(Cell) * columns;
+
+        for (int j = 0; j < columns; j++) {
+            cells[j].offset = (uint32_t)offset;
+
+            if (PQgetisnull(pg_result, i, j)) {
+                cells[j].length = -1;
+                continue;
+            }
+
+            int length = PQgetlength(pg_result, i, j);
+
+            cells[j].length = length;
+            memcpy(row + offset, PQgetvalue(pg_result, i, j), length);
+            offset += length;
+        }
+
+        memset(row + offset, 0, align(size) - size);
+        this->_size += align(size);
+        return true;
+    }
+
+    /**
+     * Complete the store, returning it (new'ed) or NULL.
+     */
+    Store *
+    finish()
+    {
+        uint64_t index = this->position();
+
+        if (!this->put(this->_index, sizeof(uint64_t) * this->_rows))
+            return NULL;
+
+        uint64_t size = this->position();
+
+        Header header;
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.columns = (uint32_t)this->_columns;
+        header.rows    = this->_rows;
+        header.size    = size;
+        header.index   = index;
+
+        Store *store;
+
+        if (this->_fd == -1) {
+            memcpy(this->_buffer, &header, sizeof(header));
+
+            store = new (std::nothrow) Store(this->_buffer, this->_size, Store::MALLOC);
+            if (store == NULL) {
+                this->fail(ENOMEM);
+                return NULL;
+            }
+
+            this->_buffer = NULL;
+            return store;
+        }
+
+        if (!this->flush())
+            return NULL;
+
+        if (pwrite(this->_fd, &header, sizeof(header), 0) != sizeof(header)) {
+            this->fail(errno);
+            return NULL;
+        }
+
+        void *data = mmap(NULL, size, PROT_READ, MAP_SHARED, this->_fd, 0);
+        if (data == MAP_FAILED) {
+            this->fail(errno);
+            return NULL;
+        }
+
+        store = new (std::nothrow) Store((const char *)data, size, Store::MAPPED);
+        if (store == NULL) {
+            munmap(data, size);
+            this->fail(ENOMEM);
+            return NULL;
+        }
+
+        return store;
+    }
+};
+
+} // namespace store
+} // namespace postgresql
+
+#endif
@@ -1,22 +1,252 @@
 #ifndef POSTGRESQL_TYPE_HPP_
 #define POSTGRESQL_TYPE_HPP_
 
+#include <climits>
+#include <cstring>
+
 #include "Python.h"
+#include "datetime.h"
 #include "libpq-fe.h"
 
+#include "b/calendar.hpp"
+#include "b/unicode.hpp"
+#include "b/utf8.hpp"
+#include "postgresql/array.hpp"
+#include "postgresql/composite.hpp"
+#include "postgresql/json.hpp"
 #include "postgresql/network.hpp"
+#include "postgresql/range.hpp"
+#include "postgresql/registry.hpp"
 
 namespace postgresql {
 
+/**
+ * Per-Result choices of how to decode values, all defaulting to zero.
+ */
+class Options
+{
+  public:
+    enum Arrays {
+        ARRAYS_LIST,   // Nested lists
+        ARRAYS_BUFFER, // Memoryviews of fixed-width numbers, where possible
+    };
+
+    enum Datetimes {
+        DATETIMES_OBJECTS, // datetime module objects
+        DATETIMES_EPOCH,   // Integers: days or microseconds since 1970-01-01,
+                           // microseconds since midnight
+    };
+
+    enum Numerics {
+        NUMERICS_DECIMAL, // decimal.Decimal, exactly
+        NUMERICS_INT,     // int where the scale is 0, otherwise Decimal
+        NUMERICS_FLOAT,   // float, correctly rounded
+    };
+
+    enum Byteas {
+        BYTEAS_BYTES, // Copies
+        BYTEAS_VIEW,  // Read-only memoryviews of the Result's own buffer
+    };
+
+    enum Texts {
+        TEXTS_NEW,    // A str per value
+        TEXTS_SHARED, // A str per distinct value of a column, while they repeat
+    };
+
+    enum Uuids {
+        UUIDS_OBJECTS, // uuid.UUID
+        UUIDS_BYTES,   // The 16 bytes, big-endian as uuid.UUID.bytes
+    };
+
+    enum Jsons {
+        JSONS_PARSED, // dicts, lists, strs, ints, floats, bools and None
+        JSONS_LAZY,   // Wrappers of the text, parsing it once accessed
+    };
+
+    Arrays    arrays;
+    Byteas    byteas;
+    Datetimes datetimes;
+    Jsons     jsons;
+    Numerics  numerics;
+    Texts     texts;
+    Uuids     uuids;
+
+    // Of types not decoded natively, NULL if none
+    registry::Registry *registry;
+};
+
+/* datetime C-API */
+
+namespace datetime {
+
+static const int64_t USECS_PER_SECOND = 1000000LL;
+static const int64_t USECS_PER_DAY    = 86400LL * USECS_PER_SECOND;
+
+/**
+ * Import the datetime C-API, once, before decoding any date or time.
+ */
+static inline bool
+import()
+{
+    if (PyDateTimeAPI == NULL)
+        PyDateTime_IMPORT;
+
+    return PyDateTimeAPI != NULL;
+}
+
+static inline int64_t
+floor_divide(int64_t a, int64_t b, int64_t *remainder)
+{
+    int64_t q = a / b;
+    int64_t r = a % b;
+
+    if (r < 0) {
+        q -= 1;
+        r += b;
+    }
+
+    *remainder = r;
+    return q;
+}
+
+/**
+ * Borrowed fixed-offset tzinfo, cached per offset (UTC being the common case).
+ */
+static inline PyObject *
+timezone(int32_t seconds_east)
+{
+    static PyObject *zones = NULL;
+
+    if (seconds_east == 0)
+        return PyDateTimeAPI->TimeZone_UTC;
+
+    if (zones == NULL && (zones = PyDict_New()) == NULL)
+        return NULL;
+
+    PyObject *key = PyLong_FromLong(seconds_east);
+    if (key == NULL)
+        return NULL;
+
+    PyObject *zone = PyDict_GetItemWithError(zones, key);
+
+    if (zone == NULL && !PyErr_Occurred()) {
+        PyObject *delta = PyDelta_FromDSU(0, seconds_east, 0);
+
+        if (delta != NULL) {
+            zone = PyTimeZone_FromOffset(delta);
+            Py_DECREF(delta);
+        }
+
+        if (zone != NULL) {
+            int error = PyDict_SetItem(zones, key, zone);
+            Py_DECREF(zone); // zones holds it
+            if (error == -1)
+                zone = NULL;
+        }
+    }
+
+    Py_DECREF(key);
+    return zone;
+}
+
+/**
+ * date of days since 1970-01-01.
+ */
+static inline PyObject *
+date(int64_t days)
+{
+    int64_t year;
+    int     month, day;
+
+    b::calendar::civil(days, &year, &month, &day);
+
+    if (year < 1 || year > 9999) {
+        PyErr_Format(PyExc_ValueError, "date out of range: year %lld", (long long)year);
+        return NULL;
+    }
+
+    return PyDate_FromDate((int)year, month, day);
+}
+
+/**
+ * datetime of microseconds since 1970-01-01, naive if tzinfo is None.
+ */
+static inline PyObject *
+datetime(int64_t microseconds, PyObject *tzinfo)
+{
+    int64_t usecs;
+    int64_t days = floor_divide(microseconds, USECS_PER_DAY, &usecs);
+    int64_t year;
+    int     month, day;
+
+    b::calendar::civil(days, &year, &month, &day);
+
+    if (year < 1 || year > 9999) {
+        PyErr_Format(PyExc_ValueError, "timestamp out of range: year %lld", (long long)year);
+        return NULL;
+    }
+
+    int64_t seconds = usecs / USECS_PER_SECOND;
+
+    return PyDateTimeAPI->DateTime_FromDateAndTime(
+        (int)year, month, day,
+        (int)(seconds / 3600), (int)(seconds / 60 % 60), (int)(seconds % 60),
+        (int)(usecs % USECS_PER_SECOND),
+        tzinfo, PyDateTimeAPI->DateTimeType);
+}
+
+/**
+ * time of microseconds since midnight, naive if tzinfo is None.
+ */
+static inline PyObject *
+time(int64_t microseconds, PyObject *tzinfo)
+{
+    // 24:00:00 is a valid PostgreSQL time, but not a Python one
+    if (microseconds < 0 || microseconds >= USECS_PER_DAY) {
+        PyErr_Format(PyExc_ValueError, "time out of range: %lld microseconds", (long long)microseconds);
+        return NULL;
+    }
+
+    int64_t seconds = microseconds / USECS_PER_SECOND;
+
+    return PyDateTimeAPI->Time_FromTime(
+        (int)(seconds / 3600), (int)(seconds / 60 % 60), (int)(seconds % 60),
+        (int)(microseconds % USECS_PER_SECOND),
+        tzinfo, PyDateTimeAPI->TimeType);
+}
+
+} // namespace datetime
+
+/**
+ * Borrowed module.name, imported once into *cache.
+ */
+static inline PyObject *
+imported(PyObject **cache, const char *module, const char *name)
+{
+    if (*cache == NULL) {
+        PyObject *m = PyImport_ImportModule(module);
+        if (m == NULL)
+            return NULL;
+
+        *cache = PyObject_GetAttrString(m, name);
+        Py_DECREF(m);
+    }
+
+    return *cache;
+}
+
+static inline PyObject *decode(Oid, const char *, int, const Options &);
+
 class BOOL
 {
   public:
     static const Oid OID = 16;
+    static const Oid OID_ARRAY = 1000;
 
     static inline PyObject *
-    decode(PGresult *r, int i, int j)
+    decode(const char *value, int length)
     {
-        if (*PQgetvalue(r, i, j))
+        if (*value)
             Py_RETURN_TRUE;
         else
             Py_RETURN_FALSE;
@@ -27,12 +257,13 @@ class BYTEA
 {
   public:
     static const Oid OID = 17;
+    static const Oid OID_ARRAY = 1001;
 
+    // A copy; see Options::BYTEAS_VIEW for none
     static inline PyObject *
-    decode(PGresult *r, int i, int j)
+    decode(const char *value, int length)
     {
-        TODO();
-        return NULL;
+        return PyBytes_FromStringAndSize(value, length);
     }
 };
 
@@ -40,9 +271,10 @@ class CHAR
 {
   public:
     static const Oid OID = 18;
+    static const Oid OID_ARRAY = 1002;
 
     static inline PyObject *
-    decode(PGresult *r, int i, int j)
+    decode(const char *value, int length)
     {
         TODO();
         return NULL;
@@ -53,12 +285,38 @@ class DATE
 {
   public:
     static const Oid OID = 1082;
+    static const Oid OID_ARRAY = 1182;
+
+    // 2000-01-01, in days since the Unix epoch
+    static const int32_t EPOCH = 10957;
 
+    /**
+     * Of days since 2000-01-01; infinities become date.min/max.
+     */
     static inline PyObject *
-    decode(PGresult *r, int i, int j)
+    from(int32_t days, const Options &options)
     {
-        TODO();
-        return NULL;
+        if (options.datetimes == Options::DATETIMES_EPOCH) {
+            if (days == INT32_MAX || days == INT32_MIN)
+                return PyLong_FromLong(days);
+            return PyLong_FromLongLong((int64_t)days + EPOCH);
+        }
+
+        if (days == INT32_MAX) return PyDate_FromDate(9999, 12, 31);
+        if (days == INT32_MIN) return PyDate_FromDate(1, 1, 1);
+
+        return datetime::date((int64_t)days + EPOCH);
+    }
+
+    static inline PyObject *
+    decode(const char *value, int length, const Options &options)
+    {
+        if (length != 4) {
+            PyErr_SetString(PyExc_ValueError, "malformed date");
+            return NULL;
+        }
+
+        return from(postgresql::network::load<int32_t>(value), options);
     }
 };
 
@@ -66,12 +324,12 @@ class FLOAT4
 {
   public:
     static const Oid OID = 700;
+    static const Oid OID_ARRAY = 1021;
 
     static inline PyObject *
-    decode(PGresult *r, int i, int j)
+    decode(const char *value, int length)
     {
-        TODO();
-        return NULL;
+        return PyFloat_FromDouble(postgresql::network::load<float>(value));
     }
 };
 
@@ -79,12 +337,96 @@ class FLOAT8
 {
   public:
     static const Oid OID = 701;
+    static const Oid OID_ARRAY = 1022;
 
     static inline PyObject *
-    decode(PGresult *r, int i, int j)
+    decode(const char *value, int length)
     {
-        TODO();
-        return NULL;
+        return PyFloat_FromDouble(postgresql::network::load<double>(value));
+    }
+};
+
+/**
+ * Network address types, as ipaddress objects:
+ *
+ *   uint8 family, uint8 bits (of the netmask), uint8 is_cidr,
+ *   uint8 length, address bytes (4 or 16)
+ */
+class INET
+{
+    // PostgreSQL's own, not the platform's AF_INET/AF_INET6
+    static const uint8_t FAMILY_INET  = 2;
+    static const uint8_t FAMILY_INET6 = 3;
+
+  public:
+    static const Oid OID = 869;
+    static const Oid OID_ARRAY = 1041;
+
+    /**
+     * Of an address with the full mask, an IPv4Address/IPv6Address; with a
+     * shorter one, an IPv4Interface/IPv6Interface, or IPv4Network/IPv6Network
+     * for cidr.
+     */
+    static inline PyObject *
+    decode(const char *value, int length)
+    {
+        static PyObject *classes[2][3] = {{NULL}};
+        static const char *NAMES[2][3] = {
+            {"IPv4Address", "IPv4Interface", "IPv4Network"},
+            {"IPv6Address", "IPv6Interface", "IPv6Network"},
+        };
+
+        if (length < 4) {
+            PyErr_SetString(PyExc_ValueError, "malformed inet");
+            return NULL;
+        }
+
+        uint8_t family = value[0];
+        int     bits   = (uint8_t)value[1];
+        bool    cidr   = value[2] != 0;
+        int     size   = (uint8_t)value[3];
+
+        int v = family == FAMILY_INET ? 0 : family == FAMILY_INET6 ? 1 : -1;
+
+        if (v == -1 || size != (v == 0 ? 4 : 16) || length != 4 + size || bits > size * 8) {
+            PyErr_SetString(PyExc_ValueError, "malformed inet");
+            return NULL;
+        }
+
+        int kind = cidr ? 2 : bits == size * 8 ? 0 : 1;
+
+        PyObject *cls = imported(&classes[v][kind], "ipaddress", NAMES[v][kind]);
+        if (cls == NULL)
+            return NULL;
+
+        // Integers, which the classes take without parsing
+        PyObject *address = v == 0 ? PyLong_FromUnsignedLong(postgresql::network::load<uint32_t>(value + 4))
+                                   : _PyLong_FromByteArray((const unsigned char *)value + 4, 16, 0, 0);
+        if (address == NULL)
+            return NULL;
+
+        PyObject *x;
+
+        if (kind == 0)
+            x = PyObject_CallFunctionObjArgs(cls, address, NULL);
+        else
+            x = PyObject_CallFunction(cls, "((Oi))", address, bits);
+
+        Py_DECREF(address);
+        return x;
+    }
+};
+
+class CIDR
+{
+  public:
+    static const Oid OID = 650;
+    static const Oid OID_ARRAY = 651;
+
+    static inline PyObject *
+    decode(const char *value, int length)
+    {
+        return INET::decode(value, length);
     }
 };
 
@@ -92,14 +434,14 @@ class INT2
 {
   public:
     static const Oid OID = 21;
+    static const Oid OID_ARRAY = 1005;
 
     static inline PyObject *
-    decode(PGresult *r, int i, int j)
+    decode(const char *value, int length)
     {
-        char   *bytes = PQgetvalue(r, i, j);
-        int16_t value = postgresql::network::order(*(int16_t *)bytes);
+        int16_t x = postgresql::network::order(*(int16_t *)value);
 
-        return PyLong_FromLong(value);
+        return PyLong_FromLong(x);
     }
 };
 
@@ -110,19 +452,11 @@ class INT4
     static const Oid OID_ARRAY = 1007;
 
     static inline PyObject *
-    decode(PGresult *r, int i, int j)
+    decode(const char *value, int length)
     {
-        char   *bytes = PQgetvalue(r, i, j);
-        int32_t value = postgresql::network::order(*(int32_t *)bytes);
+        int32_t x = postgresql::network::order(*(int32_t *)value);
 
-        return PyLong_FromLong(value);
-    }
-
-    static inline PyObject *
-    decode_array(PGresult *r, int i, int j)
-    {
-        TODO();
-        return NULL;
+        return PyLong_FromLong(x);
     }
 };
 
@@ -130,14 +464,14 @@ class INT8
 {
   public:
     static const Oid OID = 20;
+    static const Oid OID_ARRAY = 1016;
 
     static inline PyObject *
-    decode(PGresult *r, int i, int j)
+    decode(const char *value, int length)
     {
-        char   *bytes = PQgetvalue(r, i, j);
-        int64_t value = postgresql::network::order(*(int64_t *)bytes);
+        int64_t x = postgresql::network::order(*(int64_t *)value);
 
-        return PyLong_FromLongLong((int64_t)value);
+        return PyLong_FromLongLong((int64_t)x);
     }
 };
 
@@ -145,12 +479,501 @@ class INTERVAL
 {
   public:
     static const Oid OID = 1186;
+    static const Oid OID_ARRAY = 1187;
 
+    /**
+     * timedelta, counting a month as 30 days (as PostgreSQL does
+     * when it justifies intervals).
+     */
     static inline PyObject *
-    decode(PGresult *r, int i, int j)
+    decode(const char *value, int length)
     {
-        TODO();
-        return NULL;
+        if (length != 16) {
+            PyErr_SetString(PyExc_ValueError, "malformed interval");
+            return NULL;
+        }
+
+        int64_t microseconds = postgresql::network::load<int64_t>(value);
+        int32_t days         = postgresql::network::load<int32_t>(value + 8);
+        int32_t months       = postgresql::network::load<int32_t>(value + 12);
+
+        int64_t usecs;
+        int64_t seconds = datetime::floor_divide(microseconds, datetime::USECS_PER_SECOND, &usecs);
+        int64_t extra;
+        int64_t whole   = datetime::floor_divide(seconds, 86400, &extra);
+
+        int64_t total = (int64_t)days + (int64_t)months * 30 + whole;
+
+        if (total > 999999999 || total < -999999999) {
+            PyErr_SetString(PyExc_OverflowError, "interval out of timedelta range");
+            return NULL;
+        }
+
+        return PyDelta_FromDSU((int)total, (int)extra, (int)usecs);
+    }
+};
+
+class JSON
+{
+  public:
+    static const Oid OID = 114;
+    static const Oid OID_ARRAY = 199;
+
+    static inline PyObject *
+    decode(const char *value, int length)
+    {
+        return postgresql::json::parse(value, length);
+    }
+};
+
+class JSONB
+{
+  public:
+    static const Oid OID = 3802;
+    static const Oid OID_ARRAY = 3807;
+
+    static const char VERSION = 1;
+
+    /**
+     * The JSON text of value, past its format version.
+     * Returns false if not a known version.
+     */
+    static inline bool
+    text(const char **value, int *length)
+    {
+        if (*length < 1 || **value != VERSION)
+            return false;
+
+        *value  += 1;
+        *length -= 1;
+        return true;
+    }
+
+    static inline PyObject *
+    decode(const char *value, int length)
+    {
+        if (!text(&value, &length)) {
+            PyErr_SetString(PyExc_ValueError, "unsupported jsonb version");
+            return NULL;
+        }
+
+        return postgresql::json::parse(value, length);
+    }
+};
+
+/**
+ * MAC addresses, as their canonical text: a str of hex pairs.
+ */
+class MACADDR
+{
+  public:
+    static const Oid OID = 829;
+    static const Oid OID_ARRAY = 1040;
+
+    static inline PyObject *
+    format(const char *value, int length)
+    {
+        static const char HEX[] = "0123456789abcdef";
+
+        PyObject *x = PyUnicode_New(length * 3 - 1, 127);
+        if (x == NULL)
+            return NULL;
+
+        Py_UCS1 *p = PyUnicode_1BYTE_DATA(x);
+
+        for (int i = 0; i < length; i++) {
+            uint8_t c = value[i];
+
+            if (i != 0)
+                *p++ = ':';
+            *p++ = HEX[c >> 4];
+            *p++ = HEX[c & 0x0F];
+        }
+
+        return x;
+    }
+
+    static inline PyObject *
+    decode(const char *value, int length)
+    {
+        if (length != 6) {
+            PyErr_SetString(PyExc_ValueError, "malformed macaddr");
+            return NULL;
+        }
+
+        return format(value, length);
+    }
+};
+
+class MACADDR8
+{
+  public:
+    static const Oid OID = 774;
+    static const Oid OID_ARRAY = 775;
+
+    static inline PyObject *
+    decode(const char *value, int length)
+    {
+        if (length != 8) {
+            PyErr_SetString(PyExc_ValueError, "malformed macaddr8");
+            return NULL;
+        }
+
+        return MACADDR::format(value, length);
+    }
+};
+
+class NUMERIC
+{
+    // Of the sign word
+    static const uint16_t POSITIVE          = 0x0000;
+    static const uint16_t NEGATIVE          = 0x4000;
+    static const uint16_t NAN_              = 0xC000;
+    static const uint16_t POSITIVE_INFINITY = 0xD000;
+    static const uint16_t NEGATIVE_INFINITY = 0xF000;
+
+    static const int BASE        = 10000;
+    static const int BASE_DIGITS = 4;
+
+    /**
+     * Header of a binary numeric value:
+     *
+     *   int16 ndigits, int16 weight, uint16 sign, int16 dscale,
+     *   int16 digits[ndigits] (base 10000, the first weighted BASE^weight)
+     */
+    class Numeric
+    {
+      public:
+        int         ndigits;
+        int         weight;
+        uint16_t    sign;
+        int         dscale;
+        const char *digits;
+
+        inline int
+        digit(int g) const
+        {
+            return g >= 0 && g < this->ndigits ? postgresql::network::load<int16_t>(this->digits + 2 * g) : 0;
+        }
+    };
+
+    static inline bool
+    parse(const char *value, int length, Numeric *numeric)
+    {
+        if (length < 8)
+            return false;
+
+        numeric->ndigits = postgresql::network::load<int16_t> (value);
+        numeric->weight  = postgresql::network::load<int16_t> (value + 2);
+        numeric->sign    = postgresql::network::load<uint16_t>(value + 4);
+        numeric->dscale  = postgresql::network::load<int16_t> (value + 6);
+        numeric->digits  = value + 8;
+
+        if (numeric->ndigits < 0 || numeric->dscale < 0 || length < 8 + 2 * numeric->ndigits)
+            return false;
+
+        for (int g = 0; g < numeric->ndigits; g++) {
+            int d = numeric->digit(g);
+            if (d < 0 || d >= BASE)
+                return false;
+        }
+
+        return true;
+    }
+
+    // Longest text of numeric, its NUL included
+    static inline size_t
+    size(const Numeric &numeric)
+    {
+        size_t integer = numeric.weight >= 0 ? (size_t)(numeric.weight + 1) * BASE_DIGITS : 1;
+
+        return 1 + integer + 1 + numeric.dscale + 1;
+    }
+
+    /**
+     * Format a finite numeric as PostgreSQL does: [-]digits[.dscale digits].
+     * Returns the length written to text, of at least size(numeric) bytes.
+     */
+    static inline size_t
+    format(const Numeric &numeric, char *text)
+    {
+        static const int POWERS[BASE_DIGITS] = {1000, 100, 10, 1};
+
+        char *p = text;
+
+        if (numeric.sign == NEGATIVE)
+            *p++ = '-';
+
+        char *integer = p;
+
+        for (int g = 0; g <= numeric.weight; g++) {
+            int d = numeric.digit(g);
+
+            for (int i = 0; i < BASE_DIGITS; i++) {
+                int x = d / POWERS[i] % 10;
+
+                // Leading zeros
+                if (x != 0 || p != integer)
+                    *p++ = '0' + x;
+            }
+        }
+
+        if (p == integer)
+            *p++ = '0';
+
+        if (numeric.dscale > 0) {
+            *p++ = '.';
+
+            for (int f = 0; f < numeric.dscale; f++) {
+                int d = numeric.digit(numeric.weight + 1 + f / BASE_DIGITS);
+                *p++ = '0' + d / POWERS[f % BASE_DIGITS] % 10;
+            }
+        }
+
+        *p = '\0';
+        return p - text;
+    }
+
+    static inline PyObject *
+    decimal(const char *text, Py_ssize_t length)
+    {
+        static PyObject *cache = NULL;
+
+        PyObject *Decimal = imported(&cache, "decimal", "Decimal");
+        if (Decimal == NULL)
+            return NULL;
+
+        PyObject *string = PyUnicode_FromStringAndSize(text, length);
+        if (string == NULL)
+            return NULL;
+
+        PyObject *x = PyObject_CallFunctionObjArgs(Decimal, string, NULL);
+        Py_DECREF(string);
+        return x;
+    }
+
+    static inline PyObject *
+    special(const Numeric &numeric, const Options &options)
+    {
+        const char *text = numeric.sign == POSITIVE_INFINITY ? "Infinity"
+                         : numeric.sign == NEGATIVE_INFINITY ? "-Infinity"
+                         :                                     "NaN";
+
+        if (options.numerics == Options::NUMERICS_FLOAT)
+            return PyFloat_FromDouble(PyOS_string_to_double(text, NULL, NULL));
+
+        return decimal(text, strlen(text));
+    }
+
+    /**
+     * Digits as an integer m (if below 2^53) of value m * 10^exponent.
+     */
+    static inline bool
+    mantissa(const Numeric &numeric, int64_t *m, int *exponent)
+    {
+        if (numeric.ndigits > 4)
+            return false;
+
+        int64_t x = 0;
+
+        for (int g = 0; g < numeric.ndigits; g++)
+            x = x * BASE + numeric.digit(g);
+
+        if (x > (1LL << 53))
+            return false;
+
+        *m        = numeric.sign == NEGATIVE ? -x : x;
+        *exponent = (numeric.weight - numeric.ndigits + 1) * BASE_DIGITS;
+        return true;
+    }
+
+    static inline PyObject *
+    real(const Numeric &numeric, const char *text)
+    {
+        static const double POWERS[] = {
+            1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+        };
+
+        int64_t m;
+        int     exponent;
+
+        // Exact operands, so one (correctly) rounded operation
+        if (mantissa(numeric, &m, &exponent) && exponent >= -22 && exponent <= 22)
+            return PyFloat_FromDouble(exponent >= 0 ? (double)m * POWERS[exponent] : (double)m / POWERS[-exponent]);
+
+        double x = PyOS_string_to_double(text, NULL, NULL);
+        if (x == -1.0 && PyErr_Occurred())
+            return NULL;
+
+        return PyFloat_FromDouble(x);
+    }
+
+  public:
+    static const Oid OID = 1700;
+    static const Oid OID_ARRAY = 1231;
+
+    static inline PyObject *
+    decode(const char *value, int length, const Options &options)
+    {
+        Numeric numeric;
+
+        if (!parse(value, length, &numeric)) {
+            PyErr_SetString(PyExc_ValueError, "malformed numeric");
+            return NULL;
+        }
+
+        if (numeric.sign != POSITIVE && numeric.sign != NEGATIVE)
+            return special(numeric, options);
+
+        // Integers below 10^16 without text
+        if (options.numerics == Options::NUMERICS_INT && numeric.dscale == 0 && numeric.weight < 4) {
+            int64_t x = 0;
+
+            for (int g = 0; g <= numeric.weight; g++)
+                x = x * BASE + numeric.digit(g);
+
+            return PyLong_FromLongLong(numeric.sign == NEGATIVE ? -x : x);
+        }
+
+        char   buffer[128];
+        size_t size = NUMERIC::size(numeric);
+        char  *text = size <= sizeof(buffer) ? buffer : (char *)PyMem_Malloc(size);
+
+        if (text == NULL)
+            return PyErr_NoMemory();
+
+        size_t    n = format(numeric, text);
+        PyObject *x;
+
+        switch (options.numerics) {
+          case Options::NUMERICS_FLOAT:
+              x = real(numeric, text);
+              break;
+          case Options::NUMERICS_INT:
+              if (numeric.dscale == 0) {
+                  x = PyLong_FromString(text, NULL, 10);
+                  break;
+              }
+              // Fall through
+          default:
+              x = decimal(text, n);
+        }
+
+        if (text != buffer)
+            PyMem_Free(text);
+
+        return x;
+    }
+
+    /**
+     * The binary numeric of a decimal.Decimal, as bytes: its digits, from
+     * as_tuple(), grouped into base 10000 (without going through text).
+     */
+    static PyObject *
+    encode(PyObject *x)
+    {
+        static const int POWERS[BASE_DIGITS] = {1000, 100, 10, 1};
+
+        PyObject *tuple = PyObject_CallMethod(x, "as_tuple", NULL);
+        if (tuple == NULL)
+            return NULL;
+
+        // DecimalTuple(sign, digits, exponent)
+        long      negative = PyLong_AsLong(PyTuple_GET_ITEM(tuple, 0));
+        PyObject *digits   = PyTuple_GET_ITEM(tuple, 1);
+        PyObject *exponent = PyTuple_GET_ITEM(tuple, 2);
+
+        uint16_t sign   = negative ? NEGATIVE : POSITIVE;
+        int64_t  weight = 0;
+        int64_t  dscale = 0;
+        int      count  = 0;
+        int16_t *groups = NULL;
+
+        if (PyUnicode_Check(exponent)) {
+            // 'F' for infinities, 'n' and 'N' for NaNs
+            if (PyUnicode_READ_CHAR(exponent, 0) == 'F')
+                sign = negative ? NEGATIVE_INFINITY : POSITIVE_INFINITY;
+            else
+                sign = NAN_;
+        } else {
+            long       e = PyLong_AsLong(exponent);
+            Py_ssize_t n = PyTuple_GET_SIZE(digits);
+
+            if (e == -1 && PyErr_Occurred()) {
+                Py_DECREF(tuple);
+                return NULL;
+            }
+
+            // Digits before the point, then as many zeros in front as align it to a group
+            int64_t point   = (int64_t)n + e;
+            int     padding = (int)(((-point) % BASE_DIGITS + BASE_DIGITS) % BASE_DIGITS);
+
+            count  = (int)((padding + n + BASE_DIGITS - 1) / BASE_DIGITS);
+            weight = (point + padding) / BASE_DIGITS - 1;
+            dscale = e < 0 ? -(int64_t)e : 0;
+
+            if ((groups = (int16_t *)PyMem_Calloc(count > 0 ? count : 1, sizeof(int16_t))) == NULL) {
+                Py_DECREF(tuple);
+                return PyErr_NoMemory();
+            }
+
+            for (Py_ssize_t k = 0; k < n; k++) {
+                Py_ssize_t position = padding + k;
+                long       d        = PyLong_AsLong(PyTuple_GET_ITEM(digits, k));
+
+                groups[position / BASE_DIGITS] += (int16_t)(d * POWERS[position % BASE_DIGITS]);
+            }
+
+            int first = 0;
+
+            while (first < count && groups[first] == 0) {
+                first++;
+                weight--;
+            }
+
+            while (count > first && groups[count - 1] == 0)
+                count--;
+
+            count -= first;
+            memmove(groups, groups + first, count * sizeof(int16_t));
+
+            if (count == 0) {
+                weight = 0;
+                sign   = POSITIVE;
+            }
+        }
+
+        Py_DECREF(tuple);
+
+        if (weight < INT16_MIN || weight > INT16_MAX || dscale > 0x3FFF) {
+            PyMem_Free(groups);
+            PyErr_Format(PyExc_ValueError, "numeric out of range: %R", x);
+            return NULL;
+        }
+
+        PyObject *bytes = PyBytes_FromStringAndSize(NULL, 8 + 2 * count);
+
+        if (bytes != NULL) {
+            char *p = PyBytes_AS_STRING(bytes);
+
+            uint16_t header[4] = {
+                postgresql::network::order((uint16_t)count),
+                postgresql::network::order((uint16_t)weight),
+                postgresql::network::order(sign),
+                postgresql::network::order((uint16_t)dscale),
+            };
+
+            memcpy(p, header, sizeof(header));
+
+            for (int g = 0; g < count; g++) {
+                int16_t group = postgresql::network::order(groups[g]);
+                memcpy(p + 8 + 2 * g, &group, 2);
+            }
+        }
+
+        PyMem_Free(groups);
+        return bytes;
     }
 };
 
@@ -158,12 +981,52 @@ class RECORD
 {
   public:
     static const Oid OID = 2249;
+    static const Oid OID_ARRAY = 2287;
 
+    /**
+     * A tuple of the fields, each decoded by the type it comes with.
+     */
     static inline PyObject *
-    decode(PGresult *r, int i, int j)
+    decode(const char *value, int length, const Options &options)
     {
-        TODO();
-        return NULL;
+        composite::Composite composite;
+
+        if (!composite::parse(value, length, &composite)) {
+            PyErr_SetString(PyExc_ValueError, "malformed record");
+            return NULL;
+        }
+
+        PyObject *tuple = PyTuple_New(composite.count);
+        if (tuple == NULL)
+            return NULL;
+
+        const char *p = composite.fields;
+
+        for (int i = 0; i < composite.count; i++) {
+            Oid         oid;
+            const char *field;
+            int         n;
+            PyObject   *x;
+
+            if (!composite::next(composite, &p, &oid, &field, &n)) {
+                PyErr_SetString(PyExc_ValueError, "malformed record");
+                x = NULL;
+            } else if (n == -1) {
+                Py_INCREF(Py_None);
+                x = Py_None;
+            } else {
+                x = postgresql::decode(oid, field, n, options);
+            }
+
+            if (x == NULL) {
+                Py_DECREF(tuple);
+                return NULL;
+            }
+
+            PyTuple_SET_ITEM(tuple, i, x);
+        }
+
+        return tuple;
     }
 };
 
@@ -173,20 +1036,17 @@ class TEXT
     static const Oid OID = 25;
     static const Oid OID_ARRAY = 1009;
 
+    // Of value once scanned, for scanning apart (see b::utf8::scan)
     static inline PyObject *
-    decode(PGresult *r, int i, int j)
+    build(const char *value, int length, const b::utf8::Scan &scan)
     {
-        int   length = PQgetlength(r, i, j);
-        char *value  = PQgetvalue (r, i, j);
-
-        return PyUnicode_FromStringAndSize(value, length);
+        return b::unicode::from_utf8(value, length, scan);
     }
 
     static inline PyObject *
-    decode_array(PGresult *r, int i, int j)
+    decode(const char *value, int length)
     {
-        TODO();
-        return NULL;
+        return b::unicode::from_utf8(value, length);
     }
 };
 
@@ -194,12 +1054,29 @@ class TIME
 {
   public:
     static const Oid OID = 1083;
+    static const Oid OID_ARRAY = 1183;
 
+    /**
+     * Of microseconds since midnight.
+     */
     static inline PyObject *
-    decode(PGresult *r, int i, int j)
+    from(int64_t microseconds, const Options &options)
     {
-        TODO();
-        return NULL;
+        if (options.datetimes == Options::DATETIMES_EPOCH)
+            return PyLong_FromLongLong(microseconds);
+
+        return datetime::time(microseconds, Py_None);
+    }
+
+    static inline PyObject *
+    decode(const char *value, int length, const Options &options)
+    {
+        if (length != 8) {
+            PyErr_SetString(PyExc_ValueError, "malformed time");
+            return NULL;
+        }
+
+        return from(postgresql::network::load<int64_t>(value), options);
     }
 };
 
@@ -207,12 +1084,41 @@ class TIMESTAMP
 {
   public:
     static const Oid OID = 1114;
+    static const Oid OID_ARRAY = 1115;
+
+    // 2000-01-01, in microseconds since the Unix epoch
+    static const int64_t EPOCH = 946684800000000LL;
 
+    /**
+     * Of microseconds since 2000-01-01; infinities become datetime.min/max.
+     * Naive unless tzinfo isn't None.
+     */
     static inline PyObject *
-    decode(PGresult *r, int i, int j)
+    from(int64_t microseconds, PyObject *tzinfo, const Options &options)
     {
-        TODO();
-        return NULL;
+        if (options.datetimes == Options::DATETIMES_EPOCH) {
+            if (microseconds == INT64_MAX || microseconds == INT64_MIN)
+                return PyLong_FromLongLong(microseconds);
+            return PyLong_FromLongLong(microseconds + EPOCH);
+        }
+
+        if (microseconds == INT64_MAX)
+            return PyDateTimeAPI->DateTime_FromDateAndTime(9999, 12, 31, 23, 59, 59, 999999, tzinfo, PyDateTimeAPI->DateTimeType);
+        if (microseconds == INT64_MIN)
+            return PyDateTimeAPI->DateTime_FromDateAndTime(1, 1, 1, 0, 0, 0, 0, tzinfo, PyDateTimeAPI->DateTimeType);
+
+        return datetime::datetime(microseconds + EPOCH, tzinfo);
+    }
+
+    static inline PyObject *
+    decode(const char *value, int length, const Options &options)
+    {
+        if (length != 8) {
+            PyErr_SetString(PyExc_ValueError, "malformed timestamp");
+            return NULL;
+        }
+
+        return from(postgresql::network::load<int64_t>(value), Py_None, options);
     }
 };
 
@@ -220,12 +1126,18 @@ class TIMESTAMPTZ
 {
   public:
     static const Oid OID = 1184;
+    static const Oid OID_ARRAY = 1185;
 
+    // Sent in UTC, so decoded as such
     static inline PyObject *
-    decode(PGresult *r, int i, int j)
+    decode(const char *value, int length, const Options &options)
     {
-        TODO();
-        return NULL;
+        if (length != 8) {
+            PyErr_SetString(PyExc_ValueError, "malformed timestamptz");
+            return NULL;
+        }
+
+        return TIMESTAMP::from(postgresql::network::load<int64_t>(value), PyDateTimeAPI->TimeZone_UTC, options);
     }
 };
 
@@ -233,12 +1145,24 @@ class TIMETZ
 {
   public:
     static const Oid OID = 1266;
+    static const Oid OID_ARRAY = 1270;
 
     static inline PyObject *
-    decode(PGresult *r, int i, int j)
+    decode(const char *value, int length)
     {
-        TODO();
-        return NULL;
+        if (length != 12) {
+            PyErr_SetString(PyExc_ValueError, "malformed timetz");
+            return NULL;
+        }
+
+        int64_t microseconds = postgresql::network::load<int64_t>(value);
+        int32_t seconds_west = postgresql::network::load<int32_t>(value + 8);
+
+        PyObject *zone = datetime::timezone(-seconds_west);
+        if (zone == NULL)
+            return NULL;
+
+        return datetime::time(microseconds, zone);
     }
 };
 
@@ -246,41 +1170,405 @@ class UUID
 {
   public:
     static const Oid OID = 2950;
+    static const Oid OID_ARRAY = 2951;
 
+    /**
+     * A uuid.UUID, made as unpickling does - without its __init__ parsing:
+     * a bare instance with its int and is_safe slots set directly.
+     */
     static inline PyObject *
-    decode(PGresult *r, int i, int j)
+    decode(const char *value, int length, const Options &options)
     {
-        TODO();
-        return NULL;
+        static PyObject *classes[2] = {NULL, NULL}; // UUID, SafeUUID
+        static PyObject *unknown    = NULL;         // SafeUUID.unknown
+        static PyObject *empty      = NULL;
+        static PyObject *name_int   = NULL;
+        static PyObject *name_safe  = NULL;
+
+        if (length != 16) {
+            PyErr_SetString(PyExc_ValueError, "malformed uuid");
+            return NULL;
+        }
+
+        if (options.uuids == Options::UUIDS_BYTES)
+            return PyBytes_FromStringAndSize(value, 16);
+
+        PyTypeObject *cls = (PyTypeObject *)imported(&classes[0], "uuid", "UUID");
+        if (cls == NULL)
+            return NULL;
+
+        if (unknown == NULL) {
+            PyObject *SafeUUID = imported(&classes[1], "uuid", "SafeUUID");
+
+            if (SafeUUID == NULL || (unknown = PyObject_GetAttrString(SafeUUID, "unknown")) == NULL)
+                return NULL;
+        }
+
+        if (name_int == NULL && (name_int = PyUnicode_InternFromString("int")) == NULL)
+            return NULL;
+        if (name_safe == NULL && (name_safe = PyUnicode_InternFromString("is_safe")) == NULL)
+            return NULL;
+        if (empty == NULL && (empty = PyTuple_New(0)) == NULL)
+            return NULL;
+
+        PyObject *x = cls->tp_new(cls, empty, NULL);
+        if (x == NULL)
+            return NULL;
+
+        PyObject *integer = _PyLong_FromByteArray((const unsigned char *)value, 16, 0, 0);
+
+        // Past UUID.__setattr__, which forbids it
+        if (integer == NULL ||
+            PyObject_GenericSetAttr(x, name_int,  integer) == -1 ||
+            PyObject_GenericSetAttr(x, name_safe, unknown) == -1)
+            Py_CLEAR(x);
+
+        Py_XDECREF(integer);
+        return x;
+    }
+};
+
+/**
+ * Ranges of any element type, as postgresql.Range(lower, upper, bounds):
+ * a bound is None if infinite, and bounds one of '[)', '(]', '[]', '()'
+ * (or 'empty', with neither bound).
+ */
+class RANGE
+{
+    static PyObject *
+    bounds(uint8_t flags)
+    {
+        static const char *names[] = {"()", "[)", "(]", "[]", "empty"};
+        static PyObject   *cache[5] = {NULL, NULL, NULL, NULL, NULL};
+
+        int i = flags & range::EMPTY ? 4
+              : (flags & range::LOWER_INC ? 1 : 0) | (flags & range::UPPER_INC ? 2 : 0);
+
+        if (cache[i] == NULL)
+            cache[i] = PyUnicode_InternFromString(names[i]);
+
+        return cache[i];
+    }
+
+  public:
+    static PyTypeObject *
+    type()
+    {
+        static PyStructSequence_Field fields[] = {
+            {(char *)"lower",  (char *)"Lower bound, or None if infinite"},
+            {(char *)"upper",  (char *)"Upper bound, or None if infinite"},
+            {(char *)"bounds", (char *)"'[)', '(]', '[]' or '()' (whether each bound is included), or 'empty'"},
+            {NULL}
+        };
+
+        static PyStructSequence_Desc desc = {
+            (char *)"postgresql.Range",
+            (char *)"A range value, of any element type",
+            fields,
+            3,
+        };
+
+        static PyTypeObject type;
+        static bool         ready = false;
+
+        if (!ready) {
+            if (PyStructSequence_InitType2(&type, &desc) == -1)
+                return NULL;
+            ready = true;
+        }
+
+        return &type;
+    }
+
+    static inline PyObject *
+    decode(Oid element, const char *value, int length, const Options &options)
+    {
+        range::Range range;
+
+        if (!range::parse(value, length, &range)) {
+            PyErr_SetString(PyExc_ValueError, "malformed range");
+            return NULL;
+        }
+
+        PyTypeObject *type   = RANGE::type();
+        PyObject     *bounds = RANGE::bounds(range.flags);
+        if (type == NULL || bounds == NULL)
+            return NULL;
+
+        PyObject *x = PyStructSequence_New(type);
+        if (x == NULL)
+            return NULL;
+
+        const char *values [2] = {range.lower,        range.upper};
+        int         lengths[2] = {range.lower_length, range.upper_length};
+
+        for (int i = 0; i < 2; i++) {
+            PyObject *bound;
+
+            if (values[i] == NULL) {
+                Py_INCREF(Py_None);
+                bound = Py_None;
+            } else if ((bound = postgresql::decode(element, values[i], lengths[i], options)) == NULL) {
+                Py_DECREF(x);
+                return NULL;
+            }
+
+            PyStructSequence_SET_ITEM(x, i, bound);
+        }
+
+        Py_INCREF(bounds);
+        PyStructSequence_SET_ITEM(x, 2, bounds);
+
+        return x;
+    }
+};
+
+class DATERANGE
+{
+  public:
+    static const Oid OID = 3912;
+    static const Oid OID_ARRAY = 3913;
+};
+
+class INT4RANGE
+{
+  public:
+    static const Oid OID = 3904;
+    static const Oid OID_ARRAY = 3905;
+};
+
+class INT8RANGE
+{
+  public:
+    static const Oid OID = 3926;
+    static const Oid OID_ARRAY = 3927;
+};
+
+class NUMRANGE
+{
+  public:
+    static const Oid OID = 3906;
+    static const Oid OID_ARRAY = 3907;
+};
+
+class TSRANGE
+{
+  public:
+    static const Oid OID = 3908;
+    static const Oid OID_ARRAY = 3909;
+};
+
+class TSTZRANGE
+{
+  public:
+    static const Oid OID = 3910;
+    static const Oid OID_ARRAY = 3911;
+};
+
+/**
+ * Arrays of any element type, which their header gives.
+ */
+class ARRAY
+{
+    static PyObject *
+    list(const array::Array &array, int d, const char **p, const Options &options)
+    {
+        PyObject *list = PyList_New(array.dimensions[d]);
+        if (list == NULL)
+            return NULL;
+
+        for (int i = 0; i < array.dimensions[d]; i++) {
+            PyObject *x;
+
+            if (d + 1 < array.ndim) {
+                x = ARRAY::list(array, d + 1, p, options);
+            } else {
+                const char *value;
+                int         length;
+
+                if (!array::next(array, p, &value, &length)) {
+                    PyErr_SetString(PyExc_ValueError, "malformed array");
+                    x = NULL;
+                } else if (length == -1) {
+                    Py_INCREF(Py_None);
+                    x = Py_None;
+                } else {
+                    x = postgresql::decode(array.element, value, length, options);
+                }
+            }
+
+            if (x == NULL) {
+                Py_DECREF(list);
+                return NULL;
+            }
+
+            PyList_SET_ITEM(list, i, x);
+        }
+
+        return list;
+    }
+
+    /**
+     * All elements, in native order, as a memoryview of the array's shape.
+     */
+    template <typename TYPE>
+    static PyObject *
+    buffer(const array::Array &array, const char *format)
+    {
+        PyObject *bytes = PyBytes_FromStringAndSize(NULL, array.count * sizeof(TYPE));
+        if (bytes == NULL)
+            return NULL;
+
+        if (!array::copy<TYPE>(array, (TYPE *)PyBytes_AS_STRING(bytes))) {
+            Py_DECREF(bytes);
+            PyErr_SetString(PyExc_ValueError, "malformed array");
+            return NULL;
+        }
+
+        PyObject *view = PyMemoryView_FromObject(bytes);
+        Py_DECREF(bytes);
+        if (view == NULL)
+            return NULL;
+
+        PyObject *cast;
+
+        // Shapes can not have zeros, and one dimension is the default
+        if (array.ndim <= 1) {
+            cast = PyObject_CallMethod(view, "cast", "s", format);
+        } else {
+            PyObject *shape = PyTuple_New(array.ndim);
+
+            for (int d = 0; shape != NULL && d < array.ndim; d++) {
+                PyObject *n = PyLong_FromLong(array.dimensions[d]);
+                if (n == NULL)
+                    Py_CLEAR(shape);
+                else
+                    PyTuple_SET_ITEM(shape, d, n);
+            }
+
+            cast = shape == NULL ? NULL : PyObject_CallMethod(view, "cast", "sN", format, shape);
+        }
+
+        Py_DECREF(view);
+        return cast;
+    }
+
+  public:
+    static inline PyObject *
+    decode(const char *value, int length, const Options &options)
+    {
+        array::Array array;
+
+        if (!array::parse(value, length, &array)) {
+            PyErr_SetString(PyExc_ValueError, "malformed array");
+            return NULL;
+        }
+
+        if (options.arrays == Options::ARRAYS_BUFFER && !array.has_null) {
+            switch (array.element) {
+              case BOOL  ::OID: return buffer<int8_t> (array, "?");
+              case FLOAT4::OID: return buffer<float>  (array, "f");
+              case FLOAT8::OID: return buffer<double> (array, "d");
+              case INT2  ::OID: return buffer<int16_t>(array, "h");
+              case INT4  ::OID: return buffer<int32_t>(array, "i");
+              case INT8  ::OID: return buffer<int64_t>(array, "q");
+            }
+        }
+
+        if (array.ndim == 0)
+            return PyList_New(0);
+
+        const char *p = array.elements;
+        return list(array, 0, &p, options);
     }
 };
 
 static inline PyObject *
-decode(PGresult *r, int i, int j)
-{
-    switch (PQftype(r, j)) {
-      case BOOL       ::OID      : return BOOL       ::decode      (r, i, j);
-      case BYTEA      ::OID      : return BYTEA      ::decode      (r, i, j);
-      case CHAR       ::OID      : return CHAR       ::decode      (r, i, j);
-      case DATE       ::OID      : return DATE       ::decode      (r, i, j);
-      case FLOAT4     ::OID      : return FLOAT4     ::decode      (r, i, j);
-      case FLOAT8     ::OID      : return FLOAT8     ::decode      (r, i, j);
-      case INT2       ::OID      : return INT2       ::decode      (r, i, j);
-      case INT4       ::OID      : return INT4       ::decode      (r, i, j);
-      case INT4       ::OID_ARRAY: return INT4       ::decode_array(r, i, j);
-      case INT8       ::OID      : return INT8       ::decode      (r, i, j);
-      case INTERVAL   ::OID      : return INTERVAL   ::decode      (r, i, j);
-      case RECORD     ::OID      : return RECORD     ::decode      (r, i, j);
-      case TEXT       ::OID      : return TEXT       ::decode      (r, i, j);
-      case TEXT       ::OID_ARRAY: return TEXT       ::decode_array(r, i, j);
-      case TIME       ::OID      : return TIME       ::decode      (r, i, j);
-      case TIMESTAMP  ::OID      : return TIMESTAMP  ::decode      (r, i, j);
-      case TIMESTAMPTZ::OID      : return TIMESTAMPTZ::decode      (r, i, j);
-      case TIMETZ     ::OID      : return TIMETZ     ::decode      (r, i, j);
-      case UUID       ::OID      : return UUID       ::decode      (r, i, j);
-    }
-
-    PyErr_Format(PyExc_NotImplementedError, "%zd", PQftype(r, j));
+decode(Oid oid, const char *value, int length, const Options &options)
+{
+    switch (oid) {
+      case BOOL       ::OID: return BOOL       ::decode(value, length);
+      case BYTEA      ::OID: return BYTEA      ::decode(value, length);
+      case CHAR       ::OID: return CHAR       ::decode(value, length);
+      case CIDR       ::OID: return CIDR       ::decode(value, length);
+      case DATE       ::OID: return DATE       ::decode(value, length, options);
+      case FLOAT4     ::OID: return FLOAT4     ::decode(value, length);
+      case FLOAT8     ::OID: return FLOAT8     ::decode(value, length);
+      case INET       ::OID: return INET       ::decode(value, length);
+      case INT2       ::OID: return INT2       ::decode(value, length);
+      case INT4       ::OID: return INT4       ::decode(value, length);
+      case INT8       ::OID: return INT8       ::decode(value, length);
+      case INTERVAL   ::OID: return INTERVAL   ::decode(value, length);
+      case JSON       ::OID: return JSON       ::decode(value, length);
+      case JSONB      ::OID: return JSONB      ::decode(value, length);
+      case MACADDR    ::OID: return MACADDR    ::decode(value, length);
+      case MACADDR8   ::OID: return MACADDR8   ::decode(value, length);
+      case NUMERIC    ::OID: return NUMERIC    ::decode(value, length, options);
+      case RECORD     ::OID: return RECORD     ::decode(value, length, options);
+      case TEXT       ::OID: return TEXT       ::decode(value, length);
+      case TIME       ::OID: return TIME       ::decode(value, length, options);
+      case TIMESTAMP  ::OID: return TIMESTAMP  ::decode(value, length, options);
+      case TIMESTAMPTZ::OID: return TIMESTAMPTZ::decode(value, length, options);
+      case TIMETZ     ::OID: return TIMETZ     ::decode(value, length);
+      case UUID       ::OID: return UUID       ::decode(value, length, options);
+
+      case DATERANGE  ::OID: return RANGE::decode(DATE       ::OID, value, length, options);
+      case INT4RANGE  ::OID: return RANGE::decode(INT4       ::OID, value, length, options);
+      case INT8RANGE  ::OID: return RANGE::decode(INT8       ::OID, value, length, options);
+      case NUMRANGE   ::OID: return RANGE::decode(NUMERIC    ::OID, value, length, options);
+      case TSRANGE    ::OID: return RANGE::decode(TIMESTAMP  ::OID, value, length, options);
+      case TSTZRANGE  ::OID: return RANGE::decode(TIMESTAMPTZ::OID, value, length, options);
+
+      case BOOL       ::OID_ARRAY:
+      case BYTEA      ::OID_ARRAY:
+      case CHAR       ::OID_ARRAY:
+      case CIDR       ::OID_ARRAY:
+      case DATE       ::OID_ARRAY:
+      case DATERANGE  ::OID_ARRAY:
+      case FLOAT4     ::OID_ARRAY:
+      case FLOAT8     ::OID_ARRAY:
+      case INET       ::OID_ARRAY:
+      case INT2       ::OID_ARRAY:
+      case INT4       ::OID_ARRAY:
+      case INT4RANGE  ::OID_ARRAY:
+      case INT8       ::OID_ARRAY:
+      case INT8RANGE  ::OID_ARRAY:
+      case INTERVAL   ::OID_ARRAY:
+      case JSON       ::OID_ARRAY:
+      case JSONB      ::OID_ARRAY:
+      case MACADDR    ::OID_ARRAY:
+      case MACADDR8   ::OID_ARRAY:
+      case NUMERIC    ::OID_ARRAY:
+      case NUMRANGE   ::OID_ARRAY:
+      case RECORD     ::OID_ARRAY:
+      case TEXT       ::OID_ARRAY:
+      case TIME       ::OID_ARRAY:
+      case TIMESTAMP  ::OID_ARRAY:
+      case TIMESTAMPTZ::OID_ARRAY:
+      case TSRANGE    ::OID_ARRAY:
+      case TSTZRANGE  ::OID_ARRAY:
+      case TIMETZ     ::OID_ARRAY:
+      case UUID       ::OID_ARRAY: return ARRAY::decode(value, length, options);
+    }
+
+    registry::Decoder *decoder = options.registry != NULL ? options.registry->decoder(oid) : NULL;
+
+    if (decoder != NULL) {
+        switch (decoder->kind) {
+          case registry::Decoder::NATIVE: {
+              // Natively only, so that decoders can not chain into loops
+              Options native = options;
+              native.registry = NULL;
+              return decode(decoder->as, value, length, native);
+          }
+          case registry::Decoder::FUNCTION: return registry::call(decoder->function, value, length);
+          case registry::Decoder::ARRAY:    return ARRAY ::decode(value, length, options);
+          case registry::Decoder::RECORD:   return RECORD::decode(value, length, options);
+          case registry::Decoder::RANGE:    return RANGE ::decode(decoder->as, value, length, options);
+        }
+    }
+
+    PyErr_Format(PyExc_NotImplementedError, "%u", oid);
     return NULL;
 }
 
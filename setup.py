@@ -11,10 +11,32 @@ setup(
             name = 'postgresql',
             depends = [
                 'include/postgresql/Parameters.hpp',
+                'include/postgresql/aggregate.hpp',
+                'include/postgresql/array.hpp',
+                'include/postgresql/arrow.hpp',
+                'include/postgresql/cache.hpp',
+                'include/postgresql/catalog.hpp',
+                'include/postgresql/columns.hpp',
+                'include/postgresql/composite.hpp',
+                'include/postgresql/copy.hpp',
+                'include/postgresql/csv.hpp',
+                'include/postgresql/dictionary.hpp',
+                'include/postgresql/index.hpp',
+                'include/postgresql/json.hpp',
+                'include/postgresql/range.hpp',
+                'include/postgresql/records.hpp',
+                'include/postgresql/registry.hpp',
+                'include/postgresql/rows.hpp',
+                'include/postgresql/snapshot.hpp',
+                'include/postgresql/store.hpp',
                 'include/postgresql/type.hpp',
             ],
             extra_compile_args = [
                 '-std=c++0x',
+                '-pthread',
+            ],
+            extra_link_args = [
+                '-pthread',
             ],
             include_dirs = [
                 '/usr/include/postgresql',
@@ -23,6 +45,7 @@ setup(
             language = 'c++',
             libraries = [
                 'pq',
+                'rt',
             ],
             sources = [
                 'src/postgresql.cpp',
@@ -1,15 +1,40 @@
 #include "Python.h"
 #include "libpq-fe.h"
 
+#include <fcntl.h>
+#include <new>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <utility>
+#include <vector>
+
 #include "b/Identifier.hpp"
 #include "b/python.h"
 #include "b/type.hpp"
+#include "postgresql/aggregate.hpp"
+#include "postgresql/arrow.hpp"
+#include "postgresql/cache.hpp"
+#include "postgresql/catalog.hpp"
+#include "postgresql/columns.hpp"
+#include "postgresql/copy.hpp"
+#include "postgresql/csv.hpp"
+#include "postgresql/dictionary.hpp"
+#include "postgresql/index.hpp"
 #include "postgresql/parameters.hpp"
+#include "postgresql/records.hpp"
+#include "postgresql/rows.hpp"
+#include "postgresql/snapshot.hpp"
+#include "postgresql/store.hpp"
 #include "postgresql/type.hpp"
 
 typedef struct {
     PyObject_HEAD
     PGconn *pg_conn;
+    Py_ssize_t memory_budget; // Per Result, past which rows spill to disk; 0 if none
+    postgresql::cache::Cache *cache; // Of Results, NULL unless enabled
+    postgresql::registry::Registry *registry; // Of other types, NULL until one is registered
+    postgresql::catalog::Catalog *catalog; // Of schemas, NULL until one is loaded
     // Properties, cached upon first access
     PyObject *host;
     PyUnicodeObject *name;
@@ -26,11 +51,22 @@ typedef struct {
     PGresult *pg_result;
 } ExecutionError;
 
-typedef struct {
+typedef struct Result {
     PyObject_HEAD
     PGresult *pg_result;
     int       row_count;    // Cached from PQntuples
     int       column_count; // Cached from PQnfields
+    // Views share the PGresult of their base, remapping indexes
+    struct Result *base;    // NULL unless a view
+    int       row_start;
+    int       row_step;
+    int      *columns;      // Projection onto pg_result columns, NULL if none
+    // Rows kept outside a PGresult (pg_result is NULL), e.g. spilled to disk
+    postgresql::store::Store *store;
+    PyObject *owner;        // Of the store's memory, if a Python object
+    postgresql::Options options; // How to decode values
+    // Per pg_result column, once decoding with texts='shared'
+    postgresql::dictionary::Dictionary *dictionaries;
 } Result;
 
 typedef struct {
@@ -51,9 +87,45 @@ typedef struct {
     int  index;
 } RowIterator;
 
+typedef struct {
+    PyObject_HEAD
+    Result                   *result;
+    postgresql::index::Index *index;
+    PyObject                 *on;      // Key column references, as given
+    int                      *columns; // Key columns of pg_result
+    Oid                      *oids;    // ... and their types
+} Index;
+
+typedef struct {
+    PyObject_HEAD
+    char       *data;
+    uint8_t    *nulls;
+    char       *format;
+    PyObject   *names;
+    Py_ssize_t  count;
+    Py_ssize_t  itemsize;
+    int         width;
+} Records;
+
+typedef struct {
+    PyObject_HEAD
+    PyObject   *owner; // Of data, kept alive while viewed
+    const char *data;
+    Py_ssize_t  length;
+} Blob;
+
+typedef struct {
+    PyObject_HEAD
+    PyObject   *owner; // Of data, kept alive while referenced
+    const char *data;  // JSON text
+    Py_ssize_t  length;
+    PyObject   *value; // Parsed, once accessed
+} Json;
+
 typedef struct {
     PyObject_HEAD
     Database *database;
+    PyObject *name;
 } Schema;
 
 typedef struct {
@@ -63,7 +135,17 @@ typedef struct {
 
 /* Forward */
 
+static Result *Database___call__(Database *, PyObject *, PyObject *);
+static const postgresql::catalog::Schema *Database_catalog_schema(Database *, PyObject *);
+
 static inline Row *Result_row(Result *, int);
+static inline postgresql::Rows Result_rows(Result *);
+static inline int Result_column_at(Result *, int);
+static inline Oid Result_oid(Result *, int);
+static inline const char *Result_name(Result *, int);
+static inline PyObject *Result_decode(Result *, int, int);
+static int Result_column_index(Result *, PyObject *);
+static inline bool Result_check(PyObject *);
 static inline bool Row_check(PyObject *);
 
 /* ConnectionError */
@@ -341,7 +423,14 @@ Row___len__(Row *self)
 static PyObject *
 Row___getitem__(Row *self, Py_ssize_t index)
 {
-    return postgresql::decode(self->result->pg_result, self->index, index);
+    Result *result = self->result;
+
+    if (index < 0 || index >= result->column_count) {
+        PyErr_SetString(PyExc_IndexError, "Row index out of range");
+        return NULL;
+    }
+
+    return Result_decode(result, self->index, Result_column_at(result, index));
 }
 
 static PyObject *
@@ -562,98 +651,333 @@ ResultIterator_type = {
     /* tp_free            */ 0,
 };
 
-/* Result */
+/* Index */
 
 PyDoc_STRVAR(
-Result___doc__,
-"Object representing a PostgreSQL command result.");
+Index___doc__,
+"Hash index over the key column(s) of a Result, mapping keys to Rows.\n\n"
+"Keys are hashed and compared as raw cell bytes (integers by value, whatever\n"
+"their width), so neither building nor joining decodes them.  Rows with a\n"
+"NULL key are not indexed.");
 
 static void
-Result___del__(Result *self)
+Index___del__(Index *self)
 {
-    PQclear(self->pg_result);
+    delete self->index;
+    PyMem_FREE(self->columns);
+    Py_XDECREF(self->on);
+    Py_XDECREF(self->result);
     return Py_TYPE(self)->tp_free((PyObject *)self);
 }
 
-static inline Row *
-Result_row(Result *self, int i)
+/**
+ * Resolve one column reference or a sequence of them to pg_result columns.
+ * Returns a PyMem allocated array, or NULL with an exception set.
+ */
+static int *
+Index_columns(Result *result, PyObject *references, int *width)
 {
-    assert(i < self->row_count);
+    bool single = PyUnicode_Check(references) || PyIndex_Check(references);
 
-    if (!b::type::ensure_ready(&Row_type))
+    PyObject *sequence = single
+        ? PyTuple_Pack(1, references)
+        : PySequence_Fast(references, "expecting a column or a sequence of columns");
+    if (sequence == NULL)
         return NULL;
 
-    Row *row = (Row *)Row_type.tp_alloc(&Row_type, 0);
-    if (row == NULL)
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(sequence);
+    if (n == 0) {
+        PyErr_SetString(PyExc_ValueError, "expecting at least one key column");
+        Py_DECREF(sequence);
         return NULL;
+    }
 
-    Py_INCREF(self);
+    int *columns = (int *)PyMem_MALLOC(n * (sizeof(int) + sizeof(Oid)));
+    if (columns == NULL) {
+        PyErr_NoMemory();
+        Py_DECREF(sequence);
+        return NULL;
+    }
 
-    row->index  = i;
-    row->result = self;
+    Oid *oids = (Oid *)(columns + n);
 
-    return row;
+    for (Py_ssize_t c = 0; c < n; c++) {
+        int j = Result_column_index(result, PySequence_Fast_GET_ITEM(sequence, c));
+        if (j == -1) {
+            PyMem_FREE(columns);
+            Py_DECREF(sequence);
+            return NULL;
+        }
+
+        columns[c] = Result_column_at(result, j);
+        oids   [c] = Result_oid(result, columns[c]);
+    }
+
+    Py_DECREF(sequence);
+
+    *width = (int)n;
+    return columns;
+}
+
+/**
+ * Find the entry for a Python key, encoding it as a parameter would be.
+ * Returns NULL with no exception set if the key is absent.
+ */
+static const postgresql::index::Entry *
+Index_find(Index *self, PyObject *key)
+{
+    int width = self->index->keys.width;
+
+    if (width == 1) {
+        postgresql::parameters::Static<1> p;
+
+        if (!p.append(key))
+            return NULL;
+
+        postgresql::index::Probe probe = {1, p.types, p.values, p.lengths};
+        return self->index->find(probe, 0);
+    }
+
+    if (!PyTuple_Check(key) || PyTuple_GET_SIZE(key) != width) {
+        PyErr_Format(PyExc_TypeError, "expecting a tuple of %d keys, got: %R", width, key);
+        return NULL;
+    }
+
+    postgresql::parameters::Dynamic p(width);
+
+    if (p.types == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    for (int c = 0; c < width; c++) {
+        if (!p.append(PyTuple_GET_ITEM(key, c)))
+            return NULL;
+    }
+
+    postgresql::index::Probe probe = {width, p.types, p.values, p.lengths};
+    return self->index->find(probe, 0);
 }
 
+/* Index_as_mapping */
+
 static Py_ssize_t
-Result___len__(Result *self)
+Index___len__(Index *self)
 {
-    return self->row_count;
+    return self->index->table.size();
 }
 
 static Row *
-Result___getitem__(Result *self, Py_ssize_t i)
+Index___getitem__(Index *self, PyObject *key)
 {
-    if (i >= self->row_count)
+    const postgresql::index::Entry *entry = Index_find(self, key);
+
+    if (entry == NULL) {
+        if (!PyErr_Occurred())
+            PyErr_SetObject(PyExc_KeyError, key);
         return NULL;
-    return Result_row(self, i);
+    }
+
+    return Result_row(self->result, entry->first);
 }
 
-static ResultIterator *
-Result___iter__(Result *self)
+static int
+Index___contains__(Index *self, PyObject *key)
 {
-    if (!b::type::ensure_ready(&ResultIterator_type))
+    if (Index_find(self, key) != NULL)
+        return 1;
+    return PyErr_Occurred() ? -1 : 0;
+}
+
+/* Methods */
+
+PyDoc_STRVAR(
+Index_get___doc__,
+"get(key, default=None) -> the first Row with key, or default");
+
+static PyObject *
+Index_get(Index *self, PyObject *args)
+{
+    PyObject *key;
+    PyObject *fallback = Py_None;
+
+    if (!PyArg_UnpackTuple(args, "get", 1, 2, &key, &fallback))
         return NULL;
 
-    ResultIterator *iterator = (ResultIterator *)ResultIterator_type.tp_alloc(&ResultIterator_type, 0);
-    if (iterator == NULL)
+    const postgresql::index::Entry *entry = Index_find(self, key);
+
+    if (entry == NULL) {
+        if (PyErr_Occurred())
+            return NULL;
+        Py_INCREF(fallback);
+        return fallback;
+    }
+
+    return (PyObject *)Result_row(self->result, entry->first);
+}
+
+PyDoc_STRVAR(
+Index_rows___doc__,
+"rows(key) -> list of all Rows with key, in Result order");
+
+static PyObject *
+Index_rows(Index *self, PyObject *key)
+{
+    const postgresql::index::Entry *entry = Index_find(self, key);
+
+    if (entry == NULL && PyErr_Occurred())
         return NULL;
 
-    Py_INCREF(self);
+    PyObject *rows = PyList_New(0);
+    if (rows == NULL)
+        return NULL;
 
-    iterator->result = self;
-    iterator->index  = 0;
+    for (int k = entry == NULL ? -1 : entry->first; k != -1; k = self->index->next[k]) {
+        Row *row = Result_row(self->result, k);
+        if (row == NULL || PyList_Append(rows, (PyObject *)row) == -1) {
+            Py_XDECREF(row);
+            Py_DECREF(rows);
+            return NULL;
+        }
+        Py_DECREF(row);
+    }
 
-    return iterator;
+    return rows;
+}
+
+PyDoc_STRVAR(
+Index_join___doc__,
+"join(other, on=None) -> list of (Row, Row)\n\n"
+"Inner join: probe this index with the key column(s) 'on' (by default, the\n"
+"indexed columns) of each row of other Result, pairing matching rows.");
+
+static PyObject *
+Index_join(Index *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *keywords[] = {"other", "on", NULL};
+
+    Result   *other;
+    PyObject *on = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O:join", (char **)keywords, &other, &on))
+        return NULL;
+
+    if (!Result_check((PyObject *)other)) {
+        PyErr_Format(PyExc_TypeError, "expecting a Result, got: %R", other);
+        return NULL;
+    }
+
+    if (on == NULL || on == Py_None)
+        on = self->on;
+
+    int width;
+    int *columns = Index_columns(other, on, &width);
+    if (columns == NULL)
+        return NULL;
+
+    if (width != self->index->keys.width) {
+        PyErr_Format(PyExc_ValueError, "expecting %d key columns, got: %R", self->index->keys.width, on);
+        PyMem_FREE(columns);
+        return NULL;
+    }
+
+    postgresql::index::Columns probe = {Result_rows(other), width, columns, (Oid *)(columns + width)};
+
+    std::vector<std::pair<int, int> > pairs;
+    bool ok = true;
+    {
+        b::gil::Release release(other->row_count >= postgresql::aggregate::RELEASE_GIL_ROWS);
+
+        try {
+            for (int k = 0; k < probe.rows.count; k++) {
+                if (probe.isnull(k))
+                    continue;
+
+                const postgresql::index::Entry *entry = self->index->find(probe, k);
+                if (entry == NULL)
+                    continue;
+
+                for (int i = entry->first; i != -1; i = self->index->next[i])
+                    pairs.push_back(std::make_pair(i, k));
+            }
+        } catch (std::bad_alloc &) {
+            ok = false;
+        }
+    }
+
+    PyMem_FREE(columns);
+
+    if (!ok)
+        return PyErr_NoMemory();
+
+    PyObject *joined = PyList_New(pairs.size());
+    if (joined == NULL)
+        return NULL;
+
+    for (size_t n = 0; n < pairs.size(); n++) {
+        Row *left  = Result_row(self->result, pairs[n].first);
+        Row *right = Result_row(other,        pairs[n].second);
+
+        PyObject *pair = (left == NULL || right == NULL) ? NULL : PyTuple_Pack(2, left, right);
+
+        Py_XDECREF(left);
+        Py_XDECREF(right);
+
+        if (pair == NULL) {
+            Py_DECREF(joined);
+            return NULL;
+        }
+
+        PyList_SET_ITEM(joined, n, pair);
+    }
+
+    return joined;
 }
 
+static PyMethodDef
+Index_methods[] = {
+    {"get",  (PyCFunction)Index_get,  METH_VARARGS,                 Index_get___doc__},
+    {"join", (PyCFunction)Index_join, METH_VARARGS | METH_KEYWORDS, Index_join___doc__},
+    {"rows", (PyCFunction)Index_rows, METH_O,                       Index_rows___doc__},
+    {NULL}
+};
+
 static PySequenceMethods
-Result_as_sequence = {
-    /* sq_length         */ (lenfunc)Result___len__,
+Index_as_sequence = {
+    /* sq_length         */ 0,
     /* sq_concat         */ 0,
     /* sq_repeat         */ 0,
-    /* sq_item           */ (ssizeargfunc)Result___getitem__,
+    /* sq_item           */ 0,
+    /* was_sq_slice      */ 0,
     /* sq_ass_item       */ 0,
-    /* sq_contains       */ 0,
+    /* was_sq_ass_slice  */ 0,
+    /* sq_contains       */ (objobjproc)Index___contains__,
     /* sq_inplace_concat */ 0,
     /* sq_inplace_repeat */ 0,
 };
 
+static PyMappingMethods
+Index_as_mapping = {
+    /* mp_length        */ (lenfunc)Index___len__,
+    /* mp_subscript     */ (binaryfunc)Index___getitem__,
+    /* mp_ass_subscript */ 0,
+};
+
 static PyTypeObject
-Result_type = {
+Index_type = {
     PyVarObject_HEAD_INIT(NULL, 0)
-    /* tp_name            */ "postgresql.Result",
-    /* tp_basicsize       */ sizeof(Result),
+    /* tp_name            */ "postgresql.Index",
+    /* tp_basicsize       */ sizeof(Index),
     /* tp_itemsize        */ 0,
-    /* tp_dealloc         */ (destructor)Result___del__,
+    /* tp_dealloc         */ (destructor)Index___del__,
     /* tp_print           */ 0,
     /* tp_getattr         */ 0,
     /* tp_setattr         */ 0,
     /* tp_reserved        */ 0,
     /* tp_repr            */ 0,
     /* tp_as_number       */ 0,
-    /* tp_as_sequence     */ &Result_as_sequence,
-    /* tp_as_mapping      */ 0,
+    /* tp_as_sequence     */ &Index_as_sequence,
+    /* tp_as_mapping      */ &Index_as_mapping,
     /* tp_hash            */ 0,
     /* tp_call            */ 0,
     /* tp_str             */ 0,
@@ -661,14 +985,14 @@ Result_type = {
     /* tp_setattro        */ 0,
     /* tp_as_buffer       */ 0,
     /* tp_flags           */ Py_TPFLAGS_DEFAULT,
-    /* tp_doc             */ Result___doc__,
+    /* tp_doc             */ Index___doc__,
     /* tp_traverse        */ 0,
     /* tp_clear           */ 0,
     /* tp_richcompare     */ 0,
     /* tp_weaklist_offset */ 0,
-    /* tp_iter            */ (getiterfunc)Result___iter__,
+    /* tp_iter            */ 0,
     /* tp_iternext        */ 0,
-    /* tp_methods         */ 0,
+    /* tp_methods         */ Index_methods,
     /* tp_members         */ 0,
     /* tp_getset          */ 0,
     /* tp_base            */ 0,
@@ -682,123 +1006,205 @@ Result_type = {
     /* tp_free            */ 0,
 };
 
-static inline Result *
-Result_new(PGresult *pg_result)
+static Index *
+Index_new(Result *result, PyObject *on)
 {
-    ExecStatusType status = PQresultStatus(pg_result);
+    Index *self = (Index *)Index_type.tp_alloc(&Index_type, 0);
+    if (self == NULL)
+        return NULL;
 
-    // Fast path the common cases outside of a switch
+    Py_INCREF(result);
+    Py_INCREF(on);
 
-    if (status != PGRES_TUPLES_OK) {
-        if (status == PGRES_COMMAND_OK) {
-            // TODO: own type?
-            Py_INCREF(Py_None);
-            return (Result *)Py_None;
-        }
+    self->result = result;
+    self->on     = on;
 
-        ExecutionError_set(pg_result);
+    int width;
+
+    if ((self->columns = Index_columns(result, on, &width)) == NULL) {
+        Py_DECREF(self);
         return NULL;
     }
 
-    if (!b::type::ensure_ready(&Result_type))
-        return NULL;
+    self->oids = (Oid *)(self->columns + width);
 
-    Result *self = (Result *)Result_type.tp_alloc(&Result_type, 0);
-    if (self == NULL)
-        return NULL;
+    postgresql::index::Columns keys = {Result_rows(result), width, self->columns, self->oids};
 
-    self->pg_result    = pg_result;
-    self->column_count = PQnfields(pg_result);
-    self->row_count    = PQntuples(pg_result);
+    if ((self->index = new (std::nothrow) postgresql::index::Index(keys)) == NULL) {
+        Py_DECREF(self);
+        return (Index *)PyErr_NoMemory();
+    }
+
+    bool ok;
+    {
+        b::gil::Release release(result->row_count >= postgresql::aggregate::RELEASE_GIL_ROWS);
+        ok = self->index->build();
+    }
+
+    if (!ok) {
+        Py_DECREF(self);
+        return (Index *)PyErr_NoMemory();
+    }
 
     return self;
 }
 
-/* Transaction */
+/* Records */
 
 PyDoc_STRVAR(
-Transaction___doc__,
-"A transaction context manager");
+Records___doc__,
+"Fixed-width columns of a Result, packed into contiguous row-major records.\n\n"
+"Exposes the buffer protocol, one item per row, with a struct module format\n"
+"(native byte order, no padding).  NULL cells are zeroed in the buffer and\n"
+"flagged in 'nulls'.");
 
 static void
-Transaction___del__(Transaction *self)
+Records___del__(Records *self)
 {
-    Py_DECREF(self->database);
+    PyMem_FREE(self->data);
+    PyMem_FREE(self->nulls);
+    PyMem_FREE(self->format);
+    Py_XDECREF(self->names);
     return Py_TYPE(self)->tp_free((PyObject *)self);
 }
 
-static Transaction *
-Transaction___enter__(Transaction *self)
+static Py_ssize_t
+Records___len__(Records *self)
 {
-    PGresult *pg_result = PQexec(self->database->pg_conn, "BEGIN");
+    return self->count;
+}
 
-    if (PQresultStatus(pg_result) != PGRES_COMMAND_OK) {
-        ExecutionError_set(pg_result);
-        return NULL;
+/* Records_as_buffer */
+
+static int
+Records_getbuffer(Records *self, Py_buffer *view, int flags)
+{
+    if (flags & PyBUF_WRITABLE) {
+        PyErr_SetString(PyExc_BufferError, "Records are read-only");
+        return -1;
     }
 
-    PQclear(pg_result);
     Py_INCREF(self);
-    return self;
+
+    view->obj        = (PyObject *)self;
+    view->buf        = self->data;
+    view->len        = self->count * self->itemsize;
+    view->readonly   = 1;
+    view->itemsize   = self->itemsize;
+    view->format     = (flags & PyBUF_FORMAT)  ? self->format    : NULL;
+    view->ndim       = 1;
+    view->shape      = (flags & PyBUF_ND)      ? &self->count    : NULL;
+    view->strides    = (flags & PyBUF_STRIDES) ? &self->itemsize : NULL;
+    view->suboffsets = NULL;
+    view->internal   = NULL;
+
+    return 0;
 }
 
+/* Records_getset */
+
+PyDoc_STRVAR(
+Records_format___doc__,
+"The struct module format of one record");
+
 static PyObject *
-Transaction___exit__(Transaction *self, PyObject *args)
+Records_format(Records *self)
 {
-    if (PyTuple_GET_SIZE(args) == 3) { // Sanity
-        PGresult *pg_result = PQexec(self->database->pg_conn,
-                                     PyTuple_GET_ITEM(args, 0) == Py_None ? "COMMIT" : "ROLLBACK");
+    return PyUnicode_FromString(self->format);
+}
 
-        if (PQresultStatus(pg_result) != PGRES_COMMAND_OK) {
-            ExecutionError_set(pg_result);
-            return NULL;
-        }
+PyDoc_STRVAR(
+Records_itemsize___doc__,
+"The size in bytes of one record");
 
-        PQclear(pg_result);
-    }
+static PyObject *
+Records_itemsize(Records *self)
+{
+    return PyLong_FromSsize_t(self->itemsize);
+}
 
-    Py_RETURN_NONE;
+PyDoc_STRVAR(
+Records_names___doc__,
+"The column name of each field");
+
+static PyObject *
+Records_names(Records *self)
+{
+    Py_INCREF(self->names);
+    return self->names;
 }
 
-static PyMethodDef
-Transaction_methods[] = {
-    {"__enter__", (PyCFunction)Transaction___enter__, METH_NOARGS,  NULL},
-    {"__exit__",  (PyCFunction)Transaction___exit__,  METH_VARARGS, NULL},
+PyDoc_STRVAR(
+Records_nulls___doc__,
+"NULL bitmap: bit (row * len(names) + field) is set if NULL, least significant bit first");
+
+static PyObject *
+Records_nulls(Records *self)
+{
+    return PyBytes_FromStringAndSize((char *)self->nulls, (self->count * self->width + 7) / 8);
+}
+
+static PyGetSetDef
+Records_getset[] = {
+    {(char *)"format",   (getter)Records_format,   NULL, Records_format___doc__},
+    {(char *)"itemsize", (getter)Records_itemsize, NULL, Records_itemsize___doc__},
+    {(char *)"names",    (getter)Records_names,    NULL, Records_names___doc__},
+    {(char *)"nulls",    (getter)Records_nulls,    NULL, Records_nulls___doc__},
     {NULL}
 };
 
-static PyTypeObject
-Transaction_type = {
-    PyVarObject_HEAD_INIT(NULL, 0)
-    /* tp_name            */ "postgresql.Transaction",
-    /* tp_basicsize       */ sizeof(Transaction),
-    /* tp_itemsize        */ 0,
-    /* tp_dealloc         */ (destructor)Transaction___del__,
-    /* tp_print           */ 0,
+static PySequenceMethods
+Records_as_sequence = {
+    /* sq_length         */ (lenfunc)Records___len__,
+    /* sq_concat         */ 0,
+    /* sq_repeat         */ 0,
+    /* sq_item           */ 0,
+    /* was_sq_slice      */ 0,
+    /* sq_ass_item       */ 0,
+    /* was_sq_ass_slice  */ 0,
+    /* sq_contains       */ 0,
+    /* sq_inplace_concat */ 0,
+    /* sq_inplace_repeat */ 0,
+};
+
+static PyBufferProcs
+Records_as_buffer = {
+    /* bf_getbuffer     */ (getbufferproc)Records_getbuffer,
+    /* bf_releasebuffer */ 0,
+};
+
+static PyTypeObject
+Records_type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name            */ "postgresql.Records",
+    /* tp_basicsize       */ sizeof(Records),
+    /* tp_itemsize        */ 0,
+    /* tp_dealloc         */ (destructor)Records___del__,
+    /* tp_print           */ 0,
     /* tp_getattr         */ 0,
     /* tp_setattr         */ 0,
     /* tp_reserved        */ 0,
     /* tp_repr            */ 0,
     /* tp_as_number       */ 0,
-    /* tp_as_sequence     */ 0,
+    /* tp_as_sequence     */ &Records_as_sequence,
     /* tp_as_mapping      */ 0,
     /* tp_hash            */ 0,
     /* tp_call            */ 0,
     /* tp_str             */ 0,
     /* tp_getattro        */ 0,
     /* tp_setattro        */ 0,
-    /* tp_as_buffer       */ 0,
+    /* tp_as_buffer       */ &Records_as_buffer,
     /* tp_flags           */ Py_TPFLAGS_DEFAULT,
-    /* tp_doc             */ Transaction___doc__,
+    /* tp_doc             */ Records___doc__,
     /* tp_traverse        */ 0,
     /* tp_clear           */ 0,
     /* tp_richcompare     */ 0,
     /* tp_weaklist_offset */ 0,
     /* tp_iter            */ 0,
     /* tp_iternext        */ 0,
-    /* tp_methods         */ Transaction_methods,
+    /* tp_methods         */ 0,
     /* tp_members         */ 0,
-    /* tp_getset          */ 0,
+    /* tp_getset          */ Records_getset,
     /* tp_base            */ 0,
     /* tp_dict            */ 0,
     /* tp_descr_get       */ 0,
@@ -810,24 +1216,41 @@ Transaction_type = {
     /* tp_free            */ 0,
 };
 
-/* Schema */
+/* Blob */
 
 PyDoc_STRVAR(
-Schema___doc__,
-"A Database schema");
+Blob___doc__,
+"Exports one binary value of a Result, read-only and without a copy,\n"
+"keeping the Result alive while exported.");
 
-static PyMethodDef
-Schema_methods[] = {
-    {NULL}
+static void
+Blob___del__(Blob *self)
+{
+    Py_XDECREF(self->owner);
+    return Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+/* Blob_as_buffer */
+
+static int
+Blob_getbuffer(Blob *self, Py_buffer *view, int flags)
+{
+    return PyBuffer_FillInfo(view, (PyObject *)self, (void *)self->data, self->length, 1, flags);
+}
+
+static PyBufferProcs
+Blob_as_buffer = {
+    /* bf_getbuffer     */ (getbufferproc)Blob_getbuffer,
+    /* bf_releasebuffer */ 0,
 };
 
 static PyTypeObject
-Schema_type = {
+Blob_type = {
     PyVarObject_HEAD_INIT(NULL, 0)
-    /* tp_name            */ "postgresql.Schema",
-    /* tp_basicsize       */ sizeof(Schema),
+    /* tp_name            */ "postgresql.Blob",
+    /* tp_basicsize       */ sizeof(Blob),
     /* tp_itemsize        */ 0,
-    /* tp_dealloc         */ 0,
+    /* tp_dealloc         */ (destructor)Blob___del__,
     /* tp_print           */ 0,
     /* tp_getattr         */ 0,
     /* tp_setattr         */ 0,
@@ -841,16 +1264,16 @@ Schema_type = {
     /* tp_str             */ 0,
     /* tp_getattro        */ 0,
     /* tp_setattro        */ 0,
-    /* tp_as_buffer       */ 0,
+    /* tp_as_buffer       */ &Blob_as_buffer,
     /* tp_flags           */ Py_TPFLAGS_DEFAULT,
-    /* tp_doc             */ Schema___doc__,
+    /* tp_doc             */ Blob___doc__,
     /* tp_traverse        */ 0,
     /* tp_clear           */ 0,
     /* tp_richcompare     */ 0,
     /* tp_weaklist_offset */ 0,
     /* tp_iter            */ 0,
     /* tp_iternext        */ 0,
-    /* tp_methods         */ Schema_methods,
+    /* tp_methods         */ 0,
     /* tp_members         */ 0,
     /* tp_getset          */ 0,
     /* tp_base            */ 0,
@@ -864,216 +1287,3228 @@ Schema_type = {
     /* tp_free            */ 0,
 };
 
-/* Database */
+/**
+ * A read-only memoryview of length bytes at data, which owner keeps valid.
+ */
+static PyObject *
+Blob_view(PyObject *owner, const char *data, Py_ssize_t length)
+{
+    if (!b::type::ensure_ready(&Blob_type))
+        return NULL;
+
+    Blob *self = PyObject_New(Blob, &Blob_type);
+    if (self == NULL)
+        return NULL;
+
+    Py_INCREF(owner);
+
+    self->owner  = owner;
+    self->data   = data;
+    self->length = length;
+
+    PyObject *view = PyMemoryView_FromObject((PyObject *)self);
+    Py_DECREF(self); // The view holds it
+    return view;
+}
+
+/* Json */
 
 PyDoc_STRVAR(
-Database___doc__,
-"Object encapsulating a single PostgreSQL database.");
+Json___doc__,
+"The text of a json or jsonb value of a Result, parsed only once its 'value'\n"
+"is accessed.  bytes() and the buffer protocol give the text as is (for\n"
+"passing it through), str() decodes it.");
+
+static void
+Json___del__(Json *self)
+{
+    Py_XDECREF(self->value);
+    Py_XDECREF(self->owner);
+    return Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *
+Json___str__(Json *self)
+{
+    return b::unicode::from_utf8(self->data, self->length);
+}
+
+static PyObject *
+Json___repr__(Json *self)
+{
+    PyObject *text = Json___str__(self);
+    if (text == NULL)
+        return NULL;
+
+    PyObject *repr = PyUnicode_FromFormat("%s(%R)", Py_TYPE(self)->tp_name, text);
+    Py_DECREF(text);
+    return repr;
+}
+
+/* Json_as_buffer */
 
 static int
-Database___init__(Database *self, PyObject *args, PyDictObject *kwargs)
+Json_getbuffer(Json *self, Py_buffer *view, int flags)
 {
-    static b::Identifier id_dbname("dbname");
-    static b::Identifier id_host("host");
-    static b::Identifier id_name("name");
-    static b::Identifier id_password("password");
-    static b::Identifier id_port("port");
-    static b::Identifier id_user("user");
+    return PyBuffer_FillInfo(view, (PyObject *)self, (void *)self->data, self->length, 1, flags);
+}
 
-    char  *keywords[6];
-    char  *values  [6];
-    size_t i = 0;
+/* Json_getset */
 
-    PGconn *pg_conn;
+PyDoc_STRVAR(
+Json_value___doc__,
+"The parsed value: dicts, lists, strs, ints, floats, bools and None");
 
-    if (PyTuple_GET_SIZE(args) != 0) {
-        PyErr_Format(PyExc_TypeError, "'%s' takes no positional arguments, got: %R", Py_TYPE(self)->tp_name, args);
-        return -1;
+static PyObject *
+Json_value(Json *self)
+{
+    if (self->value == NULL && (self->value = postgresql::json::parse(self->data, self->length)) == NULL)
+        return NULL;
+
+    Py_INCREF(self->value);
+    return self->value;
+}
+
+/* Json_methods */
+
+PyDoc_STRVAR(
+Json___bytes_____doc__,
+"__bytes__() -> bytes\n\n"
+"The JSON text, as received");
+
+static PyObject *
+Json___bytes__(Json *self)
+{
+    return PyBytes_FromStringAndSize(self->data, self->length);
+}
+
+static PyGetSetDef
+Json_getset[] = {
+    {(char *)"value", (getter)Json_value, NULL, Json_value___doc__},
+    {NULL}
+};
+
+static PyMethodDef
+Json_methods[] = {
+    {"__bytes__", (PyCFunction)Json___bytes__, METH_NOARGS, Json___bytes_____doc__},
+    {NULL}
+};
+
+static PyBufferProcs
+Json_as_buffer = {
+    /* bf_getbuffer     */ (getbufferproc)Json_getbuffer,
+    /* bf_releasebuffer */ 0,
+};
+
+static PyTypeObject
+Json_type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name            */ "postgresql.Json",
+    /* tp_basicsize       */ sizeof(Json),
+    /* tp_itemsize        */ 0,
+    /* tp_dealloc         */ (destructor)Json___del__,
+    /* tp_print           */ 0,
+    /* tp_getattr         */ 0,
+    /* tp_setattr         */ 0,
+    /* tp_reserved        */ 0,
+    /* tp_repr            */ (reprfunc)Json___repr__,
+    /* tp_as_number       */ 0,
+    /* tp_as_sequence     */ 0,
+    /* tp_as_mapping      */ 0,
+    /* tp_hash            */ 0,
+    /* tp_call            */ 0,
+    /* tp_str             */ (reprfunc)Json___str__,
+    /* tp_getattro        */ 0,
+    /* tp_setattro        */ 0,
+    /* tp_as_buffer       */ &Json_as_buffer,
+    /* tp_flags           */ Py_TPFLAGS_DEFAULT,
+    /* tp_doc             */ Json___doc__,
+    /* tp_traverse        */ 0,
+    /* tp_clear           */ 0,
+    /* tp_richcompare     */ 0,
+    /* tp_weaklist_offset */ 0,
+    /* tp_iter            */ 0,
+    /* tp_iternext        */ 0,
+    /* tp_methods         */ Json_methods,
+    /* tp_members         */ 0,
+    /* tp_getset          */ Json_getset,
+    /* tp_base            */ 0,
+    /* tp_dict            */ 0,
+    /* tp_descr_get       */ 0,
+    /* tp_descr_set       */ 0,
+    /* tp_dictoffset      */ 0,
+    /* tp_init            */ 0,
+    /* tp_alloc           */ 0,
+    /* tp_new             */ 0,
+    /* tp_free            */ 0,
+};
+
+/**
+ * A Json of length bytes of text at data, which owner keeps valid.
+ */
+static PyObject *
+Json_new(PyObject *owner, const char *data, Py_ssize_t length)
+{
+    if (!b::type::ensure_ready(&Json_type))
+        return NULL;
+
+    Json *self = PyObject_New(Json, &Json_type);
+    if (self == NULL)
+        return NULL;
+
+    Py_INCREF(owner);
+
+    self->owner  = owner;
+    self->data   = data;
+    self->length = length;
+    self->value  = NULL;
+
+    return (PyObject *)self;
+}
+
+/* Result */
+
+PyDoc_STRVAR(
+Result___doc__,
+"Object representing a PostgreSQL command result.");
+
+static void
+Result___del__(Result *self)
+{
+    // Before the values they point into
+    delete[] self->dictionaries;
+
+    if (self->base == NULL) {
+        if (self->pg_result != NULL)
+            PQclear(self->pg_result);
+        delete self->store;
+        Py_XDECREF(self->owner);
+        if (self->options.registry != NULL)
+            self->options.registry->release();
+    } else {
+        Py_DECREF(self->base);
+        PyMem_FREE(self->columns);
     }
+    return Py_TYPE(self)->tp_free((PyObject *)self);
+}
 
-    if (kwargs != NULL) {
-        PyObject *o;
+static inline int
+Result_row_at(Result *self, int i)
+{
+    return self->row_start + i * self->row_step;
+}
 
-        o = id_host.get(kwargs);
-        if (o != NULL) {
-            if (!PyUnicode_Check(o)) {
-                PyErr_Format(PyExc_TypeError, "expecting string, got: %s=%R", id_host.ascii, o);
-                return -1;
-            }
+static inline int
+Result_column_at(Result *self, int j)
+{
+    return self->columns == NULL ? j : self->columns[j];
+}
 
-            if ((values[i] = PyUnicode_AsUTF8AndSize(o, NULL)) == NULL)
-                return -1;
+/* Column j (of pg_result or store) */
 
-            keywords[i++] = (char *)id_host.ascii;
-        }
+static inline Oid
+Result_oid(Result *self, int j)
+{
+    return self->store != NULL ? self->store->oid(j) : PQftype(self->pg_result, j);
+}
 
-        o = id_name.get(kwargs);
-        if (o != NULL) {
-            if (!PyUnicode_Check(o)) {
-                PyErr_Format(PyExc_TypeError, "expecting string, got: %s=%R", id_name.ascii, o);
-                return -1;
-            }
+static inline const char *
+Result_name(Result *self, int j)
+{
+    return self->store != NULL ? self->store->name(j) : PQfname(self->pg_result, j);
+}
 
-            if ((values[i] = PyUnicode_AsUTF8AndSize(o, NULL)) == NULL)
-                return -1;
+/**
+ * The dictionary of column j (of pg_result or store), or NULL if out of memory.
+ */
+static postgresql::dictionary::Dictionary *
+Result_dictionary(Result *self, int j)
+{
+    if (self->dictionaries == NULL) {
+        int count = self->store != NULL ? self->store->columns() : PQnfields(self->pg_result);
 
-            keywords[i++] = (char *)id_dbname.ascii;
-        }
+        self->dictionaries = new (std::nothrow) postgresql::dictionary::Dictionary[count];
+    }
 
-        o = id_password.get(kwargs);
-        if (o != NULL) {
-            if (!PyUnicode_Check(o)) {
-                PyErr_Format(PyExc_TypeError, "expecting string, got: %s=%R", id_password.ascii, o);
-                return -1;
-            }
+    return self->dictionaries == NULL ? NULL : &self->dictionaries[j];
+}
 
-            if ((values[i] = PyUnicode_AsUTF8AndSize(o, NULL)) == NULL)
-                return -1;
+/**
+ * Decode a text value of column j, scanned already unless scan is NULL.
+ */
+static inline PyObject *
+Result_text(Result *self, int j, const char *value, int length, const b::utf8::Scan *scan)
+{
+    auto build = [&]() {
+        return scan != NULL ? postgresql::TEXT::build(value, length, *scan) : postgresql::TEXT::decode(value, length);
+    };
 
-            keywords[i++] = (char *)id_password.ascii;
-        }
+    postgresql::dictionary::Dictionary *dictionary;
 
-        o = id_port.get(kwargs);
-        if (o != NULL) {
-            if (!PyLong_Check(o)) {
-                PyErr_Format(PyExc_TypeError, "expecting integer, got: %s=%R", id_port.ascii, o);
-                return -1;
-            }
+    if (self->options.texts == postgresql::Options::TEXTS_SHARED && (dictionary = Result_dictionary(self, j)) != NULL)
+        return dictionary->get(value, length, build);
 
-            TODO();
-            return -1;
+    return build();
+}
 
-            keywords[i++] = (char *)id_port.ascii;
+/**
+ * Decode a (non-NULL) value of column j of this Result.
+ */
+static inline PyObject *
+Result_decode_value(Result *self, int j, Oid oid, const char *value, int length)
+{
+    // Views of values must pin the Result they point into
+    if (oid == postgresql::BYTEA::OID && self->options.byteas == postgresql::Options::BYTEAS_VIEW)
+        return Blob_view((PyObject *)self, value, length);
+
+    if (oid == postgresql::TEXT::OID)
+        return Result_text(self, j, value, length, NULL);
+
+    if ((oid == postgresql::JSON::OID || oid == postgresql::JSONB::OID) && self->options.jsons == postgresql::Options::JSONS_LAZY) {
+        if (oid == postgresql::JSONB::OID && !postgresql::JSONB::text(&value, &length)) {
+            PyErr_SetString(PyExc_ValueError, "unsupported jsonb version");
+            return NULL;
         }
 
-        o = id_user.get(kwargs);
-        if (o != NULL) {
-            if (!PyUnicode_Check(o)) {
-                PyErr_Format(PyExc_TypeError, "expecting string, got: %s=%R", id_user.ascii, o);
-                return -1;
-            }
+        return Json_new((PyObject *)self, value, length);
+    }
 
-            if ((values[i] = PyUnicode_AsUTF8AndSize(o, NULL)) == NULL)
-                return -1;
+    return postgresql::decode(oid, value, length, self->options);
+}
+
+/**
+ * Decode the value at row i, column j (of pg_result or store).
+ */
+static inline PyObject *
+Result_decode(Result *self, int i, int j)
+{
+    if (self->store != NULL) {
+        if (self->store->isnull(i, j))
+            Py_RETURN_NONE;
+
+        return Result_decode_value(self, j, self->store->oid(j), self->store->value(i, j), self->store->length(i, j));
+    }
+
+    if (PQgetisnull(self->pg_result, i, j))
+        Py_RETURN_NONE;
+
+    return Result_decode_value(self, j, PQftype(self->pg_result, j), PQgetvalue(self->pg_result, i, j), PQgetlength(self->pg_result, i, j));
+}
+
+static inline postgresql::Rows
+Result_rows(Result *self)
+{
+    postgresql::Rows rows;
+
+    rows.pg_result = self->pg_result;
+    rows.store     = self->store;
+    rows.start     = self->row_start;
+    rows.step      = self->row_step;
+    rows.count     = self->row_count;
+
+    return rows;
+}
+
+static inline Row *
+Result_row(Result *self, int i)
+{
+    assert(i < self->row_count);
+
+    if (!b::type::ensure_ready(&Row_type))
+        return NULL;
+
+    Row *row = (Row *)Row_type.tp_alloc(&Row_type, 0);
+    if (row == NULL)
+        return NULL;
+
+    Py_INCREF(self);
+
+    row->index  = Result_row_at(self, i);
+    row->result = self;
+
+    return row;
+}
+
+/**
+ * Resolve a column reference, either an index or a name,
+ * to an index into this Result's (possibly projected) columns.
+ */
+static int
+Result_column_index(Result *self, PyObject *reference)
+{
+    if (PyUnicode_Check(reference)) {
+        const char *name = PyUnicode_AsUTF8(reference);
+        if (name == NULL)
+            return -1;
+
+        for (int j = 0; j < self->column_count; j++) {
+            if (strcmp(Result_name(self, Result_column_at(self, j)), name) == 0)
+                return j;
+        }
+
+        PyErr_Format(PyExc_KeyError, "no such column: %R", reference);
+        return -1;
+    }
+
+    Py_ssize_t j = PyNumber_AsSsize_t(reference, PyExc_IndexError);
+    if (j == -1 && PyErr_Occurred())
+        return -1;
+
+    if (j < 0)
+        j += self->column_count;
+
+    if (j < 0 || j >= self->column_count) {
+        PyErr_Format(PyExc_IndexError, "column index out of range: %R", reference);
+        return -1;
+    }
+
+    return (int)j;
+}
+
+/**
+ * Create a view sharing self's PGresult.
+ *
+ * Rows are [start, start + step, ...) of self, columns are
+ * indexes into self's columns (or NULL to keep them all).
+ * Views of views are flattened onto the same base.
+ */
+static Result *
+Result_view(Result *self, Py_ssize_t start, Py_ssize_t step, Py_ssize_t row_count,
+            int *columns, int column_count)
+{
+    int *projection = NULL;
+
+    if (columns != NULL || self->columns != NULL) {
+        projection = (int *)PyMem_MALLOC(sizeof(int) * (column_count > 0 ? column_count : 1));
+        if (projection == NULL) {
+            PyErr_NoMemory();
+            return NULL;
+        }
+
+        for (int j = 0; j < column_count; j++)
+            projection[j] = Result_column_at(self, columns == NULL ? j : columns[j]);
+    }
+
+    Result *view = (Result *)Py_TYPE(self)->tp_alloc(Py_TYPE(self), 0);
+    if (view == NULL) {
+        PyMem_FREE(projection);
+        return NULL;
+    }
+
+    Result *base = self->base == NULL ? self : self->base;
+    Py_INCREF(base);
+
+    view->pg_result    = self->pg_result;
+    view->store        = self->store;
+    view->row_count    = (int)row_count;
+    view->column_count = column_count;
+    view->base         = base;
+    view->row_start    = Result_row_at(self, (int)start);
+    view->row_step     = self->row_step * (int)step;
+    view->columns      = projection;
+    view->options      = self->options;
+
+    return view;
+}
+
+static Py_ssize_t
+Result___len__(Result *self)
+{
+    return self->row_count;
+}
+
+static Row *
+Result___getitem__(Result *self, Py_ssize_t i)
+{
+    if (i < 0 || i >= self->row_count) {
+        PyErr_SetString(PyExc_IndexError, "Result index out of range");
+        return NULL;
+    }
+    return Result_row(self, i);
+}
+
+static PyObject *
+Result_subscript(Result *self, PyObject *key)
+{
+    if (PySlice_Check(key)) {
+        Py_ssize_t start, stop, step;
+
+        if (PySlice_Unpack(key, &start, &stop, &step) < 0)
+            return NULL;
+
+        Py_ssize_t length = PySlice_AdjustIndices(self->row_count, &start, &stop, step);
+
+        return (PyObject *)Result_view(self, start, step, length, NULL, self->column_count);
+    }
+
+    if (!PyIndex_Check(key)) {
+        PyErr_Format(PyExc_TypeError, "Result indices must be integers or slices, got: %R", key);
+        return NULL;
+    }
+
+    Py_ssize_t i = PyNumber_AsSsize_t(key, PyExc_IndexError);
+    if (i == -1 && PyErr_Occurred())
+        return NULL;
+
+    if (i < 0)
+        i += self->row_count;
+
+    return (PyObject *)Result___getitem__(self, i);
+}
+
+static ResultIterator *
+Result___iter__(Result *self)
+{
+    if (!b::type::ensure_ready(&ResultIterator_type))
+        return NULL;
+
+    ResultIterator *iterator = (ResultIterator *)ResultIterator_type.tp_alloc(&ResultIterator_type, 0);
+    if (iterator == NULL)
+        return NULL;
+
+    Py_INCREF(self);
+
+    iterator->result = self;
+    iterator->index  = 0;
+
+    return iterator;
+}
+
+/* Methods */
+
+PyDoc_STRVAR(
+Result_select___doc__,
+"Return a view of this Result projected onto the given columns (indexes or names).");
+
+static Result *
+Result_select(Result *self, PyObject *references)
+{
+    PyObject *sequence = PySequence_Fast(references, "expecting a sequence of columns");
+    if (sequence == NULL)
+        return NULL;
+
+    Py_ssize_t n = PySequence_Fast_GET_SIZE(sequence);
+
+    int *columns = (int *)PyMem_MALLOC(sizeof(int) * (n > 0 ? n : 1));
+    if (columns == NULL) {
+        Py_DECREF(sequence);
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    Result *view = NULL;
+
+    for (Py_ssize_t j = 0; j < n; j++) {
+        if ((columns[j] = Result_column_index(self, PySequence_Fast_GET_ITEM(sequence, j))) == -1)
+            goto done;
+    }
+
+    view = Result_view(self, 0, 1, self->row_count, columns, (int)n);
+
+  done:
+    PyMem_FREE(columns);
+    Py_DECREF(sequence);
+    return view;
+}
+
+PyDoc_STRVAR(
+Result_aggregate___doc__,
+"aggregate(column, op) -> value\n\n"
+"Aggregate a column natively, where op is one of 'count', 'sum', 'min' or 'max'.\n"
+"NULLs are ignored; like SQL, sum/min/max of no values is None.");
+
+static PyObject *
+Result_aggregate(Result *self, PyObject *args)
+{
+    PyObject *reference;
+    PyObject *name;
+
+    if (!PyArg_ParseTuple(args, "OU:aggregate", &reference, &name))
+        return NULL;
+
+    postgresql::aggregate::Op op;
+
+    if (PyUnicode_CompareWithASCIIString(name, "sum") == 0)
+        op = postgresql::aggregate::SUM;
+    else if (PyUnicode_CompareWithASCIIString(name, "min") == 0)
+        op = postgresql::aggregate::MIN;
+    else if (PyUnicode_CompareWithASCIIString(name, "max") == 0)
+        op = postgresql::aggregate::MAX;
+    else if (PyUnicode_CompareWithASCIIString(name, "count") == 0)
+        op = postgresql::aggregate::COUNT;
+    else {
+        PyErr_Format(PyExc_ValueError, "unknown aggregate: %R", name);
+        return NULL;
+    }
+
+    int j = Result_column_index(self, reference);
+    if (j == -1)
+        return NULL;
+
+    j = Result_column_at(self, j);
+
+    return postgresql::aggregate::apply(Result_rows(self), j, Result_oid(self, j), op);
+}
+
+/**
+ * Export this Result as an Arrow schema and struct array (record batch).
+ * Returns false with an exception set on failure; out structs are then released.
+ */
+static bool
+Result_arrow(Result *self, ArrowSchema *schema, ArrowArray *batch)
+{
+    int width = self->column_count;
+
+    schema->release = NULL;
+    batch ->release = NULL;
+
+    int         *columns = (int *)        PyMem_MALLOC(sizeof(int)          * (width > 0 ? width : 1));
+    Oid         *oids    = (Oid *)        PyMem_MALLOC(sizeof(Oid)          * (width > 0 ? width : 1));
+    const char **names   = (const char **)PyMem_MALLOC(sizeof(const char *) * (width > 0 ? width : 1));
+
+    bool ok = false;
+
+    if (columns == NULL || oids == NULL || names == NULL) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    for (int c = 0; c < width; c++) {
+        columns[c] = Result_column_at(self, c);
+        oids   [c] = Result_oid(self, columns[c]);
+        names  [c] = Result_name(self, columns[c]);
+
+        if (postgresql::arrow::format(oids[c]) == NULL) {
+            PyErr_Format(PyExc_NotImplementedError, "Arrow export of column %s (type %u)", names[c], oids[c]);
+            goto done;
+        }
+    }
+
+    if (!postgresql::arrow::schema(schema, width, names, oids)) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    {
+        postgresql::Rows rows = Result_rows(self);
+
+        b::gil::Release release(rows.count >= postgresql::aggregate::RELEASE_GIL_ROWS);
+        ok = postgresql::arrow::batch(batch, schema, rows, width, columns, oids);
+    }
+
+    if (!ok)
+        PyErr_NoMemory();
+
+  done:
+    if (!ok) {
+        if (schema->release != NULL)
+            schema->release(schema);
+        if (batch->release != NULL)
+            batch->release(batch);
+    }
+
+    PyMem_FREE(columns);
+    PyMem_FREE(oids);
+    PyMem_FREE(names);
+    return ok;
+}
+
+static void
+Result_arrow_schema___del__(PyObject *capsule)
+{
+    ArrowSchema *schema = (ArrowSchema *)PyCapsule_GetPointer(capsule, "arrow_schema");
+    if (schema->release != NULL)
+        schema->release(schema);
+    PyMem_RawFree(schema);
+}
+
+static void
+Result_arrow_array___del__(PyObject *capsule)
+{
+    ArrowArray *array = (ArrowArray *)PyCapsule_GetPointer(capsule, "arrow_array");
+    if (array->release != NULL)
+        array->release(array);
+    PyMem_RawFree(array);
+}
+
+static void
+Result_arrow_array_stream___del__(PyObject *capsule)
+{
+    ArrowArrayStream *stream = (ArrowArrayStream *)PyCapsule_GetPointer(capsule, "arrow_array_stream");
+    if (stream->release != NULL)
+        stream->release(stream);
+    PyMem_RawFree(stream);
+}
+
+PyDoc_STRVAR(
+Result___arrow_c_array_____doc__,
+"__arrow_c_array__(requested_schema=None) -> (schema capsule, array capsule)\n\n"
+"Arrow PyCapsule protocol: this Result as a struct array (record batch),\n"
+"built straight from the binary cells.");
+
+static PyObject *
+Result___arrow_c_array__(Result *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *keywords[] = {"requested_schema", NULL};
+
+    PyObject *requested = Py_None;
+
+    // Only the natural schema is offered, as the protocol allows
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O:__arrow_c_array__", (char **)keywords, &requested))
+        return NULL;
+
+    ArrowSchema *schema = (ArrowSchema *)PyMem_RawMalloc(sizeof(ArrowSchema));
+    ArrowArray  *batch  = (ArrowArray *) PyMem_RawMalloc(sizeof(ArrowArray));
+
+    if (schema == NULL || batch == NULL) {
+        PyMem_RawFree(schema);
+        PyMem_RawFree(batch);
+        return PyErr_NoMemory();
+    }
+
+    if (!Result_arrow(self, schema, batch)) {
+        PyMem_RawFree(schema);
+        PyMem_RawFree(batch);
+        return NULL;
+    }
+
+    PyObject *schema_capsule = PyCapsule_New(schema, "arrow_schema", Result_arrow_schema___del__);
+    if (schema_capsule == NULL) {
+        schema->release(schema);
+        PyMem_RawFree(schema);
+    }
+
+    PyObject *array_capsule = PyCapsule_New(batch, "arrow_array", Result_arrow_array___del__);
+    if (array_capsule == NULL) {
+        batch->release(batch);
+        PyMem_RawFree(batch);
+    }
+
+    PyObject *pair = (schema_capsule == NULL || array_capsule == NULL) ? NULL : PyTuple_Pack(2, schema_capsule, array_capsule);
+
+    Py_XDECREF(schema_capsule);
+    Py_XDECREF(array_capsule);
+    return pair;
+}
+
+PyDoc_STRVAR(
+Result___arrow_c_stream_____doc__,
+"__arrow_c_stream__(requested_schema=None) -> stream capsule\n\n"
+"Arrow PyCapsule protocol: this Result as a stream of one record batch.");
+
+static PyObject *
+Result___arrow_c_stream__(Result *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *keywords[] = {"requested_schema", NULL};
+
+    PyObject *requested = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O:__arrow_c_stream__", (char **)keywords, &requested))
+        return NULL;
+
+    ArrowArrayStream *stream = (ArrowArrayStream *)PyMem_RawMalloc(sizeof(ArrowArrayStream));
+    if (stream == NULL)
+        return PyErr_NoMemory();
+
+    ArrowSchema schema;
+    ArrowArray  batch;
+
+    if (!Result_arrow(self, &schema, &batch)) {
+        PyMem_RawFree(stream);
+        return NULL;
+    }
+
+    if (!postgresql::arrow::stream(stream, &schema, &batch)) {
+        PyMem_RawFree(stream);
+        return PyErr_NoMemory();
+    }
+
+    PyObject *capsule = PyCapsule_New(stream, "arrow_array_stream", Result_arrow_array_stream___del__);
+    if (capsule == NULL) {
+        stream->release(stream);
+        PyMem_RawFree(stream);
+    }
+
+    return capsule;
+}
+
+PyDoc_STRVAR(
+Result_columns___doc__,
+"columns(threads=1) -> list of lists\n\n"
+"Decode this Result column-wise.  Fixed-width (dates and times included) and\n"
+"text cells are first decoded into native buffers with the GIL released, over\n"
+"up to 'threads' threads (0 for one per CPU); only building the Python objects\n"
+"needs the GIL.");
+
+static PyObject *
+Result_columns(Result *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *keywords[] = {"threads", NULL};
+
+    int threads = 1;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|i:columns", (char **)keywords, &threads))
+        return NULL;
+
+    if (threads <= 0)
+        threads = std::thread::hardware_concurrency();
+
+    postgresql::Rows rows = Result_rows(self);
+
+    std::vector<postgresql::columns::Column *> columns;
+    PyObject *lists = NULL;
+
+    try {
+        columns.reserve(self->column_count);
+    } catch (std::bad_alloc &) {
+        return PyErr_NoMemory();
+    }
+
+    for (int c = 0; c < self->column_count; c++) {
+        int j = Result_column_at(self, c);
+
+        postgresql::columns::Column *column = new (std::nothrow) postgresql::columns::Column(j, Result_oid(self, j));
+        if (column == NULL || (columns.push_back(column), !column->allocate(rows.count))) {
+            PyErr_NoMemory();
+            goto done;
+        }
+    }
+
+    {
+        b::gil::Release release;
+        postgresql::columns::decode(rows, columns, threads);
+    }
+
+    if ((lists = PyList_New(self->column_count)) == NULL)
+        goto done;
+
+    for (int c = 0; c < self->column_count; c++) {
+        postgresql::columns::Column *column = columns[c];
+
+        PyObject *list = PyList_New(rows.count);
+        if (list == NULL) {
+            Py_CLEAR(lists);
+            goto done;
+        }
+
+        PyList_SET_ITEM(lists, c, list);
+
+        for (int k = 0; k < rows.count; k++) {
+            PyObject *x;
+
+            if (column->flags[k] & postgresql::columns::ISNULL) {
+                Py_INCREF(Py_None);
+                x = Py_None;
+            } else {
+                switch (column->kind) {
+                  case postgresql::columns::BOOLEAN:
+                      x = PyBool_FromLong(column->integers[k]);
+                      break;
+                  case postgresql::columns::INTEGER:
+                      x = PyLong_FromLongLong(column->integers[k]);
+                      break;
+                  case postgresql::columns::REAL:
+                      x = PyFloat_FromDouble(column->reals[k]);
+                      break;
+                  case postgresql::columns::TEXT:
+                      x = Result_text(self, column->j, rows.value(k, column->j), rows.length(k, column->j), &column->texts[k]);
+                      break;
+                  case postgresql::columns::TEMPORAL:
+                      x = postgresql::columns::temporal(column->oid, column->integers[k], self->options);
+                      break;
+                  default:
+                      x = Result_decode_value(self, column->j, column->oid, rows.value(k, column->j), rows.length(k, column->j));
+                }
+
+                if (x == NULL) {
+                    Py_CLEAR(lists);
+                    goto done;
+                }
+            }
+
+            PyList_SET_ITEM(list, k, x);
+        }
+    }
+
+  done:
+    for (size_t c = 0; c < columns.size(); c++)
+        delete columns[c];
+
+    return lists;
+}
+
+/**
+ * Flush formatted CSV to fd, or to file's write method if fd is -1.
+ */
+static bool
+Result_write_csv_flush(postgresql::csv::Writer &writer, int fd, PyObject *file)
+{
+    if (writer.size == 0)
+        return true;
+
+    if (fd != -1) {
+        bool ok;
+        {
+            b::gil::Release release;
+            ok = postgresql::csv::write_all(fd, writer.data, writer.size);
+        }
+
+        if (!ok) {
+            PyErr_SetFromErrno(PyExc_OSError);
+            return false;
+        }
+    } else {
+        PyObject *chunk = PyBytes_FromStringAndSize(writer.data, writer.size);
+        if (chunk == NULL)
+            return false;
+
+        PyObject *written = PyObject_CallMethod(file, "write", "O", chunk);
+        Py_DECREF(chunk);
+
+        // Text files want str
+        if (written == NULL && PyErr_ExceptionMatches(PyExc_TypeError)) {
+            PyErr_Clear();
+
+            if ((chunk = PyUnicode_DecodeUTF8(writer.data, writer.size, NULL)) == NULL)
+                return false;
+
+            written = PyObject_CallMethod(file, "write", "O", chunk);
+            Py_DECREF(chunk);
+        }
+
+        if (written == NULL)
+            return false;
+        Py_DECREF(written);
+    }
+
+    writer.size = 0;
+    return true;
+}
+
+/**
+ * Write a Result as CSV to fd (or file, if fd is -1).
+ * Returns the number of rows written, or -1 with an exception set.
+ */
+static Py_ssize_t
+Result_write_csv_to(Result *self, int fd, PyObject *file, char delimiter, PyObject *null, int header)
+{
+    Py_ssize_t  null_length;
+    const char *null_bytes = PyUnicode_AsUTF8AndSize(null, &null_length);
+    if (null_bytes == NULL)
+        return -1;
+
+    int  width   = self->column_count;
+    int *columns = (int *)PyMem_MALLOC((sizeof(int) + sizeof(Oid)) * (width > 0 ? width : 1));
+    if (columns == NULL) {
+        PyErr_NoMemory();
+        return -1;
+    }
+
+    Oid *oids = (Oid *)(columns + width);
+
+    postgresql::csv::Writer writer(delimiter, null_bytes, null_length);
+    postgresql::Rows        rows = Result_rows(self);
+
+    Py_ssize_t written = -1;
+
+    for (int c = 0; c < width; c++) {
+        columns[c] = Result_column_at(self, c);
+        oids   [c] = Result_oid(self, columns[c]);
+
+        if (!postgresql::csv::supported(oids[c])) {
+            PyErr_Format(PyExc_NotImplementedError, "CSV of column %s (type %u)", Result_name(self, columns[c]), oids[c]);
+            goto done;
+        }
+    }
+
+    if (header) {
+        for (int c = 0; c < width; c++) {
+            const char *name = Result_name(self, columns[c]);
+
+            if ((c != 0 && !writer.separator()) || !writer.text(name, strlen(name)))
+                goto oom;
+        }
+
+        if (!writer.newline())
+            goto oom;
+    }
+
+    for (int k = 0; k < rows.count; ) {
+        bool ok = true;
+        {
+            b::gil::Release release;
+
+            while (k < rows.count && writer.size < postgresql::csv::FLUSH_SIZE && ok)
+                ok = writer.row(rows, k++, width, columns, oids);
+        }
+
+        if (!ok)
+            goto oom;
+
+        if (!Result_write_csv_flush(writer, fd, file))
+            goto done;
+    }
+
+    if (!Result_write_csv_flush(writer, fd, file))
+        goto done;
+
+    written = rows.count;
+    goto done;
+
+  oom:
+    PyErr_NoMemory();
+
+  done:
+    PyMem_FREE(columns);
+    return written;
+}
+
+static bool
+Result_csv_options(PyObject *delimiter, char *c)
+{
+    Py_UCS4 x = PyUnicode_Check(delimiter) && PyUnicode_GET_LENGTH(delimiter) == 1 ? PyUnicode_READ_CHAR(delimiter, 0) : 0;
+
+    // Neither the quote nor a line break, so the output parses back
+    if (x == 0 || x > 127 || x == '"' || x == '\r' || x == '\n') {
+        PyErr_Format(PyExc_ValueError, "delimiter must be a single ASCII character other than '\"' and line breaks, got: %R", delimiter);
+        return false;
+    }
+
+    *c = (char)PyUnicode_READ_CHAR(delimiter, 0);
+    return true;
+}
+
+PyDoc_STRVAR(
+Result_write_csv___doc__,
+"write_csv(file, delimiter=',', null='', header=False) -> number of rows\n\n"
+"Write this Result as CSV, formatting cells natively from their binary values,\n"
+"in large buffered writes.  file is a file descriptor or a file object; those\n"
+"with a fileno() are flushed, then written to directly with the GIL released.");
+
+static PyObject *
+Result_write_csv(Result *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *keywords[] = {"file", "delimiter", "null", "header", NULL};
+
+    PyObject *file;
+    PyObject *delimiter = NULL;
+    PyObject *null      = NULL;
+    int       header    = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|UUp:write_csv", (char **)keywords, &file, &delimiter, &null, &header))
+        return NULL;
+
+    char c = ',';
+    if (delimiter != NULL && !Result_csv_options(delimiter, &c))
+        return NULL;
+
+    int fd = -1;
+
+    if (PyLong_Check(file)) {
+        if ((fd = PyLong_AsLong(file)) == -1 && PyErr_Occurred())
+            return NULL;
+    } else {
+        PyObject *fileno = PyObject_CallMethod(file, "fileno", NULL);
+
+        if (fileno == NULL) {
+            // e.g. io.BytesIO - use its write method
+            if (!PyErr_ExceptionMatches(PyExc_AttributeError) && !PyErr_ExceptionMatches(PyExc_OSError))
+                return NULL;
+            PyErr_Clear();
+        } else {
+            fd = PyLong_AsLong(fileno);
+            Py_DECREF(fileno);
+            if (fd == -1 && PyErr_Occurred())
+                return NULL;
+
+            // Anything already buffered goes first
+            PyObject *flushed = PyObject_CallMethod(file, "flush", NULL);
+            if (flushed == NULL)
+                return NULL;
+            Py_DECREF(flushed);
+        }
+    }
+
+    PyObject *empty = NULL;
+    if (null == NULL && (null = empty = PyUnicode_FromStringAndSize("", 0)) == NULL)
+        return NULL;
+
+    Py_ssize_t written = Result_write_csv_to(self, fd, file, c, null, header);
+
+    Py_XDECREF(empty);
+
+    if (written == -1)
+        return NULL;
+    return PyLong_FromSsize_t(written);
+}
+
+PyDoc_STRVAR(
+Result_group_count___doc__,
+"group_count(column) -> dict\n\n"
+"Count rows per distinct value of a column, grouping on the raw cell bytes\n"
+"and decoding one value per group.");
+
+static PyObject *
+Result_group_count(Result *self, PyObject *reference)
+{
+    int j = Result_column_index(self, reference);
+    if (j == -1)
+        return NULL;
+
+    j = Result_column_at(self, j);
+
+    postgresql::Rows rows = Result_rows(self);
+
+    b::hash::Table<postgresql::aggregate::Group> groups;
+    Py_ssize_t nulls;
+    bool       ok;
+    {
+        b::gil::Release release(rows.count >= postgresql::aggregate::RELEASE_GIL_ROWS);
+        ok = postgresql::aggregate::group(rows, j, groups, &nulls);
+    }
+
+    if (!ok)
+        return PyErr_NoMemory();
+
+    PyObject *counts = PyDict_New();
+    if (counts == NULL)
+        return NULL;
+
+    if (nulls != 0) {
+        PyObject *count = PyLong_FromSsize_t(nulls);
+        if (count == NULL || PyDict_SetItem(counts, Py_None, count) == -1) {
+            Py_XDECREF(count);
+            Py_DECREF(counts);
+            return NULL;
+        }
+        Py_DECREF(count);
+    }
+
+    for (size_t i = 0; i < groups.capacity(); i++) {
+        postgresql::aggregate::Group *group = groups.slot(i);
+        if (group->hash == 0)
+            continue;
+
+        PyObject *key = Result_decode(self, rows.row(group->k), j);
+        if (key == NULL) {
+            Py_DECREF(counts);
+            return NULL;
+        }
+
+        // Distinct bytes may decode equal (e.g. 0.0 and -0.0)
+        Py_ssize_t n = group->count;
+
+        PyObject *previous = PyDict_GetItemWithError(counts, key);
+        if (previous != NULL)
+            n += PyLong_AsSsize_t(previous);
+        else if (PyErr_Occurred())
+            n = -1;
+
+        PyObject *count = n == -1 ? NULL : PyLong_FromSsize_t(n);
+        if (count == NULL || PyDict_SetItem(counts, key, count) == -1) {
+            Py_XDECREF(count);
+            Py_DECREF(key);
+            Py_DECREF(counts);
+            return NULL;
+        }
+
+        Py_DECREF(count);
+        Py_DECREF(key);
+    }
+
+    return counts;
+}
+
+PyDoc_STRVAR(
+Result_index_by___doc__,
+"index_by(column_or_columns) -> Index\n\n"
+"Build a hash index over the raw key bytes, mapping keys to (lazily decoded) Rows.");
+
+static Index *
+Result_index_by(Result *self, PyObject *on)
+{
+    if (!b::type::ensure_ready(&Index_type))
+        return NULL;
+
+    return Index_new(self, on);
+}
+
+PyDoc_STRVAR(
+Result_join___doc__,
+"join(other, on, other_on=None) -> list of (Row, Row)\n\n"
+"Inner join with other Result, on key column(s) 'on' of this Result and\n"
+"'other_on' (by default, the same) of other.");
+
+static PyObject *
+Result_join(Result *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *keywords[] = {"other", "on", "other_on", NULL};
+
+    Result   *other;
+    PyObject *on;
+    PyObject *other_on = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|O:join", (char **)keywords, &other, &on, &other_on))
+        return NULL;
+
+    if (!Result_check((PyObject *)other)) {
+        PyErr_Format(PyExc_TypeError, "expecting a Result, got: %R", other);
+        return NULL;
+    }
+
+    Index *index = Result_index_by(self, on);
+    if (index == NULL)
+        return NULL;
+
+    PyObject *joined = PyObject_CallMethod((PyObject *)index, "join", "OO", other, other_on);
+
+    Py_DECREF(index);
+    return joined;
+}
+
+PyDoc_STRVAR(
+Result_to_records___doc__,
+"to_records(columns=None) -> Records\n\n"
+"Pack fixed-width columns (BOOL, INT2/4/8, FLOAT4/8, DATE, TIMESTAMP[TZ]) into\n"
+"one row-major buffer; by default, all such columns.");
+
+static Records *
+Result_to_records(Result *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *keywords[] = {"columns", NULL};
+
+    PyObject *references = Py_None;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|O:to_records", (char **)keywords, &references))
+        return NULL;
+
+    if (!b::type::ensure_ready(&Records_type))
+        return NULL;
+
+    PyObject *sequence = NULL;
+    int       width    = self->column_count;
+
+    if (references != Py_None) {
+        if ((sequence = PySequence_Fast(references, "expecting a sequence of columns")) == NULL)
+            return NULL;
+        width = PySequence_Fast_GET_SIZE(sequence);
+    }
+
+    postgresql::records::Field *fields = (postgresql::records::Field *)PyMem_MALLOC(
+        sizeof(postgresql::records::Field) * (width > 0 ? width : 1));
+
+    Records *records = (Records *)Records_type.tp_alloc(&Records_type, 0);
+
+    if (records == NULL || fields == NULL ||
+        (records->format = (char *)PyMem_MALLOC(width + 2)) == NULL ||
+        (records->names  = PyList_New(0)) == NULL) {
+        if (!PyErr_Occurred())
+            PyErr_NoMemory();
+        goto fail;
+    }
+
+    {
+        int    n      = 0;
+        size_t offset = 0;
+
+        records->format[0] = '=';
+
+        for (int c = 0; c < width; c++) {
+            int j;
+
+            if (sequence == NULL) {
+                j = c;
+            } else if ((j = Result_column_index(self, PySequence_Fast_GET_ITEM(sequence, c))) == -1) {
+                goto fail;
+            }
+
+            j = Result_column_at(self, j);
+
+            Oid  oid    = Result_oid(self, j);
+            char format = postgresql::records::format(oid);
+
+            if (format == 0) {
+                // Skip variable width columns, unless asked for
+                if (sequence == NULL)
+                    continue;
+
+                PyErr_Format(PyExc_TypeError, "not a fixed-width column: %s", Result_name(self, j));
+                goto fail;
+            }
+
+            PyObject *name = PyUnicode_FromString(Result_name(self, j));
+            if (name == NULL || PyList_Append(records->names, name) == -1) {
+                Py_XDECREF(name);
+                goto fail;
+            }
+            Py_DECREF(name);
+
+            fields[n].j      = j;
+            fields[n].oid    = oid;
+            fields[n].offset = offset;
+
+            records->format[1 + n++] = format;
+            offset += postgresql::records::size(format);
+        }
+
+        records->format[1 + n] = '\0';
+        records->width         = n;
+        records->count         = self->row_count;
+        records->itemsize      = offset;
+    }
+
+    {
+        PyObject *names = PyList_AsTuple(records->names);
+        if (names == NULL)
+            goto fail;
+        Py_SETREF(records->names, names);
+    }
+
+    records->data  = (char *)   PyMem_MALLOC(records->count * records->itemsize + 1);
+    records->nulls = (uint8_t *)PyMem_MALLOC((records->count * records->width + 7) / 8 + 1);
+
+    if (records->data == NULL || records->nulls == NULL) {
+        PyErr_NoMemory();
+        goto fail;
+    }
+
+    {
+        postgresql::Rows rows = Result_rows(self);
+
+        b::gil::Release release(rows.count >= postgresql::aggregate::RELEASE_GIL_ROWS);
+        postgresql::records::pack(rows, fields, records->width, records->itemsize, records->data, records->nulls);
+    }
+
+    PyMem_FREE(fields);
+    Py_XDECREF(sequence);
+    return records;
+
+  fail:
+    PyMem_FREE(fields);
+    Py_XDECREF(sequence);
+    Py_XDECREF(records);
+    return NULL;
+}
+
+/**
+ * Describe this Result's rows and columns for a snapshot, in arrays
+ * of column_count owned by the caller.
+ */
+static inline postgresql::snapshot::Selection
+Result_selection(Result *self, int *columns, Oid *oids, const char **names)
+{
+    for (int c = 0; c < self->column_count; c++) {
+        columns[c] = Result_column_at(self, c);
+        oids   [c] = Result_oid (self, columns[c]);
+        names  [c] = Result_name(self, columns[c]);
+    }
+
+    postgresql::snapshot::Selection selection;
+
+    selection.rows    = Result_rows(self);
+    selection.width   = self->column_count;
+    selection.columns = columns;
+    selection.oids    = oids;
+    selection.names   = names;
+
+    return selection;
+}
+
+/**
+ * Update options from keyword arguments naming them.
+ */
+static bool
+Result_options(PyObject *kwargs, postgresql::Options *options)
+{
+    if (kwargs == NULL)
+        return true;
+
+    PyObject   *key;
+    PyObject   *value;
+    Py_ssize_t  i = 0;
+
+    while (PyDict_Next(kwargs, &i, &key, &value)) {
+        const char *name   = PyUnicode_AsUTF8(key);
+        const char *choice = PyUnicode_Check(value) ? PyUnicode_AsUTF8(value) : NULL;
+
+        if (name == NULL)
+            return false;
+
+        if (strcmp(name, "arrays") == 0) {
+            if      (choice != NULL && strcmp(choice, "list")   == 0) options->arrays = postgresql::Options::ARRAYS_LIST;
+            else if (choice != NULL && strcmp(choice, "buffer") == 0) options->arrays = postgresql::Options::ARRAYS_BUFFER;
+            else goto invalid;
+        } else if (strcmp(name, "byteas") == 0) {
+            if      (choice != NULL && strcmp(choice, "bytes") == 0) options->byteas = postgresql::Options::BYTEAS_BYTES;
+            else if (choice != NULL && strcmp(choice, "view")  == 0) options->byteas = postgresql::Options::BYTEAS_VIEW;
+            else goto invalid;
+        } else if (strcmp(name, "texts") == 0) {
+            if      (choice != NULL && strcmp(choice, "new")    == 0) options->texts = postgresql::Options::TEXTS_NEW;
+            else if (choice != NULL && strcmp(choice, "shared") == 0) options->texts = postgresql::Options::TEXTS_SHARED;
+            else goto invalid;
+        } else if (strcmp(name, "uuids") == 0) {
+            if      (choice != NULL && strcmp(choice, "objects") == 0) options->uuids = postgresql::Options::UUIDS_OBJECTS;
+            else if (choice != NULL && strcmp(choice, "bytes")   == 0) options->uuids = postgresql::Options::UUIDS_BYTES;
+            else goto invalid;
+        } else if (strcmp(name, "jsons") == 0) {
+            if      (choice != NULL && strcmp(choice, "parsed") == 0) options->jsons = postgresql::Options::JSONS_PARSED;
+            else if (choice != NULL && strcmp(choice, "lazy")   == 0) options->jsons = postgresql::Options::JSONS_LAZY;
+            else goto invalid;
+        } else if (strcmp(name, "datetimes") == 0) {
+            if      (choice != NULL && strcmp(choice, "objects") == 0) options->datetimes = postgresql::Options::DATETIMES_OBJECTS;
+            else if (choice != NULL && strcmp(choice, "epoch")   == 0) options->datetimes = postgresql::Options::DATETIMES_EPOCH;
+            else goto invalid;
+        } else if (strcmp(name, "numerics") == 0) {
+            if      (choice != NULL && strcmp(choice, "decimal") == 0) options->numerics = postgresql::Options::NUMERICS_DECIMAL;
+            else if (choice != NULL && strcmp(choice, "int")     == 0) options->numerics = postgresql::Options::NUMERICS_INT;
+            else if (choice != NULL && strcmp(choice, "float")   == 0) options->numerics = postgresql::Options::NUMERICS_FLOAT;
+            else goto invalid;
+        } else {
+            PyErr_Format(PyExc_TypeError, "no such decoding option: %R", key);
+            return false;
+        }
+
+        continue;
+
+      invalid:
+        PyErr_Clear();
+        PyErr_Format(PyExc_ValueError, "invalid choice for %U: %R", key, value);
+        return false;
+    }
+
+    return true;
+}
+
+PyDoc_STRVAR(
+Result_decoding___doc__,
+"decoding(**options) -> Result\n\n"
+"A view of this Result decoding values as chosen:\n\n"
+"  arrays='list'        nested lists (the default)\n"
+"  arrays='buffer'      memoryviews shaped as the array, in native order, for\n"
+"                       arrays of bool, int and float without NULLs\n"
+"  byteas='bytes'       bytea as bytes, copied (the default)\n"
+"  byteas='view'        bytea as read-only memoryviews of this Result's own\n"
+"                       memory, keeping it alive while any is referenced\n"
+"  datetimes='objects'  date, time and datetime (the default); timestamptz\n"
+"                       in UTC, infinities as their min and max\n"
+"  datetimes='epoch'    ints: days since 1970-01-01 for date, microseconds\n"
+"                       since 1970-01-01 for timestamp(tz), since midnight\n"
+"                       for time\n"
+"  jsons='parsed'       json and jsonb parsed natively (the default)\n"
+"  jsons='lazy'         json and jsonb as Json objects, which parse their\n"
+"                       text only once their value is accessed\n"
+"  numerics='decimal'   numeric as Decimal, exactly (the default)\n"
+"  numerics='int'       int where the scale is 0, otherwise Decimal\n"
+"  numerics='float'     float, correctly rounded\n"
+"  texts='new'          a str per text value (the default)\n"
+"  texts='shared'       one str per distinct value of a column, while values\n"
+"                       repeat; it stops once most are distinct\n"
+"  uuids='objects'      uuid as uuid.UUID (the default)\n"
+"  uuids='bytes'        uuid as its 16 bytes, for comparing and hashing");
+
+static Result *
+Result_decoding(Result *self, PyObject *args, PyObject *kwargs)
+{
+    if (PyTuple_GET_SIZE(args) != 0) {
+        PyErr_SetString(PyExc_TypeError, "decoding() takes only keyword arguments");
+        return NULL;
+    }
+
+    postgresql::Options options = self->options;
+
+    if (!Result_options(kwargs, &options))
+        return NULL;
+
+    Result *view = Result_view(self, 0, 1, self->row_count, NULL, self->column_count);
+    if (view == NULL)
+        return NULL;
+
+    view->options = options;
+    return view;
+}
+
+PyDoc_STRVAR(
+Result_dumps___doc__,
+"dumps() -> bytes\n\n"
+"Serialize this Result's raw values and column types compactly,\n"
+"for postgresql.loads().");
+
+static PyObject *
+Result_dumps(Result *self)
+{
+    int width = self->column_count;
+
+    int         *columns = (int *)        PyMem_MALLOC(sizeof(int)          * (width > 0 ? width : 1));
+    Oid         *oids    = (Oid *)        PyMem_MALLOC(sizeof(Oid)          * (width > 0 ? width : 1));
+    const char **names   = (const char **)PyMem_MALLOC(sizeof(const char *) * (width > 0 ? width : 1));
+
+    PyObject *bytes = NULL;
+
+    if (columns == NULL || oids == NULL || names == NULL) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    {
+        postgresql::snapshot::Selection selection = Result_selection(self, columns, oids, names);
+
+        bool     release = self->row_count >= postgresql::aggregate::RELEASE_GIL_ROWS;
+        uint64_t size;
+        {
+            b::gil::Release _(release);
+            size = postgresql::snapshot::size(selection);
+        }
+
+        if (size == 0 || size > (uint64_t)PY_SSIZE_T_MAX) {
+            PyErr_SetString(PyExc_OverflowError, "Result too large to dump");
+            goto done;
+        }
+
+        if ((bytes = PyBytes_FromStringAndSize(NULL, (Py_ssize_t)size)) == NULL)
+            goto done;
+
+        char *data    = PyBytes_AS_STRING(bytes);
+        char *aligned = data;
+
+        if ((uintptr_t)data % postgresql::store::ALIGNMENT != 0 && (aligned = (char *)malloc(size)) == NULL) {
+            Py_CLEAR(bytes);
+            PyErr_NoMemory();
+            goto done;
+        }
+
+        {
+            b::gil::Release _(release);
+            postgresql::snapshot::write(selection, aligned, size);
+        }
+
+        if (aligned != data) {
+            memcpy(data, aligned, size);
+            free(aligned);
+        }
+    }
+
+  done:
+    PyMem_FREE(columns);
+    PyMem_FREE(oids);
+    PyMem_FREE(names);
+    return bytes;
+}
+
+PyDoc_STRVAR(
+Result_share___doc__,
+"share() -> name\n\n"
+"Copy this Result's raw values into a new POSIX shared memory segment,\n"
+"returning its name for postgresql.attach() in other processes.\n"
+"The segment remains until postgresql.unshare(name).");
+
+static PyObject *
+Result_share(Result *self)
+{
+    static unsigned long serial = 0;
+
+    int width = self->column_count;
+
+    int         *columns = (int *)        PyMem_MALLOC(sizeof(int)          * (width > 0 ? width : 1));
+    Oid         *oids    = (Oid *)        PyMem_MALLOC(sizeof(Oid)          * (width > 0 ? width : 1));
+    const char **names   = (const char **)PyMem_MALLOC(sizeof(const char *) * (width > 0 ? width : 1));
+
+    PyObject *name = NULL;
+
+    if (columns == NULL || oids == NULL || names == NULL) {
+        PyErr_NoMemory();
+        goto done;
+    }
+
+    {
+        postgresql::snapshot::Selection selection = Result_selection(self, columns, oids, names);
+
+        bool     release = self->row_count >= postgresql::aggregate::RELEASE_GIL_ROWS;
+        uint64_t size;
+        {
+            b::gil::Release _(release);
+            size = postgresql::snapshot::size(selection);
+        }
+
+        if (size == 0 || size > (uint64_t)PY_SSIZE_T_MAX) {
+            PyErr_SetString(PyExc_OverflowError, "Result too large to share");
+            goto done;
+        }
+
+        char path[64];
+        snprintf(path, sizeof(path), "/postgresql-%ld-%lu", (long)getpid(), serial++);
+
+        int fd = shm_open(path, O_CREAT | O_EXCL | O_RDWR, 0600);
+        if (fd == -1) {
+            PyErr_SetFromErrno(PyExc_OSError);
+            goto done;
+        }
+
+        void *data = MAP_FAILED;
+
+        if (ftruncate(fd, (off_t)size) == 0)
+            data = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+        if (data == MAP_FAILED) {
+            PyErr_SetFromErrno(PyExc_OSError);
+            close(fd);
+            shm_unlink(path);
+            goto done;
+        }
+
+        close(fd);
+
+        {
+            b::gil::Release _(release);
+            postgresql::snapshot::write(selection, (char *)data, size);
+        }
+
+        munmap(data, size);
+
+        if ((name = PyUnicode_FromString(path)) == NULL)
+            shm_unlink(path);
+    }
+
+  done:
+    PyMem_FREE(columns);
+    PyMem_FREE(oids);
+    PyMem_FREE(names);
+    return name;
+}
+
+static PyMethodDef
+Result_methods[] = {
+    {"__arrow_c_array__",  (PyCFunction)Result___arrow_c_array__,  METH_VARARGS | METH_KEYWORDS, Result___arrow_c_array_____doc__},
+    {"__arrow_c_stream__", (PyCFunction)Result___arrow_c_stream__, METH_VARARGS | METH_KEYWORDS, Result___arrow_c_stream_____doc__},
+    {"aggregate",   (PyCFunction)Result_aggregate,   METH_VARARGS, Result_aggregate___doc__},
+    {"columns",     (PyCFunction)Result_columns,     METH_VARARGS | METH_KEYWORDS, Result_columns___doc__},
+    {"decoding",    (PyCFunction)Result_decoding,    METH_VARARGS | METH_KEYWORDS, Result_decoding___doc__},
+    {"dumps",       (PyCFunction)Result_dumps,       METH_NOARGS,  Result_dumps___doc__},
+    {"group_count", (PyCFunction)Result_group_count, METH_O,       Result_group_count___doc__},
+    {"index_by",    (PyCFunction)Result_index_by,    METH_O,       Result_index_by___doc__},
+    {"join",        (PyCFunction)Result_join,        METH_VARARGS | METH_KEYWORDS, Result_join___doc__},
+    {"select",      (PyCFunction)Result_select,      METH_O,       Result_select___doc__},
+    {"share",       (PyCFunction)Result_share,       METH_NOARGS,  Result_share___doc__},
+    {"to_records",  (PyCFunction)Result_to_records,  METH_VARARGS | METH_KEYWORDS, Result_to_records___doc__},
+    {"write_csv",   (PyCFunction)Result_write_csv,   METH_VARARGS | METH_KEYWORDS, Result_write_csv___doc__},
+    {NULL}
+};
+
+static PyMappingMethods
+Result_as_mapping = {
+    /* mp_length        */ (lenfunc)Result___len__,
+    /* mp_subscript     */ (binaryfunc)Result_subscript,
+    /* mp_ass_subscript */ 0,
+};
+
+static PySequenceMethods
+Result_as_sequence = {
+    /* sq_length         */ (lenfunc)Result___len__,
+    /* sq_concat         */ 0,
+    /* sq_repeat         */ 0,
+    /* sq_item           */ (ssizeargfunc)Result___getitem__,
+    /* sq_ass_item       */ 0,
+    /* sq_contains       */ 0,
+    /* sq_inplace_concat */ 0,
+    /* sq_inplace_repeat */ 0,
+};
+
+static PyTypeObject
+Result_type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name            */ "postgresql.Result",
+    /* tp_basicsize       */ sizeof(Result),
+    /* tp_itemsize        */ 0,
+    /* tp_dealloc         */ (destructor)Result___del__,
+    /* tp_print           */ 0,
+    /* tp_getattr         */ 0,
+    /* tp_setattr         */ 0,
+    /* tp_reserved        */ 0,
+    /* tp_repr            */ 0,
+    /* tp_as_number       */ 0,
+    /* tp_as_sequence     */ &Result_as_sequence,
+    /* tp_as_mapping      */ &Result_as_mapping,
+    /* tp_hash            */ 0,
+    /* tp_call            */ 0,
+    /* tp_str             */ 0,
+    /* tp_getattro        */ 0,
+    /* tp_setattro        */ 0,
+    /* tp_as_buffer       */ 0,
+    /* tp_flags           */ Py_TPFLAGS_DEFAULT,
+    /* tp_doc             */ Result___doc__,
+    /* tp_traverse        */ 0,
+    /* tp_clear           */ 0,
+    /* tp_richcompare     */ 0,
+    /* tp_weaklist_offset */ 0,
+    /* tp_iter            */ (getiterfunc)Result___iter__,
+    /* tp_iternext        */ 0,
+    /* tp_methods         */ Result_methods,
+    /* tp_members         */ 0,
+    /* tp_getset          */ 0,
+    /* tp_base            */ 0,
+    /* tp_dict            */ 0,
+    /* tp_descr_get       */ 0,
+    /* tp_descr_set       */ 0,
+    /* tp_dictoffset      */ 0,
+    /* tp_init            */ 0,
+    /* tp_alloc           */ 0,
+    /* tp_new             */ 0,
+    /* tp_free            */ 0,
+};
+
+static inline bool
+Result_check(PyObject *x)
+{
+    return Py_TYPE(x) == &Result_type;
+}
+
+static inline Result *
+Result_new(PGresult *pg_result)
+{
+    ExecStatusType status = PQresultStatus(pg_result);
+
+    // Fast path the common cases outside of a switch
+
+    if (status != PGRES_TUPLES_OK) {
+        if (status == PGRES_COMMAND_OK) {
+            // TODO: own type?
+            Py_INCREF(Py_None);
+            return (Result *)Py_None;
+        }
+
+        ExecutionError_set(pg_result);
+        return NULL;
+    }
+
+    if (!b::type::ensure_ready(&Result_type))
+        return NULL;
+
+    Result *self = (Result *)Result_type.tp_alloc(&Result_type, 0);
+    if (self == NULL)
+        return NULL;
+
+    self->pg_result    = pg_result;
+    self->column_count = PQnfields(pg_result);
+    self->row_count    = PQntuples(pg_result);
+    self->row_step     = 1;
+
+    return self;
+}
+
+/**
+ * Create a Result over (and taking ownership of) a store.
+ */
+static inline Result *
+Result_from_store(postgresql::store::Store *store)
+{
+    if (!b::type::ensure_ready(&Result_type)) {
+        delete store;
+        return NULL;
+    }
+
+    Result *self = (Result *)Result_type.tp_alloc(&Result_type, 0);
+    if (self == NULL) {
+        delete store;
+        return NULL;
+    }
+
+    self->store        = store;
+    self->column_count = store->columns();
+    self->row_count    = store->rows();
+    self->row_step     = 1;
+
+    return self;
+}
+
+/* Transaction */
+
+PyDoc_STRVAR(
+Transaction___doc__,
+"A transaction context manager");
+
+static void
+Transaction___del__(Transaction *self)
+{
+    Py_DECREF(self->database);
+    return Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static Transaction *
+Transaction___enter__(Transaction *self)
+{
+    PGresult *pg_result = PQexec(self->database->pg_conn, "BEGIN");
+
+    if (PQresultStatus(pg_result) != PGRES_COMMAND_OK) {
+        ExecutionError_set(pg_result);
+        return NULL;
+    }
+
+    PQclear(pg_result);
+    Py_INCREF(self);
+    return self;
+}
+
+static PyObject *
+Transaction___exit__(Transaction *self, PyObject *args)
+{
+    if (PyTuple_GET_SIZE(args) == 3) { // Sanity
+        PGresult *pg_result = PQexec(self->database->pg_conn,
+                                     PyTuple_GET_ITEM(args, 0) == Py_None ? "COMMIT" : "ROLLBACK");
+
+        if (PQresultStatus(pg_result) != PGRES_COMMAND_OK) {
+            ExecutionError_set(pg_result);
+            return NULL;
+        }
+
+        PQclear(pg_result);
+    }
+
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef
+Transaction_methods[] = {
+    {"__enter__", (PyCFunction)Transaction___enter__, METH_NOARGS,  NULL},
+    {"__exit__",  (PyCFunction)Transaction___exit__,  METH_VARARGS, NULL},
+    {NULL}
+};
+
+static PyTypeObject
+Transaction_type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name            */ "postgresql.Transaction",
+    /* tp_basicsize       */ sizeof(Transaction),
+    /* tp_itemsize        */ 0,
+    /* tp_dealloc         */ (destructor)Transaction___del__,
+    /* tp_print           */ 0,
+    /* tp_getattr         */ 0,
+    /* tp_setattr         */ 0,
+    /* tp_reserved        */ 0,
+    /* tp_repr            */ 0,
+    /* tp_as_number       */ 0,
+    /* tp_as_sequence     */ 0,
+    /* tp_as_mapping      */ 0,
+    /* tp_hash            */ 0,
+    /* tp_call            */ 0,
+    /* tp_str             */ 0,
+    /* tp_getattro        */ 0,
+    /* tp_setattro        */ 0,
+    /* tp_as_buffer       */ 0,
+    /* tp_flags           */ Py_TPFLAGS_DEFAULT,
+    /* tp_doc             */ Transaction___doc__,
+    /* tp_traverse        */ 0,
+    /* tp_clear           */ 0,
+    /* tp_richcompare     */ 0,
+    /* tp_weaklist_offset */ 0,
+    /* tp_iter            */ 0,
+    /* tp_iternext        */ 0,
+    /* tp_methods         */ Transaction_methods,
+    /* tp_members         */ 0,
+    /* tp_getset          */ 0,
+    /* tp_base            */ 0,
+    /* tp_dict            */ 0,
+    /* tp_descr_get       */ 0,
+    /* tp_descr_set       */ 0,
+    /* tp_dictoffset      */ 0,
+    /* tp_init            */ 0,
+    /* tp_alloc           */ 0,
+    /* tp_new             */ 0,
+    /* tp_free            */ 0,
+};
+
+/* Schema */
+
+PyDoc_STRVAR(
+Schema___doc__,
+"A Database schema: its tables with their columns, and its types, as loaded\n"
+"from pg_catalog in one query and kept on the Database until invalidated.");
+
+static void
+Schema___del__(Schema *self)
+{
+    Py_DECREF(self->database);
+    Py_DECREF(self->name);
+    return Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+static PyObject *
+Schema___repr__(Schema *self)
+{
+    return PyUnicode_FromFormat("%s(%R)", Py_TYPE(self)->tp_name, self->name);
+}
+
+/* Schema_getset */
+
+static PyObject *
+Schema_name(Schema *self)
+{
+    Py_INCREF(self->name);
+    return self->name;
+}
+
+static PyGetSetDef
+Schema_getset[] = {
+    {(char *)"name", (getter)Schema_name, NULL, NULL},
+    {NULL}
+};
+
+/* Methods */
+
+PyDoc_STRVAR(
+Schema_columns___doc__,
+"columns(table) -> list of (name, type OID, not null) tuples, in order");
+
+static PyObject *
+Schema_columns(Schema *self, PyObject *name)
+{
+    if (!PyUnicode_Check(name)) {
+        PyErr_Format(PyExc_TypeError, "expecting string, got: %R", name);
+        return NULL;
+    }
+
+    const char *table_name = PyUnicode_AsUTF8(name);
+    if (table_name == NULL)
+        return NULL;
+
+    const postgresql::catalog::Schema *schema = Database_catalog_schema(self->database, self->name);
+    if (schema == NULL)
+        return NULL;
+
+    const postgresql::catalog::Table *table = schema->table(table_name);
+    if (table == NULL) {
+        PyErr_SetObject(PyExc_KeyError, name);
+        return NULL;
+    }
+
+    PyObject *list = PyList_New(table->columns.size());
+    if (list == NULL)
+        return NULL;
+
+    for (size_t i = 0; i < table->columns.size(); i++) {
+        const postgresql::catalog::Column &column = table->columns[i];
+
+        PyObject *x = Py_BuildValue("(NkO)", PyUnicode_FromStringAndSize(column.name.data(), column.name.size()),
+                                    (unsigned long)column.type, column.not_null ? Py_True : Py_False);
+        if (x == NULL) {
+            Py_DECREF(list);
+            return NULL;
+        }
+
+        PyList_SET_ITEM(list, i, x);
+    }
+
+    return list;
+}
+
+PyDoc_STRVAR(
+Schema_invalidate___doc__,
+"invalidate()\n\n"
+"Forget what was loaded of this schema, to load it afresh when next needed.");
+
+static PyObject *
+Schema_invalidate(Schema *self)
+{
+    const char *name = PyUnicode_AsUTF8(self->name);
+    if (name == NULL)
+        return NULL;
+
+    if (self->database->catalog != NULL)
+        self->database->catalog->invalidate(name);
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(
+Schema_tables___doc__,
+"tables() -> list of the names of its tables, views and the like");
+
+static PyObject *
+Schema_tables(Schema *self)
+{
+    const postgresql::catalog::Schema *schema = Database_catalog_schema(self->database, self->name);
+    if (schema == NULL)
+        return NULL;
+
+    PyObject *list = PyList_New(schema->tables.size());
+    if (list == NULL)
+        return NULL;
+
+    for (size_t i = 0; i < schema->tables.size(); i++) {
+        const std::string &name = schema->tables[i].name;
+
+        PyObject *x = PyUnicode_FromStringAndSize(name.data(), name.size());
+        if (x == NULL) {
+            Py_DECREF(list);
+            return NULL;
+        }
+
+        PyList_SET_ITEM(list, i, x);
+    }
+
+    return list;
+}
+
+PyDoc_STRVAR(
+Schema_types___doc__,
+"types() -> dict of the OIDs of its composite, domain, enum and range types\n"
+"by name, all registered for decoding as they were loaded");
+
+static PyObject *
+Schema_types(Schema *self)
+{
+    const postgresql::catalog::Schema *schema = Database_catalog_schema(self->database, self->name);
+    if (schema == NULL)
+        return NULL;
+
+    PyObject *dict = PyDict_New();
+    if (dict == NULL)
+        return NULL;
+
+    for (size_t i = 0; i < schema->types.size(); i++) {
+        const postgresql::catalog::Type &type = schema->types[i];
+
+        PyObject *name = PyUnicode_FromStringAndSize(type.name.data(), type.name.size());
+        PyObject *oid  = PyLong_FromUnsignedLong(type.oid);
+
+        if (name == NULL || oid == NULL || PyDict_SetItem(dict, name, oid) == -1) {
+            Py_XDECREF(name);
+            Py_XDECREF(oid);
+            Py_DECREF(dict);
+            return NULL;
+        }
+
+        Py_DECREF(name);
+        Py_DECREF(oid);
+    }
+
+    return dict;
+}
+
+static PyMethodDef
+Schema_methods[] = {
+    {"columns",    (PyCFunction)Schema_columns,    METH_O,      Schema_columns___doc__},
+    {"invalidate", (PyCFunction)Schema_invalidate, METH_NOARGS, Schema_invalidate___doc__},
+    {"tables",     (PyCFunction)Schema_tables,     METH_NOARGS, Schema_tables___doc__},
+    {"types",      (PyCFunction)Schema_types,      METH_NOARGS, Schema_types___doc__},
+    {NULL}
+};
+
+static PyTypeObject
+Schema_type = {
+    PyVarObject_HEAD_INIT(NULL, 0)
+    /* tp_name            */ "postgresql.Schema",
+    /* tp_basicsize       */ sizeof(Schema),
+    /* tp_itemsize        */ 0,
+    /* tp_dealloc         */ (destructor)Schema___del__,
+    /* tp_print           */ 0,
+    /* tp_getattr         */ 0,
+    /* tp_setattr         */ 0,
+    /* tp_reserved        */ 0,
+    /* tp_repr            */ (reprfunc)Schema___repr__,
+    /* tp_as_number       */ 0,
+    /* tp_as_sequence     */ 0,
+    /* tp_as_mapping      */ 0,
+    /* tp_hash            */ 0,
+    /* tp_call            */ 0,
+    /* tp_str             */ 0,
+    /* tp_getattro        */ 0,
+    /* tp_setattro        */ 0,
+    /* tp_as_buffer       */ 0,
+    /* tp_flags           */ Py_TPFLAGS_DEFAULT,
+    /* tp_doc             */ Schema___doc__,
+    /* tp_traverse        */ 0,
+    /* tp_clear           */ 0,
+    /* tp_richcompare     */ 0,
+    /* tp_weaklist_offset */ 0,
+    /* tp_iter            */ 0,
+    /* tp_iternext        */ 0,
+    /* tp_methods         */ Schema_methods,
+    /* tp_members         */ 0,
+    /* tp_getset          */ Schema_getset,
+    /* tp_base            */ 0,
+    /* tp_dict            */ 0,
+    /* tp_descr_get       */ 0,
+    /* tp_descr_set       */ 0,
+    /* tp_dictoffset      */ 0,
+    /* tp_init            */ 0,
+    /* tp_alloc           */ 0,
+    /* tp_new             */ 0,
+    /* tp_free            */ 0,
+};
+
+/* Database */
+
+PyDoc_STRVAR(
+Database___doc__,
+"Object encapsulating a single PostgreSQL database.");
+
+static int
+Database___init__(Database *self, PyObject *args, PyDictObject *kwargs)
+{
+    static b::Identifier id_dbname("dbname");
+    static b::Identifier id_host("host");
+    static b::Identifier id_memory_budget("memory_budget");
+    static b::Identifier id_name("name");
+    static b::Identifier id_password("password");
+    static b::Identifier id_port("port");
+    static b::Identifier id_user("user");
+
+    char  *keywords[6];
+    char  *values  [6];
+    size_t i = 0;
+
+    PGconn    *pg_conn;
+    Py_ssize_t memory_budget = 0;
+
+    if (PyTuple_GET_SIZE(args) != 0) {
+        PyErr_Format(PyExc_TypeError, "'%s' takes no positional arguments, got: %R", Py_TYPE(self)->tp_name, args);
+        return -1;
+    }
+
+    if (kwargs != NULL) {
+        PyObject *o;
+
+        o = id_host.get(kwargs);
+        if (o != NULL) {
+            if (!PyUnicode_Check(o)) {
+                PyErr_Format(PyExc_TypeError, "expecting string, got: %s=%R", id_host.ascii, o);
+                return -1;
+            }
+
+            if ((values[i] = PyUnicode_AsUTF8AndSize(o, NULL)) == NULL)
+                return -1;
+
+            keywords[i++] = (char *)id_host.ascii;
+        }
+
+        o = id_memory_budget.get(kwargs);
+        if (o != NULL && o != Py_None) {
+            if (!PyLong_Check(o)) {
+                PyErr_Format(PyExc_TypeError, "expecting integer, got: %s=%R", id_memory_budget.ascii, o);
+                return -1;
+            }
+
+            if ((memory_budget = PyLong_AsSsize_t(o)) == -1 && PyErr_Occurred())
+                return -1;
+
+            if (memory_budget <= 0) {
+                PyErr_Format(PyExc_ValueError, "expecting a positive number of bytes, got: %s=%R", id_memory_budget.ascii, o);
+                return -1;
+            }
+        }
+
+        o = id_name.get(kwargs);
+        if (o != NULL) {
+            if (!PyUnicode_Check(o)) {
+                PyErr_Format(PyExc_TypeError, "expecting string, got: %s=%R", id_name.ascii, o);
+                return -1;
+            }
+
+            if ((values[i] = PyUnicode_AsUTF8AndSize(o, NULL)) == NULL)
+                return -1;
+
+            keywords[i++] = (char *)id_dbname.ascii;
+        }
+
+        o = id_password.get(kwargs);
+        if (o != NULL) {
+            if (!PyUnicode_Check(o)) {
+                PyErr_Format(PyExc_TypeError, "expecting string, got: %s=%R", id_password.ascii, o);
+                return -1;
+            }
+
+            if ((values[i] = PyUnicode_AsUTF8AndSize(o, NULL)) == NULL)
+                return -1;
+
+            keywords[i++] = (char *)id_password.ascii;
+        }
+
+        o = id_port.get(kwargs);
+        if (o != NULL) {
+            if (!PyLong_Check(o)) {
+                PyErr_Format(PyExc_TypeError, "expecting integer, got: %s=%R", id_port.ascii, o);
+                return -1;
+            }
+
+            TODO();
+            return -1;
+
+            keywords[i++] = (char *)id_port.ascii;
+        }
+
+        o = id_user.get(kwargs);
+        if (o != NULL) {
+            if (!PyUnicode_Check(o)) {
+                PyErr_Format(PyExc_TypeError, "expecting string, got: %s=%R", id_user.ascii, o);
+                return -1;
+            }
+
+            if ((values[i] = PyUnicode_AsUTF8AndSize(o, NULL)) == NULL)
+                return -1;
+
+            keywords[i++] = (char *)id_user.ascii;
+        }
+    }
+
+    keywords[i] = NULL;
+    values  [i] = NULL;
+
+    pg_conn = PQconnectdbParams((const char **)keywords, (const char **)values, 0);
+
+    if (PQstatus(pg_conn) != CONNECTION_OK) {
+        ConnectionError_set(pg_conn);
+        return -1;
+    }
+
+    // Re-initialized?
+    if (self->pg_conn != NULL) {
+        PQfinish(self->pg_conn);
+    }
+
+    delete self->cache;
+    self->cache = NULL;
+
+    delete self->catalog;
+    self->catalog = NULL;
+
+    if (self->registry != NULL)
+        self->registry->release();
+    self->registry = NULL;
+
+    self->pg_conn       = pg_conn;
+    self->memory_budget = memory_budget;
+
+    return 0;
+}
+
+static void
+Database___del__(Database *self)
+{
+    Py_XDECREF(self->host);
+    Py_XDECREF(self->name);
+    Py_XDECREF(self->user);
+
+    delete self->cache;
+    delete self->catalog;
+
+    if (self->registry != NULL)
+        self->registry->release();
+
+    if (self->pg_conn != NULL)
+        PQfinish(self->pg_conn);
+
+    Py_TYPE(self)->tp_free((PyObject *)self);
+}
+
+/**
+ * Execute a command in single-row mode, keeping the rows in a store
+ * that spills to disk past the Database's memory budget, rather than
+ * letting libpq buffer them all in memory.
+ */
+static Result *
+Database_execute_stored(Database *self, const char *command, int n,
+                        const Oid *types, const char * const *values, const int *lengths, const int *formats)
+{
+    PGconn                     *pg_conn = self->pg_conn;
+    PGresult                   *last    = NULL; // The result ending the command
+    postgresql::store::Store   *store   = NULL;
+    postgresql::store::Builder  builder((size_t)self->memory_budget);
+    bool                        sent;
+
+    {
+        b::gil::Release release;
+
+        sent = PQsendQueryParams(pg_conn, command, n, types, values, lengths, formats, 1) == 1;
+
+        if (sent) {
+            PQsetSingleRowMode(pg_conn);
+
+            for (PGresult *pg_result; (pg_result = PQgetResult(pg_conn)) != NULL; ) {
+                ExecStatusType status = PQresultStatus(pg_result);
+
+                // Once the builder fails, keep draining the connection
+                if ((status == PGRES_SINGLE_TUPLE || status == PGRES_TUPLES_OK) && builder.error == 0) {
+                    if (!builder.begun())
+                        builder.begin(pg_result);
+                    if (status == PGRES_SINGLE_TUPLE && builder.error == 0)
+                        builder.append(pg_result, 0);
+                }
+
+                if (status == PGRES_SINGLE_TUPLE) {
+                    PQclear(pg_result);
+                } else {
+                    if (last != NULL)
+                        PQclear(last);
+                    last = pg_result;
+                }
+            }
+
+            if (last != NULL && PQresultStatus(last) == PGRES_TUPLES_OK && builder.error == 0)
+                store = builder.finish();
+        }
+    }
+
+    if (last == NULL) {
+        PyErr_SetString(PyExc_OSError, PQerrorMessage(pg_conn));
+        return NULL;
+    }
+
+    // Commands without rows, and errors (even after some rows)
+    if (PQresultStatus(last) != PGRES_TUPLES_OK)
+        return Result_new(last);
+
+    PQclear(last);
+
+    if (store == NULL) {
+        errno = builder.error;
+        PyErr_SetFromErrno(builder.error == ENOMEM ? PyExc_MemoryError : PyExc_OSError);
+        return NULL;
+    }
+
+    return Result_from_store(store);
+}
+
+static inline bool
+Database_listening(Database *self)
+{
+    return (self->cache   != NULL && self->cache  ->channel != NULL) ||
+           (self->catalog != NULL && self->catalog->channel != NULL);
+}
+
+/**
+ * Apply the notifications libpq holds.
+ */
+static bool
+Database_notifies(Database *self)
+{
+    postgresql::cache::Cache     *cache   = self->cache;
+    postgresql::catalog::Catalog *catalog = self->catalog;
+
+    PGnotify *notify;
+
+    while ((notify = PQnotifies(self->pg_conn)) != NULL) {
+        Py_ssize_t invalidated = 0;
+
+        // An empty payload invalidates everything
+
+        if (cache != NULL && cache->channel != NULL && strcmp(notify->relname, cache->channel) == 0) {
+            PyObject *tag = NULL;
+
+            if (*notify->extra != '\0' && (tag = PyUnicode_FromString(notify->extra)) == NULL)
+                invalidated = -1;
+            else
+                invalidated = cache->invalidate(tag);
+
+            Py_XDECREF(tag);
+        }
+
+        if (catalog != NULL && catalog->channel != NULL && strcmp(notify->relname, catalog->channel) == 0)
+            catalog->invalidate(*notify->extra != '\0' ? notify->extra : NULL);
+
+        PQfreemem(notify);
+
+        if (invalidated == -1)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Invalidate cached Results as notified on the cache's channel, and
+ * loaded schemas as notified on the catalog's.
+ *
+ * Notifications libpq already holds are applied first. Then, if
+ * receive, the socket is polled, so that (when nothing arrived) no
+ * other libpq call is made, and any that did arrive are applied too.
+ */
+static bool
+Database_notified(Database *self, bool receive)
+{
+    if (!Database_listening(self))
+        return true;
+
+    // Those already received, which a poll would not see
+    if (!Database_notifies(self))
+        return false;
+
+    if (!receive)
+        return true;
+
+    struct pollfd fd;
+
+    fd.fd      = PQsocket(self->pg_conn);
+    fd.events  = POLLIN;
+    fd.revents = 0;
+
+    if (poll(&fd, 1, 0) <= 0)
+        return true;
+
+    PQconsumeInput(self->pg_conn);
+
+    return Database_notifies(self);
+}
+
+static inline Result *
+Database_execute(Database *self, const char *command, int n,
+                 const Oid *types, const char * const *values, const int *lengths, const int *formats)
+{
+    Result *result;
+
+    if (self->memory_budget != 0) {
+        result = Database_execute_stored(self, command, n, types, values, lengths, formats);
+    } else {
+        PGresult *pg_result = PQexecParams(self->pg_conn, command, n, types, values, lengths, formats, 1);
+
+        if (pg_result == NULL)
+            return NULL;
+
+        result = Result_new(pg_result);
+    }
+
+    // Results decode registered types as of their execution
+    if (self->registry != NULL && result != NULL && Result_check((PyObject *)result)) {
+        self->registry->retain();
+        result->options.registry = self->registry;
+    }
+
+    // Notifications arrive along with results, so look while libpq holds
+    // them; after an error, they wait for the next poll (not to replace it)
+    if (result != NULL && Database_listening(self) && !Database_notified(self, false)) {
+        Py_XDECREF(result);
+        return NULL;
+    }
+
+    return result;
+}
+
+/* Database_getset */
+
+static PyTypeObject *
+Database_ExecutionError(Database *self)
+{
+    PyTypeObject *cls = &ExecutionError_type;
+
+    if (!b::type::ensure_ready(cls))
+        return NULL;
+
+    Py_INCREF(cls);
+    return cls;
+}
+
+PyDoc_STRVAR(
+Database_host___doc__,
+"The server host name of the connection (or None)");
+
+static PyObject *
+Database_host(Database *self)
+{
+    PyObject *x = self->host;
+    if (x == NULL) {
+        char *bytes = PQhost(self->pg_conn);
+        if (bytes == NULL)
+            x = self->host = Py_None;
+        else
+            x = self->host = PyUnicode_FromString(bytes);
+    }
+    Py_INCREF(x);
+    return x;
+}
+
+PyDoc_STRVAR(
+Database_name___doc__,
+"The database name of the connection");
+
+static PyUnicodeObject *
+Database_name(Database *self)
+{
+    PyUnicodeObject *x = self->name;
+    if (x == NULL) {
+        x = self->name = (PyUnicodeObject *)PyUnicode_FromString(PQdb(self->pg_conn));
+        if (x == NULL)
+            return NULL;
+    }
+    Py_INCREF(x);
+    return x;
+}
+
+PyDoc_STRVAR(
+Database_user___doc__,
+"The user name of the connection");
+
+static PyUnicodeObject *
+Database_user(Database *self)
+{
+    PyUnicodeObject *x = self->user;
+    if (x == NULL) {
+        x = self->user = (PyUnicodeObject *)PyUnicode_FromString(PQuser(self->pg_conn));
+        if (x == NULL)
+            return NULL;
+    }
+    Py_INCREF(x);
+    return x;
+}
+
+static PyGetSetDef
+Database_getset[] = {
+    {(char *)"ExecutionError",  (getter)Database_ExecutionError,  NULL, NULL},
+    {(char *)"host",            (getter)Database_host,            NULL, Database_host___doc__},
+    {(char *)"name",            (getter)Database_name,            NULL, Database_name___doc__},
+    {(char *)"user",            (getter)Database_user,            NULL, Database_user___doc__},
+    {NULL}
+};
+
+/* Methods */
+
+PyDoc_STRVAR(
+Database_cache___doc__,
+"cache(ttl=60.0, max_bytes=64MiB, channel=None)\n\n"
+"Enable (or reset) the cache used by cached(): Results are kept for ttl\n"
+"seconds, least recently used first evicted past max_bytes. If channel is\n"
+"given, it is LISTENed to, and a NOTIFY on it invalidates the entries\n"
+"cached with its payload as tag (or all entries, if the payload is empty).");
+
+static PyObject *
+Database_cache(Database *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *keywords[] = {"ttl", "max_bytes", "channel", NULL};
+
+    double      ttl       = 60.0;
+    Py_ssize_t  max_bytes = 64 << 20;
+    const char *channel   = NULL;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|dnz:cache", (char **)keywords,
+                                     &ttl, &max_bytes, &channel))
+        return NULL;
+
+    if (!(ttl > 0) || max_bytes <= 0) {
+        PyErr_SetString(PyExc_ValueError, "ttl and max_bytes must be positive");
+        return NULL;
+    }
+
+    postgresql::cache::Cache *cache = new (std::nothrow) postgresql::cache::Cache(ttl, (size_t)max_bytes);
+    if (cache == NULL)
+        return PyErr_NoMemory();
+
+    if (channel != NULL) {
+        char *identifier = PQescapeIdentifier(self->pg_conn, channel, strlen(channel));
+
+        if (identifier == NULL || (cache->channel = strdup(channel)) == NULL) {
+            PQfreemem(identifier);
+            delete cache;
+            return PyErr_NoMemory();
+        }
+
+        PyObject *command = PyUnicode_FromFormat("LISTEN %s", identifier);
+        PQfreemem(identifier);
+
+        if (command == NULL) {
+            delete cache;
+            return NULL;
+        }
+
+        PGresult *pg_result = PQexec(self->pg_conn, PyUnicode_AsUTF8(command));
+        Py_DECREF(command);
+
+        if (PQresultStatus(pg_result) != PGRES_COMMAND_OK) {
+            ExecutionError_set(pg_result);
+            delete cache;
+            return NULL;
+        }
+
+        PQclear(pg_result);
+    }
+
+    // Only once listening on the new channel, so that a failure keeps
+    // the old cache as it was
+    const char *previous = self->cache != NULL ? self->cache->channel : NULL;
+
+    if (previous != NULL && (channel == NULL || strcmp(channel, previous) != 0)) {
+        char *identifier = PQescapeIdentifier(self->pg_conn, previous, strlen(previous));
+
+        if (identifier != NULL) {
+            PyObject *command = PyUnicode_FromFormat("UNLISTEN %s", identifier);
+            PQfreemem(identifier);
+
+            if (command != NULL)
+                PQclear(PQexec(self->pg_conn, PyUnicode_AsUTF8(command)));
+            Py_XDECREF(command);
+        }
+    }
+
+    delete self->cache;
+    self->cache = cache;
+
+    Py_RETURN_NONE;
+}
+
+PyDoc_STRVAR(
+Database_cache_stats___doc__,
+"cache_stats() -> dict of counters of the cache");
+
+static PyObject *
+Database_cache_stats(Database *self)
+{
+    postgresql::cache::Cache *cache = self->cache;
+
+    if (cache == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "cache not enabled");
+        return NULL;
+    }
+
+    return Py_BuildValue("{s:n,s:n,s:n,s:n,s:n,s:n,s:n}",
+                         "hits",          cache->hits,
+                         "misses",        cache->misses,
+                         "evictions",     cache->evictions,
+                         "expirations",   cache->expirations,
+                         "invalidations", cache->invalidations,
+                         "entries",       (Py_ssize_t)cache->size(),
+                         "bytes",         (Py_ssize_t)cache->bytes);
+}
+
+PyDoc_STRVAR(
+Database_cached___doc__,
+"cached(command, *parameters, tag=None) -> Result\n\n"
+"As calling the Database, but through the cache (see cache()),\n"
+"keyed on the command and its encoded parameters.");
+
+static Result *
+Database_cached(Database *self, PyObject *args, PyObject *kwargs)
+{
+    postgresql::cache::Cache *cache = self->cache;
+
+    if (cache == NULL) {
+        PyErr_SetString(PyExc_RuntimeError, "cache not enabled");
+        return NULL;
+    }
+
+    PyObject *tag = NULL;
+
+    if (kwargs != NULL) {
+        static b::Identifier id_tag("tag");
+
+        if ((tag = id_tag.get((PyDictObject *)kwargs)) == NULL && PyErr_Occurred())
+            return NULL;
+
+        if (PyDict_GET_SIZE(kwargs) != (tag != NULL)) {
+            PyErr_SetString(PyExc_TypeError, "cached() only takes the keyword argument 'tag'");
+            return NULL;
+        }
+
+        if (tag == Py_None)
+            tag = NULL;
+
+        if (tag != NULL && !PyUnicode_Check(tag)) {
+            PyErr_Format(PyExc_TypeError, "expecting string, got: tag=%R", tag);
+            return NULL;
+        }
+    }
+
+    Py_ssize_t n = PyTuple_GET_SIZE(args);
+    if (n == 0) {
+        PyErr_SetString(PyExc_TypeError, "expecting at least 1 positional argument");
+        return NULL;
+    }
+
+    PyObject *o = PyTuple_GET_ITEM(args, 0);
+    if (!PyUnicode_Check(o)) {
+        PyErr_Format(PyExc_TypeError, "command must be a string, got: %R", o);
+        return NULL;
+    }
+
+    const char *command = PyUnicode_AsUTF8(o);
+    if (command == NULL)
+        return NULL;
+
+    postgresql::parameters::Dynamic pn(n - 1);
+    pn.registry = self->registry;
+
+    if (pn.types == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    for (Py_ssize_t i = 1; i < n; i++) {
+        if (!pn.append(PyTuple_GET_ITEM(args, i)))
+            return NULL;
+    }
+
+    if (!Database_notified(self, true))
+        return NULL;
+
+    size_t length;
+    char  *key = postgresql::cache::key(command, n - 1, pn.types, pn.values, pn.lengths, pn.formats, &length);
+    if (key == NULL) {
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    Result *result = (Result *)cache->get(key, length);
+    if (result != NULL) {
+        free(key);
+        return result;
+    }
+
+    result = Database_execute(self, command, n - 1, pn.types, pn.values, pn.lengths, pn.formats);
+
+    // Only Results are cached (not command statuses, nor errors); as a
+    // cache, running out of memory for an entry is not an error
+    if (result != NULL && Result_check((PyObject *)result)) {
+        size_t size = result->store != NULL ? result->store->size() : PQresultMemorySize(result->pg_result);
+
+        if (self->cache == cache)
+            cache->put(key, length, (PyObject *)result, tag, size);
+        else
+            free(key);
+    } else {
+        free(key);
+    }
+
+    return result;
+}
+
+/**
+ * The quoted SQL name of a table: a str, or a (schema, table) tuple.
+ */
+static PyObject *
+Database_quote(Database *self, PyObject *name)
+{
+    PyObject *parts[2] = {NULL, name};
+    int       n        = 1;
+
+    if (PyTuple_Check(name)) {
+        if (PyTuple_GET_SIZE(name) != 2) {
+            PyErr_Format(PyExc_ValueError, "expecting a (schema, table) name, got: %R", name);
+            return NULL;
+        }
+
+        parts[0] = PyTuple_GET_ITEM(name, 0);
+        parts[1] = PyTuple_GET_ITEM(name, 1);
+        n = 2;
+    }
+
+    PyObject *quoted = PyUnicode_FromString("");
+
+    for (int i = 2 - n; i < 2 && quoted != NULL; i++) {
+        Py_ssize_t  length;
+        const char *utf8;
+
+        if (!PyUnicode_Check(parts[i])) {
+            PyErr_Format(PyExc_TypeError, "expecting a str table name, got: %R", parts[i]);
+            Py_CLEAR(quoted);
+            break;
+        }
+
+        if ((utf8 = PyUnicode_AsUTF8AndSize(parts[i], &length)) == NULL) {
+            Py_CLEAR(quoted);
+            break;
+        }
+
+        char *identifier = PQescapeIdentifier(self->pg_conn, utf8, length);
+        if (identifier == NULL) {
+            PyErr_SetString(PyExc_ValueError, PQerrorMessage(self->pg_conn));
+            Py_CLEAR(quoted);
+            break;
+        }
+
+        PyObject *joined = PyUnicode_FromFormat(i == 0 ? "%U%s." : "%U%s", quoted, identifier);
+        PQfreemem(identifier);
+
+        Py_DECREF(quoted);
+        quoted = joined;
+    }
+
+    return quoted;
+}
+
+PyDoc_STRVAR(
+Database_copy_from_file___doc__,
+"copy_from_file(table, file, format='csv', header=False) -> number of rows\n\n"
+"COPY a file (a path, or an open file descriptor) into table, as is.\n"
+"table is a name (quoted as an identifier, so case-sensitive) or a\n"
+"(schema, table) tuple.\n"
+"format is one of 'csv', 'text' or 'binary'; the server does all parsing.");
+
+static PyObject *
+Database_copy_from_file(Database *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *keywords[] = {"table", "file", "format", "header", NULL};
+
+    PyObject   *table;
+    PyObject   *file;
+    const char *format = "csv";
+    int         header = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "OO|sp:copy_from_file", (char **)keywords,
+                                     &table, &file, &format, &header))
+        return NULL;
+
+    if (strcmp(format, "csv") != 0 && strcmp(format, "text") != 0 && strcmp(format, "binary") != 0) {
+        PyErr_Format(PyExc_ValueError, "format must be 'csv', 'text' or 'binary', got: '%s'", format);
+        return NULL;
+    }
+
+    if (header && strcmp(format, "csv") != 0) {
+        PyErr_SetString(PyExc_ValueError, "header is only supported by format 'csv'");
+        return NULL;
+    }
+
+    PyObject *name = Database_quote(self, table);
+    if (name == NULL)
+        return NULL;
+
+    PyObject *command = PyUnicode_FromFormat("COPY %U FROM STDIN (FORMAT %s%s)",
+                                             name, format, header ? ", HEADER" : "");
+    Py_DECREF(name);
+    if (command == NULL)
+        return NULL;
+
+    PyObject *path  = NULL;
+    PyObject *count = NULL;
+    int       fd    = -1;
+
+    if (PyLong_Check(file)) {
+        if ((fd = _PyLong_AsInt(file)) == -1 && PyErr_Occurred())
+            goto done;
+    } else {
+        if (!PyUnicode_FSConverter(file, &path))
+            goto done;
+
+        {
+            b::gil::Release release;
+            fd = open(PyBytes_AS_STRING(path), O_RDONLY | O_CLOEXEC);
+        }
+
+        if (fd == -1) {
+            PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+            goto done;
+        }
+    }
+
+    {
+        const char *command_utf8 = PyUnicode_AsUTF8(command);
+        if (command_utf8 == NULL)
+            goto done;
+
+        PGconn   *pg_conn = self->pg_conn;
+        PGresult *pg_result;
+        int       error = 0;
+
+        {
+            b::gil::Release release;
+
+            pg_result = PQexec(pg_conn, command_utf8);
+
+            if (PQresultStatus(pg_result) == PGRES_COPY_IN) {
+                PQclear(pg_result);
+
+                error = postgresql::copy::from_fd(pg_conn, fd);
+
+                // The last result is that of the COPY
+                pg_result = NULL;
+
+                for (PGresult *next; (next = PQgetResult(pg_conn)) != NULL; ) {
+                    PQclear(pg_result);
+                    pg_result = next;
+                }
+            }
+        }
+
+        if (error != 0) {
+            PQclear(pg_result);
+            errno = error;
+            PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+        } else if (pg_result == NULL) {
+            PyErr_SetString(PyExc_OSError, PQerrorMessage(pg_conn));
+        } else if (PQresultStatus(pg_result) != PGRES_COMMAND_OK) {
+            ExecutionError_set(pg_result);
+        } else {
+            count = PyLong_FromLongLong(strtoll(PQcmdTuples(pg_result), NULL, 10));
+            PQclear(pg_result);
+        }
+    }
+
+  done:
+    if (path != NULL) {
+        if (fd != -1)
+            close(fd);
+        Py_DECREF(path);
+    }
+    Py_DECREF(command);
+    return count;
+}
+
+PyDoc_STRVAR(
+Database_export_csv___doc__,
+"export_csv(command, path, delimiter=',', null='', header=False) -> number of rows\n\n"
+"Execute a command and write its Result to path as CSV (see Result.write_csv).");
+
+static PyObject *
+Database_export_csv(Database *self, PyObject *args, PyObject *kwargs)
+{
+    static const char *keywords[] = {"command", "path", "delimiter", "null", "header", NULL};
+
+    PyObject *command;
+    PyObject *path;
+    PyObject *delimiter = NULL;
+    PyObject *null      = NULL;
+    int       header    = 0;
+
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "UO&|UUp:export_csv", (char **)keywords,
+                                     &command, PyUnicode_FSConverter, &path, &delimiter, &null, &header))
+        return NULL;
+
+    char c = ',';
+    PyObject *call   = NULL;
+    PyObject *empty  = NULL;
+    Result   *result = NULL;
+    PyObject *count  = NULL;
+
+    if (delimiter != NULL && !Result_csv_options(delimiter, &c))
+        goto done;
+
+    if (null == NULL && (null = empty = PyUnicode_FromStringAndSize("", 0)) == NULL)
+        goto done;
+
+    if ((call = PyTuple_Pack(1, command)) == NULL)
+        goto done;
+
+    if ((result = Database___call__(self, call, NULL)) == NULL)
+        goto done;
+
+    if (!Result_check((PyObject *)result)) {
+        PyErr_SetString(PyExc_TypeError, "command returned no rows");
+        goto done;
+    }
+
+    {
+        int fd;
+        {
+            b::gil::Release release;
+            fd = open(PyBytes_AS_STRING(path), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+        }
+
+        if (fd == -1) {
+            PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+            goto done;
+        }
+
+        Py_ssize_t written = Result_write_csv_to(result, fd, NULL, c, null, header);
+
+        if (close(fd) == -1 && written != -1) {
+            PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, path);
+            goto done;
+        }
+
+        if (written != -1)
+            count = PyLong_FromSsize_t(written);
+    }
+
+  done:
+    Py_XDECREF(result);
+    Py_XDECREF(call);
+    Py_XDECREF(empty);
+    Py_DECREF(path);
+    return count;
+}
+
+PyDoc_STRVAR(
+Database_invalidate___doc__,
+"invalidate(tag=None) -> number of cached Results removed\n\n"
+"Remove the cached Results stored with tag, or all of them.");
+
+static PyObject *
+Database_invalidate(Database *self, PyObject *args)
+{
+    PyObject *tag = Py_None;
+
+    if (!PyArg_ParseTuple(args, "|O:invalidate", &tag))
+        return NULL;
+
+    if (tag != Py_None && !PyUnicode_Check(tag)) {
+        PyErr_Format(PyExc_TypeError, "expecting string, got: %R", tag);
+        return NULL;
+    }
+
+    if (self->cache == NULL)
+        return PyLong_FromLong(0);
+
+    Py_ssize_t n = self->cache->invalidate(tag == Py_None ? NULL : tag);
+    if (n == -1)
+        return NULL;
+
+    return PyLong_FromSsize_t(n);
+}
+
+/**
+ * Resolve type, a name or an OID, through pg_type to its OID and the
+ * OID of its array type (0 if none).
+ */
+static bool
+Database_resolve(Database *self, PyObject *type, Oid *oid, Oid *array)
+{
+    const char *command;
+    PyObject   *text;
+
+    if (PyLong_Check(type)) {
+        command = "SELECT oid, typarray FROM pg_catalog.pg_type WHERE oid = $1::pg_catalog.oid";
+        text    = PyObject_Str(type);
+    } else if (PyUnicode_Check(type)) {
+        command = "SELECT oid, typarray FROM pg_catalog.pg_type WHERE oid = pg_catalog.to_regtype($1)";
+        text    = type;
+        Py_INCREF(text);
+    } else {
+        PyErr_Format(PyExc_TypeError, "expecting a type name or OID, got: %R", type);
+        return false;
+    }
+
+    if (text == NULL)
+        return false;
+
+    const char *value = PyUnicode_AsUTF8(text);
+    if (value == NULL) {
+        Py_DECREF(text);
+        return false;
+    }
+
+    PGresult *pg_result = PQexecParams(self->pg_conn, command, 1, NULL, &value, NULL, NULL, 1);
+    Py_DECREF(text);
+
+    if (PQresultStatus(pg_result) != PGRES_TUPLES_OK) {
+        ExecutionError_set(pg_result);
+        return false;
+    }
+
+    if (PQntuples(pg_result) != 1) {
+        PQclear(pg_result);
+        PyErr_Format(PyExc_ValueError, "unknown type: %R", type);
+        return false;
+    }
+
+    *oid   = postgresql::network::load<uint32_t>(PQgetvalue(pg_result, 0, 0));
+    *array = postgresql::network::load<uint32_t>(PQgetvalue(pg_result, 0, 1));
+
+    PQclear(pg_result);
+    return true;
+}
+
+/**
+ * The registry to register into: created if need be, and copied if
+ * Results share it, so that registering leaves them as they were.
+ */
+static postgresql::registry::Registry *
+Database_registry(Database *self)
+{
+    if (self->registry == NULL) {
+        if ((self->registry = new (std::nothrow) postgresql::registry::Registry()) == NULL)
+            PyErr_NoMemory();
+    } else if (self->registry->shared()) {
+        postgresql::registry::Registry *copy = self->registry->copy();
+        if (copy == NULL)
+            return NULL;
+
+        self->registry->release();
+        self->registry = copy;
+    }
+
+    return self->registry;
+}
+
+PyDoc_STRVAR(
+Database_register_decoder___doc__,
+"register_decoder(type, decode) -> int\n\n"
+"Decode values of type (a name, resolved through pg_type, or an OID), and\n"
+"arrays of them, with decode: either a callable, called with a read-only\n"
+"memoryview of each value's binary representation (valid only during the\n"
+"call), or the name or OID of a natively decoded type to decode them as,\n"
+"e.g. 'text' for enums and citext. Types decoded natively are unaffected.\n"
+"Applies to Results of commands executed from then on; returns the OID.");
+
+static PyObject *
+Database_register_decoder(Database *self, PyObject *args)
+{
+    PyObject *type;
+    PyObject *decode;
+
+    if (!PyArg_ParseTuple(args, "OO:register_decoder", &type, &decode))
+        return NULL;
+
+    Oid oid, array;
+    Oid as = 0;
+
+    if (!Database_resolve(self, type, &oid, &array))
+        return NULL;
+
+    if (PyUnicode_Check(decode) || PyLong_Check(decode)) {
+        Oid unused;
+        if (!Database_resolve(self, decode, &as, &unused))
+            return NULL;
+    } else if (!PyCallable_Check(decode)) {
+        PyErr_Format(PyExc_TypeError, "expecting a callable, type name or OID, got: %R", decode);
+        return NULL;
+    }
+
+    postgresql::registry::Registry *registry = Database_registry(self);
+    if (registry == NULL)
+        return NULL;
+
+    if (as != 0) {
+        if (!registry->decode(oid, postgresql::registry::Decoder::NATIVE, as, NULL))
+            return NULL;
+    } else {
+        if (!registry->decode(oid, postgresql::registry::Decoder::FUNCTION, 0, decode))
+            return NULL;
+    }
+
+    if (array != 0 && !registry->decode(array, postgresql::registry::Decoder::ARRAY, 0, NULL))
+        return NULL;
+
+    return PyLong_FromUnsignedLong(oid);
+}
 
-            keywords[i++] = (char *)id_user.ascii;
-        }
-    }
+PyDoc_STRVAR(
+Database_register_encoder___doc__,
+"register_encoder(cls, type, encode) -> int\n\n"
+"Send instances of cls (or of its subclasses) as parameters of type (a name,\n"
+"resolved through pg_type, or an OID), encoded by calling encode with each:\n"
+"bytes it returns are sent as the binary representation, str as text for\n"
+"the server to parse. Types encoded natively are unaffected. Returns the OID.");
 
-    keywords[i] = NULL;
-    values  [i] = NULL;
+static PyObject *
+Database_register_encoder(Database *self, PyObject *args)
+{
+    PyTypeObject *cls;
+    PyObject     *type;
+    PyObject     *encode;
 
-    pg_conn = PQconnectdbParams((const char **)keywords, (const char **)values, 0);
+    if (!PyArg_ParseTuple(args, "O!OO:register_encoder", &PyType_Type, &cls, &type, &encode))
+        return NULL;
 
-    if (PQstatus(pg_conn) != CONNECTION_OK) {
-        ConnectionError_set(pg_conn);
-        return -1;
+    if (!PyCallable_Check(encode)) {
+        PyErr_Format(PyExc_TypeError, "expecting a callable, got: %R", encode);
+        return NULL;
     }
 
-    // Re-initialized?
-    if (self->pg_conn != NULL) {
-        PQfinish(self->pg_conn);
-    }
+    Oid oid, array;
 
-    self->pg_conn = pg_conn;
+    if (!Database_resolve(self, type, &oid, &array))
+        return NULL;
 
-    return 0;
+    postgresql::registry::Registry *registry = Database_registry(self);
+    if (registry == NULL || !registry->encode(cls, oid, encode))
+        return NULL;
+
+    return PyLong_FromUnsignedLong(oid);
 }
 
-static void
-Database___del__(Database *self)
+/**
+ * Register the composite, domain, enum and range types of schema (and
+ * arrays of them) for decoding, unless registered explicitly.
+ */
+static bool
+Database_register_schema(Database *self, const postgresql::catalog::Schema *schema)
 {
-    Py_XDECREF(self->host);
-    Py_XDECREF(self->name);
-    Py_XDECREF(self->user);
+    if (schema->types.empty())
+        return true;
 
-    if (self->pg_conn != NULL)
-        PQfinish(self->pg_conn);
+    postgresql::registry::Registry *registry = Database_registry(self);
+    if (registry == NULL)
+        return false;
 
-    Py_TYPE(self)->tp_free((PyObject *)self);
-}
+    for (size_t i = 0; i < schema->types.size(); i++) {
+        const postgresql::catalog::Type &type = schema->types[i];
 
-/* Database_getset */
+        postgresql::registry::Decoder *decoder = registry->decoder(type.oid);
+        if (decoder != NULL && !decoder->cataloged)
+            continue;
 
-static PyTypeObject *
-Database_ExecutionError(Database *self)
-{
-    PyTypeObject *cls = &ExecutionError_type;
+        bool registered = true;
 
-    if (!b::type::ensure_ready(cls))
-        return NULL;
+        switch (type.kind) {
+          case 'c': registered = registry->decode(type.oid, postgresql::registry::Decoder::RECORD, 0,                      NULL, true); break;
+          case 'd': registered = registry->decode(type.oid, postgresql::registry::Decoder::NATIVE, type.base,              NULL, true); break;
+          case 'e': registered = registry->decode(type.oid, postgresql::registry::Decoder::NATIVE, postgresql::TEXT::OID, NULL, true); break;
+          case 'r': registered = registry->decode(type.oid, postgresql::registry::Decoder::RANGE,  type.base,              NULL, true); break;
+        }
 
-    Py_INCREF(cls);
-    return cls;
-}
+        if (registered && type.array != 0)
+            registered = registry->decode(type.array, postgresql::registry::Decoder::ARRAY, 0, NULL, true);
 
-PyDoc_STRVAR(
-Database_host___doc__,
-"The server host name of the connection (or None)");
+        if (!registered)
+            return false;
+    }
 
-static PyObject *
-Database_host(Database *self)
+    return true;
+}
+
+/**
+ * The schema of name (a str), loading it in one query (and registering
+ * its types) unless already loaded. Valid until invalidated.
+ */
+static const postgresql::catalog::Schema *
+Database_catalog_schema(Database *self, PyObject *name)
 {
-    PyObject *x = self->host;
-    if (x == NULL) {
-        char *bytes = PQhost(self->pg_conn);
-        if (bytes == NULL)
-            x = self->host = Py_None;
-        else
-            x = self->host = PyUnicode_FromString(bytes);
+    // Notified invalidations first
+    if (!Database_notified(self, true))
+        return NULL;
+
+    const char *value = PyUnicode_AsUTF8(name);
+    if (value == NULL)
+        return NULL;
+
+    if (self->catalog == NULL && (self->catalog = new (std::nothrow) postgresql::catalog::Catalog()) == NULL) {
+        PyErr_NoMemory();
+        return NULL;
     }
-    Py_INCREF(x);
-    return x;
-}
 
-PyDoc_STRVAR(
-Database_name___doc__,
-"The database name of the connection");
+    postgresql::catalog::Schema *schema = self->catalog->get(value);
+    if (schema != NULL)
+        return schema;
 
-static PyUnicodeObject *
-Database_name(Database *self)
-{
-    PyUnicodeObject *x = self->name;
-    if (x == NULL) {
-        x = self->name = (PyUnicodeObject *)PyUnicode_FromString(PQdb(self->pg_conn));
-        if (x == NULL)
-            return NULL;
+    PGresult *pg_result = PQexecParams(self->pg_conn, postgresql::catalog::QUERY, 1, NULL, &value, NULL, NULL, 1);
+
+    if (PQresultStatus(pg_result) != PGRES_TUPLES_OK) {
+        ExecutionError_set(pg_result);
+        return NULL;
     }
-    Py_INCREF(x);
-    return x;
-}
 
-PyDoc_STRVAR(
-Database_user___doc__,
-"The user name of the connection");
+    if ((schema = new (std::nothrow) postgresql::catalog::Schema()) == NULL) {
+        PQclear(pg_result);
+        PyErr_NoMemory();
+        return NULL;
+    }
 
-static PyUnicodeObject *
-Database_user(Database *self)
-{
-    PyUnicodeObject *x = self->user;
-    if (x == NULL) {
-        x = self->user = (PyUnicodeObject *)PyUnicode_FromString(PQuser(self->pg_conn));
-        if (x == NULL)
-            return NULL;
+    schema->name = value;
+
+    bool loaded = postgresql::catalog::load(pg_result, schema);
+    PQclear(pg_result);
+
+    if (!loaded) {
+        delete schema;
+        PyErr_SetString(PyExc_ValueError, "unexpected rows from pg_catalog");
+        return NULL;
     }
-    Py_INCREF(x);
-    return x;
-}
 
-static PyGetSetDef
-Database_getset[] = {
-    {(char *)"ExecutionError",  (getter)Database_ExecutionError,  NULL, NULL},
-    {(char *)"host",            (getter)Database_host,            NULL, Database_host___doc__},
-    {(char *)"name",            (getter)Database_name,            NULL, Database_name___doc__},
-    {(char *)"user",            (getter)Database_user,            NULL, Database_user___doc__},
-    {NULL}
-};
+    if (schema->oid == 0) {
+        delete schema;
+        PyErr_Format(PyExc_ValueError, "unknown schema: %R", name);
+        return NULL;
+    }
 
-/* Methods */
+    if (!Database_register_schema(self, schema)) {
+        delete schema;
+        return NULL;
+    }
+
+    self->catalog->put(schema);
+    return schema;
+}
 
 PyDoc_STRVAR(
 Database_schema___doc__,
-"Return a named Schema...");
+"schema(name) -> Schema\n\n"
+"Return the named Schema, loading its tables, columns and types from\n"
+"pg_catalog unless already loaded. Its composite, domain, enum and range\n"
+"types are registered for decoding (unless registered explicitly).");
 
 static Schema *
 Database_schema(Database *self, PyObject *name)
@@ -1083,8 +4518,8 @@ Database_schema(Database *self, PyObject *name)
         return NULL;
     }
 
-    TODO();
-    return NULL;
+    if (Database_catalog_schema(self, name) == NULL)
+        return NULL;
 
     if (!b::type::ensure_ready(&Schema_type))
         return NULL;
@@ -1094,12 +4529,80 @@ Database_schema(Database *self, PyObject *name)
         return NULL;
 
     Py_INCREF(self);
+    Py_INCREF(name);
 
     schema->database = self;
+    schema->name     = name;
 
     return schema;
 }
 
+PyDoc_STRVAR(
+Database_schemas_channel___doc__,
+"schemas_channel(channel)\n\n"
+"LISTEN to channel, on which a NOTIFY invalidates the loaded schema named\n"
+"by its payload (or all of them, if the payload is empty); None stops.\n"
+"E.g. with an event trigger on ddl_command_end running:\n\n"
+"  PERFORM pg_notify(channel, schema_name)\n"
+"    FROM pg_event_trigger_ddl_commands();");
+
+static PyObject *
+Database_schemas_channel(Database *self, PyObject *args)
+{
+    const char *channel;
+
+    if (!PyArg_ParseTuple(args, "z:schemas_channel", &channel))
+        return NULL;
+
+    if (self->catalog == NULL && (self->catalog = new (std::nothrow) postgresql::catalog::Catalog()) == NULL)
+        return PyErr_NoMemory();
+
+    postgresql::catalog::Catalog *catalog = self->catalog;
+
+    if (catalog->channel != NULL) {
+        char *identifier = PQescapeIdentifier(self->pg_conn, catalog->channel, strlen(catalog->channel));
+
+        if (identifier != NULL) {
+            PyObject *command = PyUnicode_FromFormat("UNLISTEN %s", identifier);
+            PQfreemem(identifier);
+
+            if (command != NULL)
+                PQclear(PQexec(self->pg_conn, PyUnicode_AsUTF8(command)));
+            Py_XDECREF(command);
+        }
+
+        free(catalog->channel);
+        catalog->channel = NULL;
+    }
+
+    if (channel != NULL) {
+        char *identifier = PQescapeIdentifier(self->pg_conn, channel, strlen(channel));
+        if (identifier == NULL)
+            return PyErr_NoMemory();
+
+        PyObject *command = PyUnicode_FromFormat("LISTEN %s", identifier);
+        PQfreemem(identifier);
+
+        if (command == NULL)
+            return NULL;
+
+        PGresult *pg_result = PQexec(self->pg_conn, PyUnicode_AsUTF8(command));
+        Py_DECREF(command);
+
+        if (PQresultStatus(pg_result) != PGRES_COMMAND_OK) {
+            ExecutionError_set(pg_result);
+            return NULL;
+        }
+
+        PQclear(pg_result);
+
+        if ((catalog->channel = strdup(channel)) == NULL)
+            return PyErr_NoMemory();
+    }
+
+    Py_RETURN_NONE;
+}
+
 PyDoc_STRVAR(
 Database_transaction___doc__,
 "Return a new Transaction for this Database.");
@@ -1123,8 +4626,17 @@ Database_transaction(Database *self)
 
 static PyMethodDef
 Database_methods[] = {
-    {"schema",      (PyCFunction)Database_schema,      METH_O,       Database_schema___doc__},
-    {"transaction", (PyCFunction)Database_transaction, METH_NOARGS,  Database_transaction___doc__},
+    {"cache",            (PyCFunction)Database_cache,            METH_VARARGS | METH_KEYWORDS, Database_cache___doc__},
+    {"cache_stats",      (PyCFunction)Database_cache_stats,      METH_NOARGS,                  Database_cache_stats___doc__},
+    {"cached",           (PyCFunction)Database_cached,           METH_VARARGS | METH_KEYWORDS, Database_cached___doc__},
+    {"copy_from_file",   (PyCFunction)Database_copy_from_file,   METH_VARARGS | METH_KEYWORDS, Database_copy_from_file___doc__},
+    {"export_csv",       (PyCFunction)Database_export_csv,       METH_VARARGS | METH_KEYWORDS, Database_export_csv___doc__},
+    {"invalidate",       (PyCFunction)Database_invalidate,       METH_VARARGS,                 Database_invalidate___doc__},
+    {"register_decoder", (PyCFunction)Database_register_decoder, METH_VARARGS,                 Database_register_decoder___doc__},
+    {"register_encoder", (PyCFunction)Database_register_encoder, METH_VARARGS,                 Database_register_encoder___doc__},
+    {"schema",           (PyCFunction)Database_schema,           METH_O,                       Database_schema___doc__},
+    {"schemas_channel",  (PyCFunction)Database_schemas_channel,  METH_VARARGS,                 Database_schemas_channel___doc__},
+    {"transaction",      (PyCFunction)Database_transaction,      METH_NOARGS,                  Database_transaction___doc__},
     {NULL}
 };
 
@@ -1160,57 +4672,28 @@ Database___call__(Database *self, PyObject *args, PyObject *kwargs)
         return NULL;
     }
 
-    PGresult *pg_result;
-    if (n == 1) {
-        pg_result = PQexecParams(
-            self->pg_conn,
-            command,
-            0,
-            NULL,
-            NULL,
-            NULL,
-            NULL,
-            1);
-
-    } else if (n == 2) {
+    if (n == 1)
+        return Database_execute(self, command, 0, NULL, NULL, NULL, NULL);
+
+    if (n == 2) {
         postgresql::parameters::Static<1> p1;
+        p1.registry = self->registry;
 
         if (!p1.append(PyTuple_GET_ITEM(args, 1)))
               return NULL;
 
-        pg_result = PQexecParams(
-            self->pg_conn,
-            command,
-            1,
-            p1.types,
-            p1.values,
-            p1.lengths,
-            p1.formats,
-            1);
-
-    } else {
-        postgresql::parameters::Dynamic pn(n - 1);
+        return Database_execute(self, command, 1, p1.types, p1.values, p1.lengths, p1.formats);
+    }
 
-        for (Py_ssize_t i = 1; i < n; i++) {
-            if (!pn.append(PyTuple_GET_ITEM(args, i)))
-                return NULL;
-        }
+    postgresql::parameters::Dynamic pn(n - 1);
+    pn.registry = self->registry;
 
-        pg_result = PQexecParams(
-            self->pg_conn,
-            command,
-            n - 1,
-            pn.types,
-            pn.values,
-            pn.lengths,
-            pn.formats,
-            1);
+    for (Py_ssize_t i = 1; i < n; i++) {
+        if (!pn.append(PyTuple_GET_ITEM(args, i)))
+            return NULL;
     }
 
-    if (pg_result == NULL)
-        return NULL;
-
-    return Result_new(pg_result);
+    return Database_execute(self, command, n - 1, pn.types, pn.values, pn.lengths, pn.formats);
 }
 
 /* Database_type */
@@ -1260,6 +4743,170 @@ Database_type = {
 
 /* module */
 
+PyDoc_STRVAR(
+module_attach___doc__,
+"attach(name) -> Result\n\n"
+"Map a Result shared (by Result.share()) under name, read-only.");
+
+static Result *
+module_attach(PyObject *module, PyObject *name)
+{
+    if (!PyUnicode_Check(name)) {
+        PyErr_Format(PyExc_TypeError, "expecting string, got: %R", name);
+        return NULL;
+    }
+
+    const char *path = PyUnicode_AsUTF8(name);
+    if (path == NULL)
+        return NULL;
+
+    int fd = shm_open(path, O_RDONLY, 0);
+    if (fd == -1) {
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, name);
+        return NULL;
+    }
+
+    struct stat st;
+    void       *data = MAP_FAILED;
+
+    if (fstat(fd, &st) == 0) {
+        if (st.st_size == 0) {
+            close(fd);
+            PyErr_Format(PyExc_ValueError, "not a shared Result: %R", name);
+            return NULL;
+        }
+
+        data = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+
+    int error = errno;
+    close(fd);
+
+    if (data == MAP_FAILED) {
+        errno = error;
+        PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, name);
+        return NULL;
+    }
+
+    bool valid;
+    {
+        b::gil::Release release;
+        valid = postgresql::store::Store::valid((const char *)data, (size_t)st.st_size);
+    }
+
+    if (!valid) {
+        munmap(data, (size_t)st.st_size);
+        PyErr_Format(PyExc_ValueError, "not a shared Result: %R", name);
+        return NULL;
+    }
+
+    postgresql::store::Store *store = new (std::nothrow) postgresql::store::Store(
+        (const char *)data, (size_t)st.st_size, postgresql::store::Store::MAPPED);
+
+    if (store == NULL) {
+        munmap(data, (size_t)st.st_size);
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    return Result_from_store(store);
+}
+
+PyDoc_STRVAR(
+module_loads___doc__,
+"loads(buffer) -> Result\n\n"
+"Load a Result serialized by Result.dumps(), decoding its values lazily.");
+
+static Result *
+module_loads(PyObject *module, PyObject *buffer)
+{
+    Py_buffer view;
+
+    if (PyObject_GetBuffer(buffer, &view, PyBUF_SIMPLE) == -1)
+        return NULL;
+
+    const char *data = (const char *)view.buf;
+    size_t      size = (size_t)view.len;
+
+    // Immutable and aligned bytes are used in place, all else copied
+    bool  borrow = PyBytes_CheckExact(buffer) && (uintptr_t)data % postgresql::store::ALIGNMENT == 0;
+    char *copy   = NULL;
+
+    if (!borrow) {
+        if ((copy = (char *)malloc(size > 0 ? size : 1)) == NULL) {
+            PyBuffer_Release(&view);
+            PyErr_NoMemory();
+            return NULL;
+        }
+
+        memcpy(copy, data, size);
+        data = copy;
+    }
+
+    PyBuffer_Release(&view);
+
+    bool valid;
+    {
+        b::gil::Release release(size >= (1 << 20));
+        valid = postgresql::store::Store::valid(data, size);
+    }
+
+    if (!valid) {
+        free(copy);
+        PyErr_SetString(PyExc_ValueError, "not a dumped Result");
+        return NULL;
+    }
+
+    postgresql::store::Store *store = new (std::nothrow) postgresql::store::Store(
+        data, size, borrow ? postgresql::store::Store::BORROWED : postgresql::store::Store::MALLOC);
+
+    if (store == NULL) {
+        free(copy);
+        PyErr_NoMemory();
+        return NULL;
+    }
+
+    Result *result = Result_from_store(store);
+
+    if (result != NULL && borrow) {
+        Py_INCREF(buffer);
+        result->owner = buffer;
+    }
+
+    return result;
+}
+
+PyDoc_STRVAR(
+module_unshare___doc__,
+"unshare(name)\n\n"
+"Remove a segment made by Result.share(); attached Results remain usable.");
+
+static PyObject *
+module_unshare(PyObject *module, PyObject *name)
+{
+    if (!PyUnicode_Check(name)) {
+        PyErr_Format(PyExc_TypeError, "expecting string, got: %R", name);
+        return NULL;
+    }
+
+    const char *path = PyUnicode_AsUTF8(name);
+    if (path == NULL)
+        return NULL;
+
+    if (shm_unlink(path) == -1)
+        return PyErr_SetFromErrnoWithFilenameObject(PyExc_OSError, name);
+
+    Py_RETURN_NONE;
+}
+
+static PyMethodDef
+module_methods[] = {
+    {"attach",  (PyCFunction)module_attach,  METH_O, module_attach___doc__},
+    {"loads",   (PyCFunction)module_loads,   METH_O, module_loads___doc__},
+    {"unshare", (PyCFunction)module_unshare, METH_O, module_unshare___doc__},
+    {NULL}
+};
+
 PyDoc_STRVAR(
 module___doc__,
 "A Python PostgreSQL front end");
@@ -1270,6 +4917,7 @@ module_definition = {
     "postgresql",
     module___doc__,
     -1,
+    module_methods,
 };
 
 PyMODINIT_FUNC
@@ -1279,6 +4927,9 @@ PyInit_postgresql(void)
         !b::type::ensure_ready(&ConnectionError_type))
         return NULL;
 
+    if (!postgresql::datetime::import())
+        return NULL;
+
     PyObject *module = PyModule_Create(&module_definition);
     if (module == NULL)
         return NULL;
@@ -1286,5 +4937,17 @@ PyInit_postgresql(void)
     PyModule_AddObject(module, "ConnectionError", (PyObject *)&ConnectionError_type);
     PyModule_AddObject(module, "Database",        (PyObject *)&Database_type);
 
+    if (!b::type::ensure_ready(&Json_type))
+        return NULL;
+
+    PyModule_AddObject(module, "Json",            (PyObject *)&Json_type);
+
+    PyTypeObject *range = postgresql::RANGE::type();
+    if (range == NULL)
+        return NULL;
+
+    Py_INCREF(range);
+    PyModule_AddObject(module, "Range",           (PyObject *)range);
+
     return module;
 };
@@ -1,7 +1,23 @@
+import array
+import csv
+import datetime
+import decimal
+import io
+import ipaddress
+import json
+import struct
+import tempfile
 import unittest
+import uuid
 
+import postgresql
 from postgresql import Database
 
+try:
+    import pyarrow
+except ImportError:
+    pyarrow = None
+
 NAME = 'test_postgresql'
 
 class DatabaseTests(unittest.TestCase):
@@ -100,6 +116,32 @@ class DatabaseTests(unittest.TestCase):
         for row in result:
             self.assertIn(row[0], STRINGS)
 
+    def test_text_unicode(self):
+        db = Database(name=NAME)
+
+        # Each str kind, short and past a SIMD block
+        STRINGS = ('café', 'Ā and Ω', '数据库', 'ok 😀', 'x' * 40 + 'é' * 40 + '😀' * 40)
+
+        result = db('SELECT $1::TEXT, $2::TEXT, $3::TEXT, $4::TEXT, $5::TEXT', *STRINGS)
+
+        self.assertEqual(tuple(result[0][j] for j in range(len(STRINGS))), STRINGS)
+        self.assertEqual([column[0] for column in result.columns()], list(STRINGS))
+
+    def test_texts_shared(self):
+        db = Database(name=NAME)
+
+        result = db("SELECT (ARRAY['on', 'off'])[1 + i % 2], i::TEXT FROM generate_series(1, 10000) AS i")
+        shared = result.decoding(texts='shared')
+
+        self.assertIs(shared[0][0], shared[2][0])
+        self.assertEqual(shared[0][0], result[0][0])
+
+        columns = shared.columns()
+        self.assertEqual(len(set(map(id, columns[0]))), 2)
+
+        # Distinct values turn it off, not sharing them all
+        self.assertEqual(columns[1], result.columns()[1])
+
     def test_int2(self):
         db = Database(name=NAME)
         db('CREATE TABLE test_int2 ('
@@ -282,3 +324,609 @@ class DatabaseTests(unittest.TestCase):
         d[row1] = True
 
         self.assertIn(d, row2)
+
+    def test_result_slice(self):
+        db = Database(name=NAME)
+        db('CREATE TABLE test_result_slice ('
+           ' x INT4'
+           ');')
+
+        for x in range(10):
+            db('INSERT INTO test_result_slice VALUES ($1)', x)
+
+        result = db('SELECT * FROM test_result_slice ORDER BY x')
+
+        self.assertEqual(result[-1][0], 9)
+
+        view = result[2:8:2]
+
+        self.assertEqual(len(view), 3)
+        self.assertEqual([row[0] for row in view], [2, 4, 6])
+
+        # Views of views
+        self.assertEqual([row[0] for row in view[::-1]], [6, 4, 2])
+        self.assertEqual(len(result[5:2]), 0)
+
+        with self.assertRaises(IndexError):
+            result[10]
+
+    def test_result_select(self):
+        db = Database(name=NAME)
+        db('CREATE TABLE test_result_select ('
+           ' a INT4,'
+           ' b TEXT,'
+           ' c INT8'
+           ');')
+
+        db('INSERT INTO test_result_select VALUES ($1,$2,$3)', 1, 'one', 2**40)
+
+        result = db('SELECT * FROM test_result_select')
+
+        view = result.select(['c', 0])
+
+        self.assertEqual(len(view[0]), 2)
+        self.assertEqual(view[0][0], 2**40)
+        self.assertEqual(view[0][1], 1)
+
+        self.assertEqual(view.select([-1])[0][0], 1)
+
+        with self.assertRaises(KeyError):
+            result.select(['d'])
+
+        with self.assertRaises(IndexError):
+            view[0][2]
+
+    def test_aggregate(self):
+        db = Database(name=NAME)
+        db('CREATE TABLE test_aggregate ('
+           ' x INT4,'
+           ' y INT8'
+           ');')
+
+        for x in range(10):
+            db('INSERT INTO test_aggregate VALUES ($1,$2)', x, 2**62)
+        db('INSERT INTO test_aggregate (y) VALUES ($1)', 1)
+
+        result = db('SELECT * FROM test_aggregate')
+
+        self.assertEqual(result.aggregate('x', 'count'), 10)
+        self.assertEqual(result.aggregate('x', 'sum'), 45)
+        self.assertEqual(result.aggregate('x', 'min'), 0)
+        self.assertEqual(result.aggregate('x', 'max'), 9)
+
+        # Wider than the column type
+        self.assertEqual(result.aggregate('y', 'sum'), 10 * 2**62 + 1)
+
+        self.assertIs(result[:0].aggregate('x', 'sum'), None)
+
+        with self.assertRaises(ValueError):
+            result.aggregate('x', 'avg')
+
+    def test_group_count(self):
+        db = Database(name=NAME)
+        db('CREATE TABLE test_group_count ('
+           ' x TEXT'
+           ');')
+
+        for x in ('a', 'b', 'a', 'c', 'a'):
+            db('INSERT INTO test_group_count VALUES ($1)', x)
+
+        result = db('SELECT * FROM test_group_count')
+
+        self.assertEqual(result.group_count(0), {'a': 3, 'b': 1, 'c': 1})
+
+    def test_index_by(self):
+        db = Database(name=NAME)
+        db('CREATE TABLE test_index_by ('
+           ' id INT4,'
+           ' name TEXT'
+           ');')
+
+        for id, name in ((1, 'one'), (2, 'two'), (2, 'deux'), (3, 'three')):
+            db('INSERT INTO test_index_by VALUES ($1,$2)', id, name)
+
+        index = db('SELECT * FROM test_index_by ORDER BY name').index_by('id')
+
+        self.assertEqual(len(index), 3)
+        self.assertEqual(index[1][1], 'one')
+        self.assertIn(3, index)
+        self.assertNotIn(4, index)
+        self.assertIs(index.get(4), None)
+        self.assertEqual([row[1] for row in index.rows(2)], ['deux', 'two'])
+
+        with self.assertRaises(KeyError):
+            index[4]
+
+        composite = db('SELECT * FROM test_index_by').index_by(('id', 'name'))
+
+        self.assertIn((2, 'deux'), composite)
+        self.assertNotIn((2, 'one'), composite)
+
+    def test_join(self):
+        db = Database(name=NAME)
+        db('CREATE TABLE test_join_left ('
+           ' id INT4,'
+           ' name TEXT'
+           ');')
+        db('CREATE TABLE test_join_right ('
+           ' ref INT8,'
+           ' value TEXT'
+           ');')
+
+        db('INSERT INTO test_join_left VALUES ($1,$2)', 1, 'one')
+        db('INSERT INTO test_join_left VALUES ($1,$2)', 2, 'two')
+        db('INSERT INTO test_join_right VALUES ($1,$2)', 2, 'b')
+        db('INSERT INTO test_join_right VALUES ($1,$2)', 3, 'c')
+
+        left  = db('SELECT * FROM test_join_left')
+        right = db('SELECT * FROM test_join_right')
+
+        # INT4 and INT8 keys compare by value
+        joined = left.join(right, 'id', 'ref')
+
+        self.assertEqual([(l[1], r[1]) for l, r in joined], [('two', 'b')])
+
+    def test_columns(self):
+        db = Database(name=NAME)
+        db('CREATE TABLE test_columns ('
+           ' x INT4,'
+           ' y TEXT,'
+           ' z BOOL'
+           ');')
+
+        db('INSERT INTO test_columns'
+           ' SELECT i, \'é\' || i, i % 2 = 0 FROM generate_series(0, 99999) AS i')
+        db('INSERT INTO test_columns VALUES (NULL, NULL, NULL)')
+
+        result = db('SELECT * FROM test_columns ORDER BY x')
+
+        columns = result.columns()
+
+        self.assertEqual(len(columns), 3)
+        self.assertEqual(columns[0][:3], [0, 1, 2])
+        self.assertEqual(columns[1][:2], ['é0', 'é1'])
+        self.assertEqual(columns[2][:2], [True, False])
+        self.assertEqual([column[-1] for column in columns], [None, None, None])
+
+        self.assertEqual(result.columns(threads=4), columns)
+        self.assertEqual(result[::2].select(['y']).columns(threads=0), [columns[1][::2]])
+
+    def test_to_records(self):
+        db = Database(name=NAME)
+        db('CREATE TABLE test_to_records ('
+           ' a INT2,'
+           ' b TEXT,'
+           ' c INT8,'
+           ' d BOOL'
+           ');')
+
+        db('INSERT INTO test_to_records VALUES ($1,$2,$3,$4)', 1, 'one', 2**40, True)
+        db('INSERT INTO test_to_records (a, b) VALUES ($1,$2)', 2, 'two')
+
+        records = db('SELECT * FROM test_to_records ORDER BY a').to_records()
+
+        self.assertEqual(len(records), 2)
+        self.assertEqual(records.names, ('a', 'c', 'd'))
+        self.assertEqual(records.format, '=hq?')
+        self.assertEqual(memoryview(records).itemsize, struct.calcsize('=hq?'))
+
+        self.assertEqual(list(struct.iter_unpack(records.format, bytes(records))),
+                         [(1, 2**40, True), (2, 0, False)])
+
+        # Row 1, fields 1 and 2
+        self.assertEqual(records.nulls, bytes([0b00110000]))
+
+        with self.assertRaises(TypeError):
+            db('SELECT * FROM test_to_records').to_records(columns=['b'])
+
+    @unittest.skipIf(pyarrow is None, 'requires pyarrow')
+    def test_arrow(self):
+        db = Database(name=NAME)
+        db('CREATE TABLE test_arrow ('
+           ' a INT4,'
+           ' b TEXT,'
+           ' c BOOL'
+           ');')
+
+        db('INSERT INTO test_arrow VALUES ($1,$2,$3)', 1, 'one', True)
+        db('INSERT INTO test_arrow (a) VALUES ($1)', 2)
+
+        result = db('SELECT * FROM test_arrow ORDER BY a')
+
+        table = pyarrow.table(result)
+
+        self.assertEqual(table.schema.names, ['a', 'b', 'c'])
+        self.assertEqual(table.column('b').type, pyarrow.string())
+        self.assertEqual(table.to_pydict(), {'a': [1, 2], 'b': ['one', None], 'c': [True, None]})
+
+        batch = pyarrow.record_batch(result[1:].select(['a']))
+
+        self.assertEqual(batch.to_pydict(), {'a': [2]})
+
+    def test_arrays(self):
+        db = Database(name=NAME)
+
+        result = db("SELECT ARRAY[1, 2, 3]::INT4[], ARRAY[[1, 2], [3, 4]]::INT8[],"
+                    " ARRAY['a', NULL, 'c']::TEXT[], ARRAY[0.5, 1.5]::FLOAT8[], '{}'::INT4[]")
+
+        row = result[0]
+        self.assertEqual(row[0], [1, 2, 3])
+        self.assertEqual(row[1], [[1, 2], [3, 4]])
+        self.assertEqual(row[2], ['a', None, 'c'])
+        self.assertEqual(row[3], [0.5, 1.5])
+        self.assertEqual(row[4], [])
+
+        row = result.decoding(arrays='buffer')[0]
+        self.assertEqual(row[1].format, 'q')
+        self.assertEqual(row[1].shape, (2, 2))
+        self.assertEqual(row[1].tolist(), [[1, 2], [3, 4]])
+        self.assertEqual(row[3].tolist(), [0.5, 1.5])
+
+        # Not numbers, so still a list
+        self.assertEqual(row[2], ['a', None, 'c'])
+
+        with self.assertRaises(ValueError):
+            result.decoding(arrays='tuple')
+
+    def test_byteas(self):
+        db = Database(name=NAME)
+
+        result = db("SELECT '\\x00ff10'::BYTEA, ''::BYTEA")
+
+        self.assertEqual(result[0][0], b'\x00\xff\x10')
+        self.assertEqual(result[0][1], b'')
+
+        view = result.decoding(byteas='view')[0][0]
+        del result
+
+        self.assertIsInstance(view, memoryview)
+        self.assertTrue(view.readonly)
+        self.assertEqual(view.tobytes(), b'\x00\xff\x10')
+
+    def test_cache(self):
+        db = Database(name=NAME)
+
+        with self.assertRaises(RuntimeError):
+            db.cached('SELECT 1')
+
+        db.cache(ttl=60.0, channel='test_cache')
+
+        a = db.cached('SELECT $1::INT4 + 1', 1, tag='numbers')
+        b = db.cached('SELECT $1::INT4 + 1', 1, tag='numbers')
+        c = db.cached('SELECT $1::INT4 + 1', 2)
+
+        self.assertIs(a, b)
+        self.assertEqual((a[0][0], c[0][0]), (2, 3))
+        self.assertEqual(db.cache_stats()['hits'], 1)
+        self.assertEqual(db.cache_stats()['misses'], 2)
+        self.assertEqual(db.cache_stats()['entries'], 2)
+
+        # Our own notification invalidates by tag
+        db("NOTIFY test_cache, 'numbers'")
+
+        self.assertIsNot(db.cached('SELECT $1::INT4 + 1', 1, tag='numbers'), a)
+        self.assertEqual(db.cache_stats()['invalidations'], 1)
+
+        self.assertEqual(db.invalidate(), 2)
+        self.assertEqual(db.cache_stats()['entries'], 0)
+
+    def test_copy_from_file(self):
+        db = Database(name=NAME)
+        db('CREATE TABLE test_copy_from_file ('
+           ' a INT4,'
+           ' b TEXT'
+           ');')
+
+        with tempfile.NamedTemporaryFile() as f:
+            f.write(b'a,b\n1,one\n2,"two, too"\n3,\n')
+            f.flush()
+
+            self.assertEqual(db.copy_from_file('test_copy_from_file', f.name, header=True), 3)
+
+        with tempfile.TemporaryFile() as f:
+            f.write(b'4\tfour\n')
+            f.seek(0)
+
+            self.assertEqual(db.copy_from_file(('public', 'test_copy_from_file'), f.fileno(), format='text'), 1)
+
+        result = db('SELECT * FROM test_copy_from_file ORDER BY a')
+        self.assertEqual([(row[0], row[1]) for row in result],
+                         [(1, 'one'), (2, 'two, too'), (3, None), (4, 'four')])
+
+        with self.assertRaises(OSError):
+            db.copy_from_file('test_copy_from_file', '/nonexistent/file.csv')
+
+        with self.assertRaises(ValueError):
+            db.copy_from_file('test_copy_from_file', '/dev/null', format='json')
+
+        # A name, not SQL
+        with self.assertRaises(db.ExecutionError):
+            db.copy_from_file('test_copy_from_file FROM STDIN; DROP TABLE test_copy_from_file; --', '/dev/null')
+
+    def test_memory_budget(self):
+        db = Database(name=NAME, memory_budget=4096)
+
+        db('CREATE TABLE test_memory_budget ('
+           ' a INT4,'
+           ' b TEXT'
+           ');')
+
+        db('INSERT INTO test_memory_budget'
+           ' SELECT i, CASE WHEN i % 10 = 0 THEN NULL ELSE repeat($1, i % 50) END'
+           ' FROM generate_series(1, 10000) AS i', 'x')
+
+        # Far past the budget, so spilled to disk
+        result = db('SELECT * FROM test_memory_budget ORDER BY a')
+
+        self.assertEqual(len(result), 10000)
+        self.assertEqual(result[0][1], 'x')
+        self.assertIs(result[9][1], None)
+        self.assertEqual(result[-1][0], 10000)
+        self.assertEqual(result.aggregate('a', 'sum'), 10000 * 10001 // 2)
+
+        self.assertIs(db('UPDATE test_memory_budget SET a = a'), None)
+
+        with self.assertRaises(ValueError):
+            Database(name=NAME, memory_budget=0)
+
+    def test_datetimes(self):
+        db = Database(name=NAME)
+
+        result = db("SELECT '2024-02-29'::DATE, '1969-12-31 23:59:59.5'::TIMESTAMP,"
+                    " '2024-05-06 07:08:09+02'::TIMESTAMPTZ, '13:00:05'::TIME,"
+                    " '1 month 2 days 00:00:01'::INTERVAL, 'infinity'::DATE")
+
+        row = result[0]
+        self.assertEqual(row[0], datetime.date(2024, 2, 29))
+        self.assertEqual(row[1], datetime.datetime(1969, 12, 31, 23, 59, 59, 500000))
+        self.assertEqual(row[2], datetime.datetime(2024, 5, 6, 5, 8, 9, tzinfo=datetime.timezone.utc))
+        self.assertEqual(row[3], datetime.time(13, 0, 5))
+        self.assertEqual(row[4], datetime.timedelta(days=32, seconds=1))
+        self.assertEqual(row[5], datetime.date.max)
+        self.assertEqual(result.columns()[2], [row[2]])
+
+        row = result.decoding(datetimes='epoch')[0]
+        self.assertEqual(row[0], 19782)
+        self.assertEqual(row[1], -500000)
+        self.assertEqual(row[2], 1714972089000000)
+        self.assertEqual(row[3], 46805000000)
+
+    def test_dumps(self):
+        db = Database(name=NAME)
+        db('CREATE TABLE test_dumps ('
+           ' a INT4,'
+           ' b TEXT'
+           ');')
+
+        db('INSERT INTO test_dumps VALUES ($1,$2)', 1, 'one')
+        db('INSERT INTO test_dumps (a) VALUES ($1)', 2)
+        db('INSERT INTO test_dumps VALUES ($1,$2)', 3, 'three')
+
+        result = db('SELECT * FROM test_dumps ORDER BY a')
+
+        loaded = postgresql.loads(result.dumps())
+        self.assertEqual([(row[0], row[1]) for row in loaded], [(1, 'one'), (2, None), (3, 'three')])
+
+        # Views dump only what they select
+        loaded = postgresql.loads(bytearray(result[::2].select(['b']).dumps()))
+        self.assertEqual([row[0] for row in loaded], ['one', 'three'])
+
+        with self.assertRaises(ValueError):
+            postgresql.loads(b'not a Result')
+
+    def test_share(self):
+        db = Database(name=NAME)
+        db('CREATE TABLE test_share ('
+           ' a INT4,'
+           ' b TEXT'
+           ');')
+
+        db('INSERT INTO test_share VALUES ($1,$2)', 1, 'one')
+        db('INSERT INTO test_share (a) VALUES ($1)', 2)
+
+        result = db('SELECT * FROM test_share ORDER BY a')
+        name = result.share()
+
+        try:
+            shared = postgresql.attach(name)
+        finally:
+            postgresql.unshare(name)
+
+        self.assertEqual(len(shared), 2)
+        self.assertEqual([(row[0], row[1]) for row in shared], [(1, 'one'), (2, None)])
+        self.assertEqual(shared.aggregate('a', 'sum'), 3)
+
+        with self.assertRaises(OSError):
+            postgresql.attach(name)
+
+    def test_write_csv(self):
+        db = Database(name=NAME)
+        db('CREATE TABLE test_write_csv ('
+           ' a INT4,'
+           ' b TEXT'
+           ');')
+
+        db('INSERT INTO test_write_csv VALUES ($1,$2)', 1, 'plain')
+        db('INSERT INTO test_write_csv VALUES ($1,$2)', 2, 'say "hi", twice')
+        db('INSERT INTO test_write_csv (a) VALUES ($1)', 3)
+
+        result = db('SELECT * FROM test_write_csv ORDER BY a')
+
+        out = io.BytesIO()
+        self.assertEqual(result.write_csv(out, header=True), 3)
+        self.assertEqual(out.getvalue(), b'a,b\n1,plain\n2,"say ""hi"", twice"\n3,\n')
+
+        out = io.StringIO()
+        result.write_csv(out, delimiter='\t', null='\\N')
+        self.assertEqual(out.getvalue(), '1\tplain\n2\t"say ""hi"", twice"\n3\t\\N\n')
+
+        with tempfile.NamedTemporaryFile() as f:
+            self.assertEqual(db.export_csv('SELECT * FROM test_write_csv ORDER BY a', f.name), 3)
+            self.assertEqual(list(csv.reader(open(f.name, newline=''))),
+                             [['1', 'plain'], ['2', 'say "hi", twice'], ['3', '']])
+
+        with self.assertRaises(ValueError):
+            result.write_csv(io.BytesIO(), delimiter='ab')
+
+        for delimiter in ('"', '\r', '\n'):
+            with self.assertRaises(ValueError):
+                result.write_csv(io.BytesIO(), delimiter=delimiter)
+
+    def test_numerics(self):
+        db = Database(name=NAME)
+
+        result = db("SELECT 12345678901234567890.0100::NUMERIC, -0.0005::NUMERIC,"
+                    " 42::NUMERIC, 'NaN'::NUMERIC")
+
+        row = result[0]
+        self.assertEqual(str(row[0]), '12345678901234567890.0100')
+        self.assertEqual(row[1], decimal.Decimal('-0.0005'))
+        self.assertEqual(row[2], decimal.Decimal(42))
+        self.assertTrue(row[3].is_nan())
+
+        row = result.decoding(numerics='int')[0]
+        self.assertIsInstance(row[0], decimal.Decimal)
+        self.assertEqual(row[2], 42)
+        self.assertIsInstance(row[2], int)
+
+        row = result.decoding(numerics='float')[0]
+        self.assertEqual(row[1], -0.0005)
+        self.assertEqual(row[2], 42.0)
+
+    def test_uuids_and_networks(self):
+        db = Database(name=NAME)
+
+        key = uuid.UUID('a0eebc99-9c0b-4ef8-bb6d-6bb9bd380a11')
+
+        result = db("SELECT $1::UUID, '192.168.0.1'::INET, '10.1.2.3/8'::INET,"
+                    " '2001:db8::/32'::CIDR, '08:00:2b:01:02:03'::MACADDR", str(key))
+
+        row = result[0]
+        self.assertEqual(row[0], key)
+        self.assertIsInstance(row[0], uuid.UUID)
+        self.assertEqual(row[1], ipaddress.ip_address('192.168.0.1'))
+        self.assertEqual(row[2], ipaddress.ip_interface('10.1.2.3/8'))
+        self.assertEqual(row[3], ipaddress.ip_network('2001:db8::/32'))
+        self.assertEqual(row[4], '08:00:2b:01:02:03')
+
+        self.assertEqual(result.decoding(uuids='bytes')[0][0], key.bytes)
+
+    def test_json(self):
+        db = Database(name=NAME)
+
+        text = '{"a": [1, 2.5, "\\u00e9\\ud83d\\ude00", null, true], "b": {"c": 123456789012345678901234567890}}'
+
+        result = db('SELECT $1::JSON, $1::JSONB', text)
+
+        row = result[0]
+        self.assertEqual(row[0], json.loads(text))
+        self.assertEqual(row[1], json.loads(text))
+
+        lazy = result.decoding(jsons='lazy')[0][0]
+        self.assertEqual(bytes(lazy), text.encode())
+        self.assertEqual(lazy.value, json.loads(text))
+
+    def test_records_and_ranges(self):
+        db = Database(name=NAME)
+
+        row = db("SELECT ROW(1, 'a', NULL, ROW(2.5::FLOAT8)),"
+                 " '[1,5)'::INT4RANGE, 'empty'::INT4RANGE, '[2024-01-01,)'::DATERANGE")[0]
+
+        self.assertEqual(row[0], (1, 'a', None, (2.5,)))
+        self.assertEqual(row[1], postgresql.Range((1, 5, '[)')))
+        self.assertEqual(row[2].bounds, 'empty')
+        self.assertEqual(row[3], (datetime.date(2024, 1, 1), None, '[)'))
+        self.assertEqual(row[3].lower, datetime.date(2024, 1, 1))
+
+    def test_registry(self):
+        db = Database(name=NAME)
+        db("CREATE TYPE mood AS ENUM ('sad', 'happy')")
+
+        oid = db.register_decoder('mood', 'text')
+        self.assertEqual(oid, db('SELECT oid::INT8 FROM pg_type WHERE typname = $1', 'mood')[0][0])
+
+        row = db("SELECT 'happy'::mood, ARRAY['sad', NULL]::mood[]")[0]
+        self.assertEqual(row[0], 'happy')
+        self.assertEqual(row[1], ['sad', None])
+
+        before = db("SELECT 'sad'::mood")
+        db.register_decoder('mood', lambda view: bytes(view).upper())
+        self.assertEqual(db("SELECT 'sad'::mood")[0][0], b'SAD')
+        self.assertEqual(before[0][0], 'sad')
+
+        class Mood(object):
+            def __init__(self, name):
+                self.name = name
+
+        db.register_encoder(Mood, 'mood', lambda mood: mood.name)
+        self.assertEqual(db('SELECT $1::TEXT', Mood('happy'))[0][0], 'happy')
+
+    def test_schema(self):
+        db = Database(name=NAME)
+        db("CREATE TYPE test_schema_mood AS ENUM ('sad', 'happy')")
+        db('CREATE TABLE people (id INTEGER NOT NULL, feeling test_schema_mood)')
+
+        schema = db.schema('public')
+        self.assertEqual(schema.name, 'public')
+        self.assertIn('people', schema.tables())
+        self.assertEqual(schema.columns('people'), [('id', 23, True), ('feeling', schema.types()['test_schema_mood'], False)])
+
+        # Registered for decoding as it was loaded
+        db("INSERT INTO people VALUES (1, 'happy')")
+        self.assertEqual(db('SELECT feeling, p FROM people p')[0][0], 'happy')
+        self.assertEqual(db('SELECT feeling, p FROM people p')[0][1], (1, 'happy'))
+
+        db('CREATE TABLE pets (name TEXT)')
+        self.assertNotIn('pets', schema.tables())
+        schema.invalidate()
+        self.assertIn('pets', schema.tables())
+
+        self.assertRaises(ValueError, db.schema, 'no_such_schema')
+
+    def test_parameters_binary(self):
+        db = Database(name=NAME)
+        utc = datetime.timezone.utc
+        values = (
+            1.5, b'\x00\xff', True, False, None,
+            datetime.datetime(2024, 2, 29, 13, 14, 15, 123456),
+            datetime.datetime(2024, 2, 29, 13, 14, 15, tzinfo=utc),
+            datetime.date(1969, 7, 20), datetime.time(23, 59, 59, 999999),
+            datetime.timedelta(days=-3, seconds=5),
+            decimal.Decimal('-123456789.000123450'), uuid.UUID(int=1 << 100),
+        )
+        row = db('SELECT ' + ', '.join('$%d' % (i + 1) for i in range(len(values))), *values)[0]
+        self.assertEqual(tuple(row[i] for i in range(len(values))), values)
+        self.assertEqual(str(row[10]), '-123456789.000123450')
+
+        aware = datetime.datetime(2024, 1, 1, 12, tzinfo=datetime.timezone(datetime.timedelta(hours=-5)))
+        self.assertEqual(db('SELECT $1', aware)[0][0], datetime.datetime(2024, 1, 1, 17, tzinfo=utc))
+
+        class Floating(datetime.tzinfo):
+            def utcoffset(self, dt):
+                return None
+
+        class Stamp(datetime.datetime):
+            pass
+
+        self.assertEqual(db('SELECT $1', datetime.datetime(2024, 1, 1, tzinfo=Floating()))[0][0], datetime.datetime(2024, 1, 1))
+        self.assertEqual(db('SELECT $1', Stamp(2024, 1, 1, 12))[0][0], datetime.datetime(2024, 1, 1, 12))
+
+    def test_parameters_array(self):
+        db = Database(name=NAME)
+        db('CREATE TABLE test_any (id INT8)')
+        db('INSERT INTO test_any SELECT generate_series(1, 10)')
+
+        ids = db('SELECT id FROM test_any WHERE id = ANY($1) ORDER BY id', [2, 3, 2 ** 40])
+        self.assertEqual([row[0] for row in ids], [2, 3])
+
+        row = db('SELECT $1, $2, $3', [1.5, None], ['a', 'é'], [True])[0]
+        self.assertEqual((row[0], row[1], row[2]), ([1.5, None], ['a', 'é'], [True]))
+        self.assertEqual(db('SELECT $1::INT8[]', [])[0][0], [])
+        self.assertRaises(TypeError, db, 'SELECT $1', [1, 'a'])
+
+        ids = array.array('q', [4, 5, 11])
+        self.assertEqual(len(db('SELECT id FROM test_any WHERE id = ANY($1)', ids)), 2)
+        self.assertEqual(db('SELECT $1', memoryview(array.array('i', range(6))).cast('B').cast('i', [2, 3]))[0][0], [[0, 1, 2], [3, 4, 5]])
+
+        self.assertEqual(db('SELECT $1', bytearray(b'\x00\xff'))[0][0], b'\x00\xff')
+        self.assertEqual(db('SELECT $1', memoryview(b'abc')[1:])[0][0], b'bc')